@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <KZip>
+#include <QtTest/QtTest>
+
+#include "archiveextractor.h"
+#include "testutility.h"
+
+class ArchiveExtractorTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+
+        KZip zip(archivePath());
+        QVERIFY(zip.open(QIODevice::WriteOnly));
+        zip.setCompression(KZip::DeflateCompression);
+
+        // Enough entries for every thread to get some work
+        for (int i = 0; i < 64; i++) {
+            QVERIFY(zip.writeFile(QStringLiteral("game/sqpack/ffxiv/%1.dat").arg(i), fileContents(i)));
+        }
+
+        QVERIFY(zip.writeFile(QStringLiteral("game/empty.txt"), QByteArray()));
+
+        zip.setCompression(KZip::NoCompression);
+        QVERIFY(zip.writeFile(QStringLiteral("boot/stored.txt"), QByteArrayLiteral("not compressed")));
+
+        QVERIFY(zip.close());
+    }
+
+    void testExtract()
+    {
+        const QString outputPath = m_dir.filePath(QStringLiteral("all"));
+
+        ArchiveExtractor extractor(archivePath(), outputPath);
+        QVERIFY2(extractor.extract(), qPrintable(extractor.errorString()));
+
+        const QDir output(outputPath);
+        for (int i = 0; i < 64; i++) {
+            QCOMPARE(readFile(output.filePath(QStringLiteral("game/sqpack/ffxiv/%1.dat").arg(i))), fileContents(i));
+        }
+
+        QVERIFY(QFileInfo::exists(output.filePath(QStringLiteral("game/empty.txt"))));
+        QCOMPARE(readFile(output.filePath(QStringLiteral("boot/stored.txt"))), QByteArrayLiteral("not compressed"));
+    }
+
+    void testSelectedEntries()
+    {
+        const QString outputPath = m_dir.filePath(QStringLiteral("selected"));
+
+        ArchiveExtractor extractor(archivePath(), outputPath);
+        extractor.setEntries({QStringLiteral("boot/stored.txt")});
+        QVERIFY2(extractor.extract(), qPrintable(extractor.errorString()));
+
+        const QDir output(outputPath);
+        QVERIFY(QFileInfo::exists(output.filePath(QStringLiteral("boot/stored.txt"))));
+        QVERIFY(!QFileInfo::exists(output.filePath(QStringLiteral("game"))));
+    }
+
+    void testMissingEntry()
+    {
+        ArchiveExtractor extractor(archivePath(), m_dir.filePath(QStringLiteral("missing")));
+        extractor.setEntries({QStringLiteral("GEARSET.DAT")});
+        QVERIFY(!extractor.extract());
+        QVERIFY(!extractor.errorString().isEmpty());
+    }
+
+private:
+    QString archivePath() const
+    {
+        return m_dir.filePath(QStringLiteral("test.zip"));
+    }
+
+    static QByteArray fileContents(const int index)
+    {
+        QByteArray data;
+        for (int i = 0; i < 1000 * (index + 1); i++) {
+            data.append(QByteArray::number(i * index));
+        }
+        return data;
+    }
+
+    QTemporaryDir m_dir;
+};
+
+QTEST_MAIN(ArchiveExtractorTest)
+#include "archiveextractortest.moc"
@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QRandomGenerator>
+#include <QtTest/QtTest>
+
+#include "contentchunker.h"
+
+class ContentChunkerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testEmpty()
+    {
+        QVERIFY(ContentChunker::split({}).isEmpty());
+    }
+
+    void testSmall()
+    {
+        const QByteArray data = QByteArrayLiteral("macro");
+        const auto chunks = ContentChunker::split(data);
+        QCOMPARE(chunks.size(), 1);
+        QCOMPARE(chunks[0].size, data.size());
+        QCOMPARE(chunks[0].hash, ContentChunker::hash(data));
+    }
+
+    void testChunksCoverData()
+    {
+        const QByteArray data = randomData(1024 * 1024);
+        const auto chunks = ContentChunker::split(data);
+        QVERIFY(chunks.size() > 1);
+
+        qsizetype offset = 0;
+        for (qsizetype i = 0; i < chunks.size(); i++) {
+            const auto &chunk = chunks[i];
+            QCOMPARE(chunk.offset, offset);
+            QVERIFY(chunk.size <= ContentChunker::maximumChunkSize);
+            // Only the last chunk can be cut short
+            if (i != chunks.size() - 1) {
+                QVERIFY(chunk.size >= ContentChunker::minimumChunkSize);
+            }
+            QCOMPARE(chunk.hash, ContentChunker::hash(QByteArrayView(data).sliced(chunk.offset, chunk.size)));
+            offset += chunk.size;
+        }
+        QCOMPARE(offset, data.size());
+    }
+
+    void testEditOnlyChangesNearbyChunks()
+    {
+        const QByteArray data = randomData(1024 * 1024);
+
+        QByteArray edited = data;
+        edited.insert(data.size() / 2, QByteArrayLiteral("hotbar"));
+
+        QSet<QString> originalHashes;
+        for (const auto &chunk : ContentChunker::split(data)) {
+            originalHashes.insert(chunk.hash);
+        }
+
+        qsizetype changedBytes = 0;
+        for (const auto &chunk : ContentChunker::split(edited)) {
+            if (!originalHashes.contains(chunk.hash)) {
+                changedBytes += chunk.size;
+            }
+        }
+
+        QVERIFY(changedBytes > 0);
+        QVERIFY(changedBytes <= 2 * ContentChunker::maximumChunkSize);
+    }
+
+private:
+    static QByteArray randomData(const qsizetype size)
+    {
+        // Seeded, so the test does the same thing every time
+        QRandomGenerator generator(1234);
+
+        QByteArray data(size, Qt::Uninitialized);
+        generator.fillRange(reinterpret_cast<quint32 *>(data.data()), size / sizeof(quint32));
+        return data;
+    }
+};
+
+QTEST_MAIN(ContentChunkerTest)
+#include "contentchunkertest.moc"
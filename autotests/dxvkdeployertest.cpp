@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QtTest/QtTest>
+
+#include "dxvkdeployer.h"
+#include "testutility.h"
+#include "utility.h"
+
+class DxvkDeployerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init()
+    {
+        m_dir.emplace();
+        QVERIFY(m_dir->isValid());
+
+        QVERIFY(QDir().mkpath(dxvkPath() + QStringLiteral("/x64")));
+        QVERIFY(QDir().mkpath(system32Path()));
+
+        Utility::writeVersion(dxvkPath() + QStringLiteral("/dxvk.ver"), QStringLiteral("dxvk-2.3"));
+        QVERIFY(writeFile(dxvkPath() + QStringLiteral("/x64/d3d11.dll"), QByteArrayLiteral("dxvk d3d11")));
+        QVERIFY(writeFile(dxvkPath() + QStringLiteral("/x64/dxgi.dll"), QByteArrayLiteral("dxvk dxgi")));
+    }
+
+    void testDeploy()
+    {
+        DxvkDeployer deployer(dxvkPath(), prefixPath());
+        QVERIFY2(deployer.deploy(), qPrintable(deployer.errorString()));
+        QCOMPARE(deployer.copiedCount(), 2);
+
+        QCOMPARE(readFile(system32Path() + QStringLiteral("/d3d11.dll")), QByteArrayLiteral("dxvk d3d11"));
+        QCOMPARE(readFile(system32Path() + QStringLiteral("/dxgi.dll")), QByteArrayLiteral("dxvk dxgi"));
+        QVERIFY(QFile::exists(DxvkDeployer::manifestPath(prefixPath())));
+
+        // Nothing changed, so nothing should be copied again
+        QVERIFY(deployer.deploy());
+        QCOMPARE(deployer.copiedCount(), 0);
+    }
+
+    void testReplacedByWine()
+    {
+        DxvkDeployer deployer(dxvkPath(), prefixPath());
+        QVERIFY(deployer.deploy());
+
+        // Like when Wine updates the prefix, and puts its own DLLs back
+        QVERIFY(writeFile(system32Path() + QStringLiteral("/d3d11.dll"), QByteArrayLiteral("wine builtin d3d11")));
+
+        QVERIFY(deployer.deploy());
+        QCOMPARE(deployer.copiedCount(), 1);
+        QCOMPARE(readFile(system32Path() + QStringLiteral("/d3d11.dll")), QByteArrayLiteral("dxvk d3d11"));
+    }
+
+    void testNewVersion()
+    {
+        DxvkDeployer deployer(dxvkPath(), prefixPath());
+        QVERIFY(deployer.deploy());
+
+        Utility::writeVersion(dxvkPath() + QStringLiteral("/dxvk.ver"), QStringLiteral("dxvk-2.4"));
+        QVERIFY(writeFile(dxvkPath() + QStringLiteral("/x64/dxgi.dll"), QByteArrayLiteral("dxvk dxgi 2.4")));
+
+        QVERIFY(deployer.deploy());
+        QCOMPARE(deployer.copiedCount(), 1);
+        QCOMPARE(readFile(system32Path() + QStringLiteral("/dxgi.dll")), QByteArrayLiteral("dxvk dxgi 2.4"));
+    }
+
+    void testWithoutManifest()
+    {
+        // Prefixes that already had DXVK copied into them before there was a manifest
+        QVERIFY(writeFile(system32Path() + QStringLiteral("/d3d11.dll"), QByteArrayLiteral("dxvk d3d11")));
+        QVERIFY(writeFile(system32Path() + QStringLiteral("/dxgi.dll"), QByteArrayLiteral("wine dxgi")));
+
+        DxvkDeployer deployer(dxvkPath(), prefixPath());
+        QVERIFY(deployer.deploy());
+        QCOMPARE(deployer.copiedCount(), 1);
+        QCOMPARE(readFile(system32Path() + QStringLiteral("/dxgi.dll")), QByteArrayLiteral("dxvk dxgi"));
+    }
+
+private:
+    QString dxvkPath() const
+    {
+        return m_dir->filePath(QStringLiteral("dxvk"));
+    }
+
+    QString prefixPath() const
+    {
+        return m_dir->filePath(QStringLiteral("prefix"));
+    }
+
+    QString system32Path() const
+    {
+        return prefixPath() + QStringLiteral("/drive_c/windows/system32");
+    }
+
+    std::optional<QTemporaryDir> m_dir;
+};
+
+QTEST_MAIN(DxvkDeployerTest)
+#include "dxvkdeployertest.moc"
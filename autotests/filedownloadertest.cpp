@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QNetworkAccessManager>
+#include <QtTest/QtTest>
+
+#include "bandwidthlimiter.h"
+#include "filedownloader.h"
+
+class FileDownloaderTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+
+        QFile source(m_dir.filePath(QStringLiteral("source.bin")));
+        QVERIFY(source.open(QIODevice::WriteOnly));
+
+        // Big enough to arrive in more than one chunk
+        m_data = QByteArray(4 * 1024 * 1024, 'a');
+        source.write(m_data);
+    }
+
+    void testDownload()
+    {
+        const QString destination = m_dir.filePath(QStringLiteral("download.bin"));
+
+        FileDownloader downloader(&m_mgr, sourceUrl(), destination);
+        downloader.setExpectedHash(QCryptographicHash::Sha256, QCryptographicHash::hash(m_data, QCryptographicHash::Sha256));
+
+        QVERIFY(QCoro::waitFor(downloader.download()));
+        QVERIFY(downloader.errorString().isEmpty());
+
+        QFile file(destination);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), m_data);
+    }
+
+    void testHashMismatch()
+    {
+        const QString destination = m_dir.filePath(QStringLiteral("mismatch.bin"));
+
+        FileDownloader downloader(&m_mgr, sourceUrl(), destination);
+        downloader.setExpectedHash(QCryptographicHash::Sha256, QByteArrayLiteral("not the right hash"));
+
+        QVERIFY(!QCoro::waitFor(downloader.download()));
+        QVERIFY(!downloader.errorString().isEmpty());
+
+        // Files that fail the integrity check should never end up on disk
+        QVERIFY(!QFile::exists(destination));
+    }
+
+    void testMissingFile()
+    {
+        const QString destination = m_dir.filePath(QStringLiteral("missing.bin"));
+
+        FileDownloader downloader(&m_mgr, QUrl::fromLocalFile(m_dir.filePath(QStringLiteral("doesnotexist.bin"))), destination);
+
+        QVERIFY(!QCoro::waitFor(downloader.download()));
+        QVERIFY(!QFile::exists(destination));
+    }
+
+    void testBandwidthLimit()
+    {
+        const QString destination = m_dir.filePath(QStringLiteral("throttled.bin"));
+
+        BandwidthLimiter limiter;
+        limiter.setLimit(8 * 1024 * 1024);
+
+        FileDownloader downloader(&m_mgr, sourceUrl(), destination);
+        downloader.setBandwidthLimiter(&limiter);
+
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(QCoro::waitFor(downloader.download()));
+
+        // 4 MiB at 8 MiB/s should take about half a second, instead of being instant
+        QCOMPARE_GE(timer.elapsed(), 400);
+
+        QFile file(destination);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), m_data);
+    }
+
+private:
+    QUrl sourceUrl() const
+    {
+        return QUrl::fromLocalFile(m_dir.filePath(QStringLiteral("source.bin")));
+    }
+
+    QTemporaryDir m_dir;
+    QNetworkAccessManager m_mgr;
+    QByteArray m_data;
+};
+
+QTEST_MAIN(FileDownloaderTest)
+#include "filedownloadertest.moc"
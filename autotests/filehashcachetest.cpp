@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QtTest/QtTest>
+
+#include "filehashcache.h"
+
+class FileHashCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init()
+    {
+        QVERIFY(m_dir.isValid());
+        writeFile(QByteArrayLiteral("gearset"));
+        QFile::remove(cachePath());
+    }
+
+    void testHash()
+    {
+        FileHashCache cache(cachePath());
+        QCOMPARE(cache.hash(filePath()), expectedHash(QByteArrayLiteral("gearset")));
+        QCOMPARE(cache.hashedCount(), 1);
+
+        QVERIFY(cache.hash(m_dir.filePath(QStringLiteral("missing"))).isEmpty());
+    }
+
+    void testUnchangedFilesAreNotRead()
+    {
+        {
+            FileHashCache cache(cachePath());
+            QVERIFY(!cache.hash(filePath()).isEmpty());
+            QVERIFY(cache.save());
+        }
+
+        FileHashCache cache(cachePath());
+        QCOMPARE(cache.hash(filePath()), expectedHash(QByteArrayLiteral("gearset")));
+        QCOMPARE(cache.hashedCount(), 0);
+    }
+
+    void testChangedFilesAreRead()
+    {
+        {
+            FileHashCache cache(cachePath());
+            QVERIFY(!cache.hash(filePath()).isEmpty());
+            QVERIFY(cache.save());
+        }
+
+        // Same size, so only the modification time gives it away
+        writeFile(QByteArrayLiteral("GEARSET"), QDateTime::currentDateTime().addSecs(-30));
+
+        FileHashCache cache(cachePath());
+        QCOMPARE(cache.hash(filePath()), expectedHash(QByteArrayLiteral("GEARSET")));
+        QCOMPARE(cache.hashedCount(), 1);
+    }
+
+    void testRecentlyModifiedFilesAreNotCached()
+    {
+        writeFile(QByteArrayLiteral("gearset"), QDateTime::currentDateTime());
+
+        FileHashCache cache(cachePath());
+        QVERIFY(!cache.hash(filePath()).isEmpty());
+        QVERIFY(!cache.hash(filePath()).isEmpty());
+        QCOMPARE(cache.hashedCount(), 2);
+    }
+
+private:
+    QString filePath() const
+    {
+        return m_dir.filePath(QStringLiteral("GEARSET.DAT"));
+    }
+
+    QString cachePath() const
+    {
+        return m_dir.filePath(QStringLiteral("cache/hashes.json"));
+    }
+
+    void writeFile(const QByteArray &contents, const QDateTime &modified = QDateTime::currentDateTime().addSecs(-60))
+    {
+        QFile file(filePath());
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(contents);
+        QVERIFY(file.flush());
+        QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    }
+
+    static QString expectedHash(const QByteArray &contents)
+    {
+        return QString::fromLatin1(QCryptographicHash::hash(contents, QCryptographicHash::Sha256).toHex());
+    }
+
+    QTemporaryDir m_dir;
+};
+
+QTEST_MAIN(FileHashCacheTest)
+#include "filehashcachetest.moc"
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QtTest/QtTest>
+
+#include "headlesslauncher.h"
+
+class HeadlessLauncherTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init()
+    {
+        QVERIFY(m_dir.isValid());
+
+        for (const auto &file : {
+                 QStringLiteral("boot/ffxivboot.ver"),
+                 QStringLiteral("boot/ffxivboot.exe"),
+                 QStringLiteral("boot/ffxivlauncher64.exe"),
+                 QStringLiteral("boot/ffxivupdater64.exe"),
+                 QStringLiteral("game/ffxivgame.ver"),
+                 QStringLiteral("game/ffxiv_dx11.exe"),
+                 QStringLiteral("game/sqpack/ffxiv/000000.win32.index"),
+                 QStringLiteral("game/sqpack/ffxiv/000000.win32.index2"),
+                 QStringLiteral("game/sqpack/ffxiv/000000.win32.dat0"),
+                 QStringLiteral("game/sqpack/ex1/ex1.ver"),
+                 QStringLiteral("game/sqpack/ex1/020000.win32.index"),
+                 QStringLiteral("game/sqpack/ex1/020000.win32.dat0"),
+             }) {
+            createFile(file);
+        }
+    }
+
+    void testComplete()
+    {
+        QCOMPARE(HeadlessLauncher::verifyInstallation(m_dir.path()), QStringList());
+    }
+
+    void testMissingFiles()
+    {
+        QVERIFY(QFile::remove(m_dir.filePath(QStringLiteral("game/sqpack/ex1/ex1.ver"))));
+        QVERIFY(QFile::remove(m_dir.filePath(QStringLiteral("game/sqpack/ffxiv/000000.win32.dat0"))));
+
+        auto missingFiles = HeadlessLauncher::verifyInstallation(m_dir.path());
+        missingFiles.sort();
+
+        QCOMPARE(missingFiles, (QStringList{QStringLiteral("game/sqpack/ex1/ex1.ver"), QStringLiteral("game/sqpack/ffxiv/000000.win32.dat0")}));
+    }
+
+    void testNotInstalled()
+    {
+        QTemporaryDir emptyDir;
+        QVERIFY(HeadlessLauncher::verifyInstallation(emptyDir.path()).contains(QStringLiteral("game/ffxiv_dx11.exe")));
+    }
+
+private:
+    void createFile(const QString &path)
+    {
+        const QString fullPath = m_dir.filePath(path);
+        QVERIFY(QDir().mkpath(QFileInfo(fullPath).absolutePath()));
+
+        QFile file(fullPath);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+    QTemporaryDir m_dir;
+};
+
+QTEST_MAIN(HeadlessLauncherTest)
+#include "headlesslaunchertest.moc"
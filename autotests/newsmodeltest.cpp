@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QtTest/QtTest>
+
+#include "newsmodel.h"
+
+class NewsModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testSetNews()
+    {
+        NewsModel model;
+        QAbstractItemModelTester modelTester(&model);
+
+        const QSignalSpy countSpy(&model, &NewsModel::countChanged);
+        QVERIFY(countSpy.isValid());
+
+        const News first{.id = QStringLiteral("1"), .title = QStringLiteral("First")};
+        const News second{.id = QStringLiteral("2"), .title = QStringLiteral("Second")};
+        const News third{.id = QStringLiteral("3"), .title = QStringLiteral("Third")};
+
+        model.setNews({first, second});
+        QCOMPARE(model.rowCount(), 2);
+        QCOMPARE(countSpy.count(), 1);
+
+        // Setting the same news again shouldn't touch anything
+        const QSignalSpy dataChangedSpy(&model, &QAbstractItemModel::dataChanged);
+        const QSignalSpy insertedSpy(&model, &QAbstractItemModel::rowsInserted);
+        const QSignalSpy removedSpy(&model, &QAbstractItemModel::rowsRemoved);
+        const QSignalSpy movedSpy(&model, &QAbstractItemModel::rowsMoved);
+        const QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+        model.setNews({first, second});
+        QCOMPARE(dataChangedSpy.count(), 0);
+        QCOMPARE(insertedSpy.count(), 0);
+        QCOMPARE(removedSpy.count(), 0);
+        QCOMPARE(countSpy.count(), 1);
+
+        // New entries are inserted, not reset
+        model.setNews({third, first, second});
+        QCOMPARE(insertedSpy.count(), 1);
+        QCOMPARE(removedSpy.count(), 0);
+        QCOMPARE(model.data(model.index(0), NewsModel::IdRole).toString(), QStringLiteral("3"));
+
+        // Changing a title only changes that row
+        News renamedFirst = first;
+        renamedFirst.title = QStringLiteral("Renamed");
+        model.setNews({third, renamedFirst, second});
+        QCOMPARE(dataChangedSpy.count(), 1);
+        QCOMPARE(model.data(model.index(1), NewsModel::TitleRole).toString(), QStringLiteral("Renamed"));
+
+        // Reordering moves rows
+        model.setNews({second, third, renamedFirst});
+        QVERIFY(movedSpy.count() > 0);
+        QCOMPARE(model.data(model.index(0), NewsModel::IdRole).toString(), QStringLiteral("2"));
+        QCOMPARE(model.data(model.index(1), NewsModel::IdRole).toString(), QStringLiteral("3"));
+        QCOMPARE(model.data(model.index(2), NewsModel::IdRole).toString(), QStringLiteral("1"));
+
+        // Removing entries
+        model.setNews({third});
+        QCOMPARE(model.rowCount(), 1);
+        QCOMPARE(removedSpy.count(), 2);
+
+        QCOMPARE(resetSpy.count(), 0);
+    }
+};
+
+QTEST_MAIN(NewsModelTest)
+#include "newsmodeltest.moc"
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QtTest/QtTest>
+
+#include "processlogger.h"
+#include "testutility.h"
+
+class ProcessLoggerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QVERIFY(ProcessLogger::logDirectory().removeRecursively() || !ProcessLogger::logDirectory().exists());
+    }
+
+    void testCapture()
+    {
+        runProcess(QStringLiteral("capture"), QStringLiteral("printf 'hello\\n'; printf 'world\\n' >&2"));
+
+        const QByteArray log = readLog(QStringLiteral("capture"));
+        QVERIFY(log.contains("hello\n"));
+        QVERIFY(log.contains("world\n"));
+    }
+
+    void testSizeLimit()
+    {
+        // More than the 32 MiB limit, with something recognizable at the start and the end
+        runProcess(QStringLiteral("verbose"), QStringLiteral("echo first; yes | head -c 41943040; echo last"));
+
+        const QByteArray log = readLog(QStringLiteral("verbose"));
+        QVERIFY(log.size() < 33 * 1024 * 1024);
+        QVERIFY(log.startsWith("first\n"));
+        QVERIFY(log.endsWith("last\n"));
+        QVERIFY(log.contains("bytes of output were dropped here"));
+    }
+
+    void testArchive()
+    {
+        runProcess(QStringLiteral("session"), QStringLiteral("echo one"));
+        runProcess(QStringLiteral("session"), QStringLiteral("echo two"));
+
+        QCOMPARE(readLog(QStringLiteral("session")), QByteArrayLiteral("two\n"));
+
+        const QStringList archives = ProcessLogger::logDirectory().entryList({QStringLiteral("session.*.log.*")}, QDir::Files);
+        QCOMPARE(archives.size(), 1);
+    }
+
+private:
+    static void runProcess(const QString &name, const QString &script)
+    {
+        QProcess process;
+        process.setProgram(QStringLiteral("sh"));
+        process.setArguments({QStringLiteral("-c"), script});
+
+        const auto logger = new ProcessLogger(name, &process);
+        QSignalSpy spy(logger, &ProcessLogger::finished);
+
+        process.start();
+        QVERIFY(process.waitForStarted());
+
+        QVERIFY(spy.wait(30000));
+    }
+
+    static QByteArray readLog(const QString &name)
+    {
+        return readFile(ProcessLogger::logDirectory().absoluteFilePath(name + QStringLiteral(".log")));
+    }
+};
+
+QTEST_MAIN(ProcessLoggerTest)
+#include "processloggertest.moc"
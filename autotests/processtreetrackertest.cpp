@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QtTest/QtTest>
+
+#include "processtreetracker.h"
+
+#if defined(Q_OS_LINUX)
+#include <csignal>
+#endif
+
+class ProcessTreeTrackerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+#if !defined(Q_OS_LINUX)
+        QSKIP("Processes can only be tracked on Linux");
+#endif
+    }
+
+    void testFindProcess()
+    {
+        ProcessTreeTracker tracker;
+
+        auto env = QProcessEnvironment::systemEnvironment();
+        tracker.addToEnvironment(env);
+
+        // The shell starts sleep as a child, but without waiting for it, so it's detached like in Wine
+        QProcess process;
+        process.setProcessEnvironment(env);
+        process.setProgram(QStringLiteral("sh"));
+        process.setArguments({QStringLiteral("-c"), QStringLiteral("sleep 30 & echo $!")});
+        process.start();
+        QVERIFY(process.waitForFinished());
+
+        const qint64 sleepPid = process.readAllStandardOutput().trimmed().toLongLong();
+        QVERIFY(sleepPid > 0);
+
+        // Something else that isn't in the session
+        QProcess unrelated;
+        unrelated.setProgram(QStringLiteral("sleep"));
+        unrelated.setArguments({QStringLiteral("30")});
+        unrelated.start();
+        QVERIFY(unrelated.waitForStarted());
+
+        QCOMPARE(tracker.findProcess(QStringLiteral("sleep")), sleepPid);
+        QVERIFY(!tracker.processes().contains(unrelated.processId()));
+
+#if defined(Q_OS_LINUX)
+        kill(static_cast<pid_t>(sleepPid), SIGKILL);
+#endif
+        unrelated.kill();
+        unrelated.waitForFinished();
+    }
+
+    void testSampling()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        ProcessTreeTracker tracker;
+
+        auto env = QProcessEnvironment::systemEnvironment();
+        tracker.addToEnvironment(env);
+
+        QProcess process;
+        process.setProcessEnvironment(env);
+        process.setProgram(QStringLiteral("sleep"));
+        process.setArguments({QStringLiteral("30")});
+        process.start();
+        QVERIFY(process.waitForStarted());
+
+        const QString path = dir.filePath(QStringLiteral("resources.csv"));
+        tracker.startSampling(path, std::chrono::milliseconds(10));
+        QTest::qWait(50);
+        tracker.stop();
+
+        process.kill();
+        process.waitForFinished();
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+
+        const QList<QByteArray> lines = file.readAll().split('\n');
+        QVERIFY(lines.first().startsWith("elapsed_ms,pid,name"));
+        QVERIFY(lines.size() > 2);
+        QVERIFY(lines[1].contains(",sleep,"));
+    }
+};
+
+QTEST_MAIN(ProcessTreeTrackerTest)
+#include "processtreetrackertest.moc"
@@ -27,6 +27,46 @@ private Q_SLOTS:
 
         QTRY_COMPARE(spy.count(), 1);
     }
+
+    void testLatency()
+    {
+#if !defined(Q_OS_LINUX)
+        QSKIP("Only Linux is notified right away, everywhere else polls");
+#endif
+        QProcess process;
+        process.setProgram(QStringLiteral("sleep"));
+        process.setArguments({QStringLiteral("60")});
+        process.start();
+        QVERIFY(process.waitForStarted());
+
+        const auto watcher = new ProcessWatcher(process.processId());
+        const QSignalSpy spy(watcher, &ProcessWatcher::finished);
+
+        QElapsedTimer timer;
+        timer.start();
+        process.kill();
+
+        // Polling would take up to 5 seconds
+        QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, 1000);
+        QVERIFY2(timer.elapsed() < 500, qPrintable(QStringLiteral("Took %1 ms").arg(timer.elapsed())));
+    }
+
+    void testAlreadyFinished()
+    {
+        QProcess process;
+        process.setProgram(QStringLiteral("true"));
+        process.start();
+        QVERIFY(process.waitForStarted());
+
+        const qint64 pid = process.processId();
+        QVERIFY(process.waitForFinished());
+
+        const auto watcher = new ProcessWatcher(pid);
+        const QSignalSpy spy(watcher, &ProcessWatcher::finished);
+
+        // Polling only checks every 5 seconds
+        QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, 10000);
+    }
 };
 
 QTEST_MAIN(ProcessWatcherTest)
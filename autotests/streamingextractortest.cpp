@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <KTar>
+#include <KZip>
+#include <QtTest/QtTest>
+
+#include "streamingextractor.h"
+#include "testutility.h"
+
+class StreamingExtractorTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+
+        // Big enough to span many chunks, but still compressible
+        for (int i = 0; i < 100000; i++) {
+            m_bigData.append(QByteArray::number(i));
+        }
+    }
+
+    void testTar_data()
+    {
+        QTest::addColumn<QString>("mimeType");
+
+        QTest::newRow("xz") << QStringLiteral("application/x-xz");
+        QTest::newRow("gzip") << QStringLiteral("application/gzip");
+    }
+
+    void testTar()
+    {
+        QFETCH(QString, mimeType);
+
+        const QString archivePath = m_dir.filePath(QStringLiteral("test-%1.tar").arg(QLatin1String(QTest::currentDataTag())));
+        {
+            KTar tar(archivePath, mimeType);
+            QVERIFY(tar.open(QIODevice::WriteOnly));
+            QVERIFY(tar.writeDir(QStringLiteral("root/bin")));
+            QVERIFY(tar.writeFile(QStringLiteral("root/bin/wine"), m_bigData, 0100755));
+            QVERIFY(tar.writeFile(QStringLiteral("root/share/empty.txt"), QByteArray()));
+            QVERIFY(tar.writeSymLink(QStringLiteral("root/bin/wine64"), QStringLiteral("wine")));
+            QVERIFY(tar.writeFile(QStringLiteral("other/ignored.txt"), QByteArrayLiteral("ignored")));
+            QVERIFY(tar.close());
+        }
+
+        const QString outputPath = m_dir.filePath(QStringLiteral("tar-%1").arg(QLatin1String(QTest::currentDataTag())));
+        StreamingExtractor extractor(outputPath, QStringLiteral("root"));
+        QVERIFY2(extractInChunks(extractor, archivePath), qPrintable(extractor.errorString()));
+
+        const QDir output(outputPath);
+        QCOMPARE(readFile(output.filePath(QStringLiteral("bin/wine"))), m_bigData);
+        QVERIFY(QFileInfo(output.filePath(QStringLiteral("bin/wine"))).isExecutable());
+        QVERIFY(QFileInfo::exists(output.filePath(QStringLiteral("share/empty.txt"))));
+        QCOMPARE(QFileInfo(output.filePath(QStringLiteral("bin/wine64"))).symLinkTarget(), output.filePath(QStringLiteral("bin/wine")));
+
+        // Anything outside of the root should be skipped
+        QVERIFY(!QFileInfo::exists(output.filePath(QStringLiteral("other/ignored.txt"))));
+        QVERIFY(!QFileInfo::exists(output.filePath(QStringLiteral("root"))));
+    }
+
+    void testZip()
+    {
+        const QString archivePath = m_dir.filePath(QStringLiteral("test.zip"));
+        {
+            KZip zip(archivePath);
+            QVERIFY(zip.open(QIODevice::WriteOnly));
+            zip.setCompression(KZip::DeflateCompression);
+            QVERIFY(zip.writeFile(QStringLiteral("Dalamud.dll"), m_bigData));
+            QVERIFY(zip.writeFile(QStringLiteral("runtimes/empty.json"), QByteArray()));
+            zip.setCompression(KZip::NoCompression);
+            QVERIFY(zip.writeFile(QStringLiteral("stored.txt"), QByteArrayLiteral("not compressed")));
+            QVERIFY(zip.close());
+        }
+
+        const QString outputPath = m_dir.filePath(QStringLiteral("zip"));
+        StreamingExtractor extractor(outputPath);
+        QVERIFY2(extractInChunks(extractor, archivePath), qPrintable(extractor.errorString()));
+
+        const QDir output(outputPath);
+        QCOMPARE(readFile(output.filePath(QStringLiteral("Dalamud.dll"))), m_bigData);
+        QCOMPARE(readFile(output.filePath(QStringLiteral("stored.txt"))), QByteArrayLiteral("not compressed"));
+        QVERIFY(QFileInfo::exists(output.filePath(QStringLiteral("runtimes/empty.json"))));
+    }
+
+    void testReextract()
+    {
+        const QString outputPath = m_dir.filePath(QStringLiteral("reextract"));
+        const QDir output(outputPath);
+
+        QVERIFY(extractZip(outputPath, m_bigData, QByteArrayLiteral("old")));
+
+        // Push the times back, so we can tell if anything was written again
+        const QDateTime past = QDateTime::currentDateTime().addDays(-1);
+        for (const auto &name : {QStringLiteral("unchanged.dll"), QStringLiteral("changed.txt")}) {
+            QFile file(output.filePath(name));
+            QVERIFY(file.open(QIODevice::ReadWrite));
+            QVERIFY(file.setFileTime(past, QFileDevice::FileModificationTime));
+        }
+
+        QVERIFY(extractZip(outputPath, m_bigData, QByteArrayLiteral("new and longer")));
+
+        QCOMPARE(readFile(output.filePath(QStringLiteral("unchanged.dll"))), m_bigData);
+        QCOMPARE(QFileInfo(output.filePath(QStringLiteral("unchanged.dll"))).lastModified().toSecsSinceEpoch(), past.toSecsSinceEpoch());
+
+        QCOMPARE(readFile(output.filePath(QStringLiteral("changed.txt"))), QByteArrayLiteral("new and longer"));
+        QVERIFY(QFileInfo(output.filePath(QStringLiteral("changed.txt"))).lastModified() > past);
+
+        // Shorter files also need to be replaced, even if they start the same
+        QVERIFY(extractZip(outputPath, m_bigData, QByteArrayLiteral("new")));
+        QCOMPARE(readFile(output.filePath(QStringLiteral("changed.txt"))), QByteArrayLiteral("new"));
+    }
+
+    void testLinkEscape()
+    {
+        const QString archivePath = m_dir.filePath(QStringLiteral("escape.tar"));
+        {
+            KTar tar(archivePath, QStringLiteral("application/x-tar"));
+            QVERIFY(tar.open(QIODevice::WriteOnly));
+            // Each of these looks fine on its own, but together y would point at the parent of the output directory
+            QVERIFY(tar.writeSymLink(QStringLiteral("x"), QStringLiteral(".")));
+            QVERIFY(tar.writeSymLink(QStringLiteral("y"), QStringLiteral("x/..")));
+            QVERIFY(tar.writeFile(QStringLiteral("y/escaped.txt"), QByteArrayLiteral("escaped")));
+            QVERIFY(tar.close());
+        }
+
+        const QString outputPath = m_dir.filePath(QStringLiteral("escape/output"));
+        StreamingExtractor extractor(outputPath);
+        QVERIFY2(extractInChunks(extractor, archivePath), qPrintable(extractor.errorString()));
+
+        QVERIFY(!QFileInfo::exists(m_dir.filePath(QStringLiteral("escape/escaped.txt"))));
+        QVERIFY(!QFileInfo(QDir(outputPath).filePath(QStringLiteral("y"))).isSymLink());
+    }
+
+    void testTruncated()
+    {
+        const QString archivePath = m_dir.filePath(QStringLiteral("truncated.tar.xz"));
+        {
+            KTar tar(archivePath, QStringLiteral("application/x-xz"));
+            QVERIFY(tar.open(QIODevice::WriteOnly));
+            QVERIFY(tar.writeFile(QStringLiteral("file"), m_bigData));
+            QVERIFY(tar.close());
+        }
+
+        QByteArray data = readFile(archivePath);
+        data.truncate(data.size() / 2);
+
+        StreamingExtractor extractor(m_dir.filePath(QStringLiteral("truncated")));
+        QVERIFY(extractor.write(data));
+        QVERIFY(!extractor.finish());
+        QVERIFY(!extractor.errorString().isEmpty());
+    }
+
+    void testUnknownFormat()
+    {
+        StreamingExtractor extractor(m_dir.filePath(QStringLiteral("unknown")));
+        QVERIFY(!extractor.write(QByteArrayLiteral("this is not an archive")));
+        QVERIFY(!extractor.finish());
+    }
+
+private:
+    bool extractZip(const QString &outputPath, const QByteArray &unchanged, const QByteArray &changed)
+    {
+        const QString archivePath = m_dir.filePath(QStringLiteral("reextract.zip"));
+        {
+            KZip zip(archivePath);
+            zip.open(QIODevice::WriteOnly);
+            zip.setCompression(KZip::DeflateCompression);
+            zip.writeFile(QStringLiteral("unchanged.dll"), unchanged);
+            zip.writeFile(QStringLiteral("changed.txt"), changed);
+            if (!zip.close()) {
+                return false;
+            }
+        }
+
+        StreamingExtractor extractor(outputPath);
+        return extractInChunks(extractor, archivePath);
+    }
+
+    /// Feeds the archive in small and uneven chunks, like it would arrive from the network
+    static bool extractInChunks(StreamingExtractor &extractor, const QString &archivePath)
+    {
+        const QByteArray data = readFile(archivePath);
+        qsizetype offset = 0;
+        qsizetype chunkSize = 1;
+        while (offset < data.size()) {
+            const qsizetype length = qMin(chunkSize, data.size() - offset);
+            if (!extractor.write(QByteArrayView(data).sliced(offset, length))) {
+                return false;
+            }
+            offset += length;
+            chunkSize = (chunkSize * 7) % 4093 + 1;
+        }
+
+        return extractor.finish();
+    }
+
+    QTemporaryDir m_dir;
+    QByteArray m_bigData;
+};
+
+QTEST_MAIN(StreamingExtractorTest)
+#include "streamingextractortest.moc"
@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QtTest/QtTest>
+#include <qcorotask.h>
+
+#include "uploadqueue.h"
+
+using namespace std::chrono_literals;
+
+class UploadQueueTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init()
+    {
+        QVERIFY(m_dir.isValid());
+        QFile::remove(queuePath());
+    }
+
+    void testUpload()
+    {
+        UploadQueue queue(queuePath());
+
+        QStringList uploaded;
+        queue.setHandler([&uploaded](const QString &id) -> QCoro::Task<bool> {
+            uploaded.push_back(id);
+            co_return true;
+        });
+
+        QSignalSpy idleSpy(&queue, &UploadQueue::idle);
+        queue.enqueue(QStringLiteral("a"));
+        QVERIFY(queue.isPending(QStringLiteral("a")));
+        QVERIFY(idleSpy.wait());
+
+        QCOMPARE(uploaded, QStringList{QStringLiteral("a")});
+        QVERIFY(queue.isEmpty());
+    }
+
+    void testSurvivesRestart()
+    {
+        {
+            // No handler, so nothing is uploaded
+            UploadQueue queue(queuePath());
+            queue.enqueue(QStringLiteral("a"));
+            queue.enqueue(QStringLiteral("b"));
+            queue.enqueue(QStringLiteral("a"));
+        }
+
+        UploadQueue queue(queuePath());
+        QVERIFY(queue.isPending(QStringLiteral("a")));
+        QVERIFY(queue.isPending(QStringLiteral("b")));
+
+        QStringList uploaded;
+        queue.setHandler([&uploaded](const QString &id) -> QCoro::Task<bool> {
+            uploaded.push_back(id);
+            co_return true;
+        });
+
+        QSignalSpy idleSpy(&queue, &UploadQueue::idle);
+        QVERIFY(idleSpy.wait());
+        QCOMPARE(uploaded, (QStringList{QStringLiteral("a"), QStringLiteral("b")}));
+
+        // Finished uploads are forgotten on disk too
+        UploadQueue reloadedQueue(queuePath());
+        QVERIFY(reloadedQueue.isEmpty());
+    }
+
+    void testRetry()
+    {
+        UploadQueue queue(queuePath());
+
+        int attempts = 0;
+        queue.setHandler([&attempts](const QString &) -> QCoro::Task<bool> {
+            attempts++;
+            co_return false;
+        });
+
+        QSignalSpy idleSpy(&queue, &UploadQueue::idle);
+        queue.enqueue(QStringLiteral("a"));
+        QVERIFY(idleSpy.wait());
+
+        // Still there, waiting to be tried again later
+        QCOMPARE(attempts, 1);
+        QVERIFY(queue.isPending(QStringLiteral("a")));
+
+        QVERIFY(!QCoro::waitFor(queue.drain(QStringLiteral("a"))));
+        QCOMPARE(attempts, 2);
+    }
+
+    void testDrain()
+    {
+        UploadQueue queue(queuePath());
+
+        bool succeed = false;
+        queue.setHandler([&succeed](const QString &) -> QCoro::Task<bool> {
+            co_return succeed;
+        });
+
+        QSignalSpy idleSpy(&queue, &UploadQueue::idle);
+        queue.enqueue(QStringLiteral("a"));
+        QVERIFY(idleSpy.wait());
+
+        succeed = true;
+        QVERIFY(QCoro::waitFor(queue.drain(QStringLiteral("a"))));
+        QVERIFY(queue.isEmpty());
+
+        // Nothing to do for something that was never queued
+        QVERIFY(QCoro::waitFor(queue.drain(QStringLiteral("b"))));
+    }
+
+    void testRetryDelay()
+    {
+        QCOMPARE(UploadQueue::retryDelay(0), 0ms);
+        QVERIFY(UploadQueue::retryDelay(2) > UploadQueue::retryDelay(1));
+        QCOMPARE(UploadQueue::retryDelay(100), UploadQueue::retryDelay(1000));
+    }
+
+private:
+    QString queuePath() const
+    {
+        return m_dir.filePath(QStringLiteral("queue.json"));
+    }
+
+    QTemporaryDir m_dir;
+};
+
+QTEST_MAIN(UploadQueueTest)
+#include "uploadqueuetest.moc"
@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QtTest/QtTest>
+
+#include "testutility.h"
+#include "wineregistry.h"
+
+// A trimmed down user.reg, as written by Wine
+static const QByteArray registryContents = QByteArrayLiteral(
+    "WINE REGISTRY Version 2\n"
+    ";; All keys relative to \\\\User\\\\S-1-5-21-0-0-0-1000\n"
+    "\n"
+    "#arch=win64\n"
+    "\n"
+    "[Control Panel\\\\Desktop] 1700000000\n"
+    "#time=1da1b2c3d4e5f60\n"
+    "\"FontSmoothingGamma\"=dword:00000000\n"
+    "\"Pattern\"=hex:00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,\\\n"
+    "  00,00,00,00,00,00,00,00,00,00\n"
+    "\n"
+    "[Software\\\\Wine] 1700000000\n"
+    "#time=1da1b2c3d4e5f60\n"
+    "\"HideWineExports\"=\"0\"\n"
+    "\"Version\"=\"win10\"\n");
+
+class WineRegistryTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init()
+    {
+        QVERIFY(m_dir.isValid());
+
+        QFile file(registryPath());
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(registryContents);
+    }
+
+    void testRead()
+    {
+        WineRegistry registry(registryPath());
+        QVERIFY(registry.load());
+
+        QCOMPARE(registry.rawValue(QStringLiteral("Software\\Wine"), QStringLiteral("HideWineExports")), QByteArrayLiteral("\"0\""));
+        // Keys and names aren't case sensitive
+        QCOMPARE(registry.rawValue(QStringLiteral("software\\wine"), QStringLiteral("version")), QByteArrayLiteral("\"win10\""));
+        QCOMPARE(registry.rawValue(QStringLiteral("Control Panel\\Desktop"), QStringLiteral("FontSmoothingGamma")), QByteArrayLiteral("dword:00000000"));
+        QVERIFY(!registry.rawValue(QStringLiteral("Software\\Wine"), QStringLiteral("Missing")));
+        QVERIFY(!registry.rawValue(QStringLiteral("Software\\Missing"), QStringLiteral("Version")));
+    }
+
+    void testUnchanged()
+    {
+        WineRegistry registry(registryPath());
+        QVERIFY(registry.load());
+
+        registry.setString(QStringLiteral("Software\\Wine"), QStringLiteral("HideWineExports"), QStringLiteral("0"));
+        registry.setDword(QStringLiteral("Control Panel\\Desktop"), QStringLiteral("FontSmoothingGamma"), 0);
+        registry.remove(QStringLiteral("Software\\Wine"), QStringLiteral("Missing"));
+        QVERIFY(!registry.isModified());
+
+        const QDateTime lastModified = QFileInfo(registryPath()).lastModified();
+        QVERIFY(registry.save());
+        QCOMPARE(QFileInfo(registryPath()).lastModified(), lastModified);
+        QCOMPARE(readFile(registryPath()), registryContents);
+    }
+
+    void testModify()
+    {
+        WineRegistry registry(registryPath());
+        QVERIFY(registry.load());
+
+        registry.setString(QStringLiteral("Software\\Wine"), QStringLiteral("HideWineExports"), QStringLiteral("1"));
+        registry.remove(QStringLiteral("Software\\Wine"), QStringLiteral("Version"));
+        registry.setString(QStringLiteral("Software\\Wine"), QStringLiteral("Path"), QStringLiteral("C:\\windows\\\"quoted\""));
+        registry.remove(QStringLiteral("Control Panel\\Desktop"), QStringLiteral("Pattern"));
+        QVERIFY(registry.isModified());
+        QVERIFY(registry.save());
+
+        QByteArray expected = registryContents;
+        expected.replace("\"HideWineExports\"=\"0\"\n\"Version\"=\"win10\"\n", "\"HideWineExports\"=\"1\"\n\"Path\"=\"C:\\\\windows\\\\\\\"quoted\\\"\"\n");
+        expected.replace(
+            "\"Pattern\"=hex:00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,\\\n  00,00,00,00,00,00,00,00,00,00\n",
+            "");
+        QCOMPARE(readFile(registryPath()), expected);
+    }
+
+    void testMultilineValue()
+    {
+        WineRegistry registry(registryPath());
+        QVERIFY(registry.load());
+
+        QCOMPARE(registry.rawValue(QStringLiteral("Control Panel\\Desktop"), QStringLiteral("Pattern")),
+                 QByteArrayLiteral("hex:00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00"));
+
+        // The continuation line shouldn't be left behind when it's replaced
+        registry.setDword(QStringLiteral("Control Panel\\Desktop"), QStringLiteral("Pattern"), 1);
+        QVERIFY(registry.save());
+        QVERIFY(!readFile(registryPath()).contains("  00,00"));
+        QVERIFY(readFile(registryPath()).contains("\"Pattern\"=dword:00000001\n\n[Software\\\\Wine]"));
+    }
+
+    void testNewKey()
+    {
+        WineRegistry registry(registryPath());
+        QVERIFY(registry.load());
+
+        registry.setString(QStringLiteral("Software\\Wine\\DllOverrides"), QStringLiteral("d3d11"), QStringLiteral("native"));
+        QVERIFY(registry.save());
+
+        const QByteArray contents = readFile(registryPath());
+        QVERIFY(contents.startsWith(registryContents + "\n[Software\\\\Wine\\\\DllOverrides] "));
+        QVERIFY(contents.endsWith("\n\"d3d11\"=\"native\"\n"));
+
+        // It should be found again after reloading
+        WineRegistry reloaded(registryPath());
+        QVERIFY(reloaded.load());
+        QCOMPARE(reloaded.rawValue(QStringLiteral("Software\\Wine\\DllOverrides"), QStringLiteral("d3d11")), QByteArrayLiteral("\"native\""));
+    }
+
+    void testInvalidFile()
+    {
+        QVERIFY(writeFile(registryPath(), QByteArrayLiteral("not a registry")));
+
+        WineRegistry registry(registryPath());
+        QVERIFY(!registry.load());
+
+        WineRegistry missing(m_dir.filePath(QStringLiteral("missing.reg")));
+        QVERIFY(!missing.load());
+    }
+
+private:
+    QString registryPath() const
+    {
+        return m_dir.filePath(QStringLiteral("user.reg"));
+    }
+
+    QTemporaryDir m_dir;
+};
+
+QTEST_MAIN(WineRegistryTest)
+#include "wineregistrytest.moc"
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QFileDevice>
+#include <QStringList>
+#include <optional>
+
+/// Extracts a zip archive that's already on disk, spreading its entries across multiple threads.
+/// For archives that are still downloading, see StreamingExtractor.
+class ArchiveExtractor
+{
+public:
+    ArchiveExtractor(const QString &filePath, const QString &directory);
+
+    /// Only extract the entries named in @p names, instead of the whole archive.
+    void setEntries(const QStringList &names);
+
+    /// Extracts the archive. This blocks until every entry is written, so it should be run on another thread.
+    /// \return False if the archive couldn't be read or a file couldn't be written, see errorString().
+    bool extract();
+
+    [[nodiscard]] QString errorString() const;
+
+private:
+    struct Entry {
+        QString path;
+        qint64 position = 0;
+        qint64 compressedSize = 0;
+        qint64 size = 0;
+        int encoding = 0;
+        QFileDevice::Permissions permissions;
+    };
+
+    /// Part of an entry that was inflated, and is waiting to be written.
+    struct Chunk {
+        const Entry *entry = nullptr;
+        QByteArray data;
+        /// Set on the last chunk of an entry, once it's known to be complete.
+        bool last = false;
+    };
+
+    class ChunkQueue;
+
+    /// Reads and inflates @p entry, handing it to @p queue piece by piece.
+    /// \return An error message if @p entry couldn't be read.
+    [[nodiscard]] std::optional<QString> inflateEntry(const Entry &entry, ChunkQueue &queue) const;
+
+    /// Writes everything coming through @p queue to disk, until it's closed.
+    /// \return An error message if a file couldn't be written.
+    [[nodiscard]] static std::optional<QString> writeChunks(ChunkQueue &queue);
+
+    QString m_filePath;
+    QString m_directory;
+    QStringList m_entries;
+    QString m_errorString;
+};
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QFile>
+#include <QSaveFile>
+#include <memory>
+
+/// Writes a file extracted from an archive, but only if it's different from the one already on disk.
+/// The incoming data is compared against the existing file as it arrives. Nothing is written unless they differ,
+/// and then the file is replaced atomically so nothing ever sees it half-written.
+class ArchiveFileWriter
+{
+public:
+    /// Starts writing to @p path. If @p expectedSize isn't known yet, it can be -1.
+    bool open(const QString &path, qint64 expectedSize);
+    bool write(QByteArrayView data);
+
+    /// Finishes the file, replacing the existing one only if it changed.
+    bool commit();
+
+    [[nodiscard]] bool isOpen() const;
+
+    /// \return True if the file had to be written, false if the existing one was identical.
+    [[nodiscard]] bool wasChanged() const;
+
+    [[nodiscard]] QString errorString() const;
+
+private:
+    /// Switches from comparing to writing, once we know the file is different.
+    bool startWriting();
+    bool fail(const QString &message);
+
+    QString m_path;
+    QFile m_existing;
+    std::unique_ptr<QSaveFile> m_output;
+    qint64 m_compared = 0;
+    bool m_open = false;
+    bool m_changed = false;
+    QString m_errorString;
+};
@@ -3,10 +3,12 @@
 
 #pragma once
 
+#include <QFuture>
 #include <qcorotask.h>
 
 #include "launchercore.h"
 
+class BandwidthLimiter;
 class LauncherCore;
 class QNetworkReply;
 
@@ -17,10 +19,17 @@ class AssetUpdater : public QObject
 public:
     explicit AssetUpdater(Profile &profile, LauncherCore &launcher, QObject *parent = nullptr);
 
+    /// Makes this a background update, which nobody is waiting on. Progress isn't shown, errors are only logged,
+    /// downloads are kept under the speed of @p limiter and disk access is given a low priority.
+    void setBackground(BandwidthLimiter *limiter);
+
     /// Checks for any asset updates. (This currently only means Dalamud.)
     /// \return False if the asset update failed, which should be considered fatal and Dalamud should not be used.
     QCoro::Task<bool> update();
 
+Q_SIGNALS:
+    void slotReleased();
+
 private:
     QCoro::Task<bool> checkRemoteCompatibilityToolVersion();
     QCoro::Task<bool> checkRemoteDxvkVersion();
@@ -28,25 +37,51 @@ private:
     QCoro::Task<bool> checkRemoteDalamudAssetVersion();
     QCoro::Task<bool> checkRemoteDalamudVersion();
 
-    QCoro::Task<bool> installCompatibilityTool() const;
-    QCoro::Task<bool> installDxvkTool() const;
+    QCoro::Task<bool> installCompatibilityTool();
+    QCoro::Task<bool> installDxvkTool();
     QCoro::Task<bool> installDalamudAssets();
     QCoro::Task<bool> installDalamud();
     QCoro::Task<bool> installRuntime();
 
+    /// Waits for all of @p tasks to finish, even if one of them fails early.
+    /// \return True if every task succeeded.
+    static QCoro::Task<bool> allSucceeded(std::vector<QCoro::Task<bool>> tasks);
+
+    /// Waits until there's room for another download to run, since they all share the same limit.
+    QCoro::Task<> acquireSlot();
+    void releaseSlot();
+
+    /// Downloads @p url into @p filePath, and reports its progress under @p task.
+    /// If @p sha1Hash is given, the file is only written if it matches.
+    /// \return An error message if the download failed.
+    QCoro::Task<std::optional<QString>> download(const QString &task, const QUrl &url, const QString &filePath, const QByteArray &sha1Hash = {});
+
+    /// Downloads the archive at @p url and extracts it into @p directory as it arrives, reporting its progress under @p task.
+    /// If @p root is given, only that top-level directory of the archive is extracted.
+    /// If @p extractAfter is given, the download is held onto until it finishes, so it isn't extracted at the same time as something else in @p directory.
+    /// \return An error message if the download or extraction failed.
+    QCoro::Task<std::optional<QString>>
+    downloadAndExtract(const QString &task, const QUrl &url, const QString &directory, const QString &root = {}, QFuture<void> extractAfter = {});
+
+    [[nodiscard]] bool isBackground() const;
+
+    /// Shows @p message to the user with @p signal, unless this is a background update.
+    void reportError(void (LauncherCore::*signal)(QString), const QString &message);
+
+    void updateProgress(const QString &task, qint64 received, qint64 total);
+    void finishProgress(const QString &task);
+    void updateStage();
+
     [[nodiscard]] QUrl dalamudVersionManifestUrl() const;
     [[nodiscard]] QUrl dalamudAssetManifestUrl() const;
     [[nodiscard]] QUrl dotnetRuntimePackageUrl(const QString &version) const;
     [[nodiscard]] QUrl dotnetDesktopPackageUrl(const QString &version) const;
 
-    static bool extractZip(const QString &filePath, const QString &directory);
-
     LauncherCore &launcher;
 
     QString m_remoteDalamudVersion;
     QString m_remoteRuntimeVersion;
 
-    QTemporaryDir m_tempDir;
     QDir m_wineDir;
     QDir m_dxvkDir;
     QDir m_dataDir;
@@ -66,5 +101,24 @@ private:
         QStringLiteral("https://github.com/goatcorp/wine-xiv-git/releases/download/8.5.r4.g4211bac7/wine-xiv-staging-fsync-git-ubuntu-8.5.r4.g4211bac7.tar.xz");
     QString m_remoteDxvkToolUrl = QStringLiteral("https://github.com/doitsujin/dxvk/releases/download/v2.3/dxvk-2.3.tar.gz");
 
+    struct DalamudAsset {
+        QUrl url;
+        QString path;
+        QByteArray hash;
+    };
+
+    /// \return True if @p asset is missing, or doesn't match the hash in the manifest.
+    static bool isAssetOutdated(const DalamudAsset &asset);
+
+    struct TaskProgress {
+        qint64 received = 0;
+        qint64 total = 0;
+    };
+
+    QMap<QString, TaskProgress> m_taskProgress;
+    int m_activeSlots = 0;
+
+    BandwidthLimiter *m_limiter = nullptr;
+
     Profile &m_profile;
 };
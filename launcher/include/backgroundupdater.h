@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <qcorotask.h>
+
+class BandwidthLimiter;
+class LauncherCore;
+class Profile;
+
+/// Periodically checks for updates while the launcher is sitting idle, so logging in has less to do.
+/// Boot patches are downloaded into the patch store, and Dalamud and the compatibility tools are updated in place.
+/// This is throttled and uses a low I/O priority, so it shouldn't be noticeable.
+class BackgroundUpdater : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BackgroundUpdater(LauncherCore &launcher, QObject *parent = nullptr);
+
+    /// Checks for updates right away, instead of waiting for the next time.
+    QCoro::Task<> update();
+
+    /// Stops any more updates from starting, and waits for the current one to finish as fast as possible.
+    /// This is used before logging in, so both aren't updating the same things at once.
+    QCoro::Task<> pause();
+
+    /// Allows updates to start again after pause().
+    void resume();
+
+    [[nodiscard]] bool isRunning() const;
+
+Q_SIGNALS:
+    void finished();
+
+private:
+    void updateSchedule();
+    void updateSpeedLimit();
+
+    /// \return False if something else is going on that shouldn't be interrupted, like the game running.
+    [[nodiscard]] bool canUpdate() const;
+
+    /// \return The profiles that are likely to be launched next.
+    [[nodiscard]] QList<Profile *> profilesToUpdate() const;
+
+    /// Downloads the boot patches @p profile needs into the patch store, without installing them.
+    QCoro::Task<> prefetchBootPatches(Profile &profile);
+
+    LauncherCore &m_launcher;
+    QTimer m_timer;
+    QTimer m_initialTimer;
+    BandwidthLimiter *m_limiter = nullptr;
+    bool m_running = false;
+    int m_pauseCount = 0;
+};
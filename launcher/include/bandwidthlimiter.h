@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <qcorotask.h>
+
+/// Keeps downloads under a certain speed, which is shared between everything using the same limiter.
+/// Downloads call acquire() for each chunk they read, and the socket is paused while they wait.
+class BandwidthLimiter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BandwidthLimiter(QObject *parent = nullptr);
+
+    /// Sets the maximum speed in bytes per second. If @p bytesPerSecond is 0, there's no limit.
+    /// Anything currently waiting is let through as soon as the new limit allows it.
+    void setLimit(qint64 bytesPerSecond);
+    [[nodiscard]] qint64 limit() const;
+
+    /// Waits until @p bytes can be read without going over the limit.
+    QCoro::Task<> acquire(qint64 bytes);
+
+private:
+    void refill();
+
+    qint64 m_limit = 0;
+    // Can go negative, which is how long everyone has to wait
+    qint64 m_available = 0;
+    QElapsedTimer m_lastRefill;
+};
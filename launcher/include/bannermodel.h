@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QtQml>
+
+#include "headline.h"
+#include "keyedlistmodel.h"
+
+/// List of banners from the headline, which is updated in-place when refreshed.
+class BannerModel : public KeyedListModel<Banner>
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("Use LauncherCore.headline")
+
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum CustomRoles {
+        LinkRole = Qt::UserRole,
+        BannerImageRole,
+    };
+
+    explicit BannerModel(QObject *parent = nullptr);
+
+    [[nodiscard]] QVariant data(const QModelIndex &index, int role) const override;
+    [[nodiscard]] QHash<int, QByteArray> roleNames() const override;
+
+    /// \return The banner at @p index, or an empty one if it's out of range.
+    Q_INVOKABLE Banner banner(int index) const;
+
+    /// Replaces the contents of this model with @p banners.
+    /// Banners don't have an id, so they are matched by their image instead.
+    void setBanners(const QList<Banner> &banners);
+
+Q_SIGNALS:
+    void countChanged();
+};
@@ -6,6 +6,7 @@
 #include <QObject>
 #include <QString>
 #include <QtQml>
+#include <qcorotask.h>
 
 class LauncherCore;
 class Profile;
@@ -25,9 +26,14 @@ public:
 Q_SIGNALS:
     void installFinished();
     void error(QString message);
+    void stageChanged(QString message, QString explanation = {});
+    void stageIndeterminate();
+    /// How much of the benchmark has been downloaded, in bytes. @p total is -1 if the server didn't say.
+    void downloadProgress(qint64 received, qint64 total);
 
 private:
-    void installGame();
+    QCoro::Task<> downloadInstaller();
+    QCoro::Task<> installGame();
 
     LauncherCore &m_launcher;
     Profile &m_profile;
@@ -6,6 +6,7 @@
 #include <qcorotask.h>
 
 #include "launchercore.h"
+#include "syncmanager.h"
 
 class LauncherCore;
 class QNetworkReply;
@@ -26,8 +27,30 @@ public:
     QCoro::Task<bool> sync(bool initialSync = true);
 
 private:
-    QCoro::Task<void> uploadCharacterData(const QDir &dir, const QString &id);
-    QCoro::Task<bool> downloadCharacterData(const QDir &dir, const QString &id, const QString &contentUri);
+    enum class Transfer { None, Upload, Download };
+
+    struct Character {
+        QString path;
+        QString id;
+        std::optional<SyncManager::PreviousCharacterData> previousData;
+        /// Hashes of the files in the character folder, plus the ones that were uploaded previously. Missing files have an empty hash.
+        QMap<QString, QString> localHashes;
+        Transfer transfer = Transfer::None;
+    };
+
+    /// Takes characters from @p characters that need a transfer, starting at @p next, until there's none left.
+    /// A few of these are run at once, sharing @p next between them.
+    /// \return False if any of the transfers failed.
+    QCoro::Task<bool> runTransfers(const QList<Character> &characters, qsizetype &next, const QMap<QString, QString> &knownChunkUris);
+
+    /// Uploads the files of @p character that changed, skipping any chunks in @p knownChunkUris or the previous upload.
+    QCoro::Task<bool> uploadCharacterData(const Character &character, const QMap<QString, QString> &knownChunkUris);
+
+    /// Replaces the files of @p character that are different from the uploaded ones, downloading only the chunks that aren't found locally.
+    QCoro::Task<bool> downloadCharacterData(const Character &character);
+
+    /// Downloads character data that was uploaded as an archive by older versions.
+    QCoro::Task<bool> downloadCharacterArchive(const Character &character);
 
     LauncherCore &launcher;
     Account &m_account;
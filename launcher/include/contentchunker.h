@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QByteArrayView>
+#include <QList>
+#include <QString>
+
+/// Splits data into chunks whose boundaries depend on the content, instead of fixed offsets (FastCDC.)
+/// An edit only changes the chunks around it, so everything else can be deduplicated against a previous version.
+/// The boundaries have to stay the same across versions, otherwise nothing uploaded earlier can be reused.
+namespace ContentChunker
+{
+constexpr qsizetype minimumChunkSize = 2 * 1024;
+constexpr qsizetype averageChunkSize = 8 * 1024;
+constexpr qsizetype maximumChunkSize = 64 * 1024;
+
+struct Chunk {
+    qsizetype offset = 0;
+    qsizetype size = 0;
+    /// The hex-encoded SHA-256 of the chunk.
+    QString hash;
+};
+
+/// \return The chunks that make up @p data, in order. Empty data has no chunks.
+QList<Chunk> split(QByteArrayView data);
+
+/// \return The hex-encoded SHA-256 of @p data, the same as used for chunks.
+QString hash(QByteArrayView data);
+}
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVariantMap>
+#include <optional>
+#include <qcorotask.h>
+
+class LauncherCore;
+class Profile;
+
+/// Lets other programs drive the running launcher over the session bus, as zone.xiv.astra at /Launcher.
+/// Every method returns right away, what happens afterwards is reported through the signals and progress().
+class DBusInterface : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "zone.xiv.astra.Launcher")
+
+public:
+    explicit DBusInterface(LauncherCore &launcher, QObject *parent = nullptr);
+
+    /// Claims the service name and exports this object on the session bus.
+    /// \return False if the session bus isn't available, or another instance already has the name.
+    bool registerOnSessionBus();
+
+    /// Hands @p arguments over to the instance that's already running, see handleArguments().
+    /// \return Whether it accepted them, or nothing if there isn't one or it couldn't be reached.
+    static std::optional<bool> forwardArguments(const QStringList &arguments);
+
+public Q_SLOTS:
+    /// \return Every profile, as their UUIDs mapped to their names.
+    Q_SCRIPTABLE QVariantMap profiles() const;
+
+    /// Starts installing any updates for @p profile, by name or UUID, without launching the game.
+    /// \return False if there's no such profile, or the launcher is already busy.
+    Q_SCRIPTABLE bool update(const QString &profile);
+
+    /// Starts logging in to @p profile, by name or UUID, and then launches the game. This only works if the password is remembered.
+    /// \return False if there's no such profile, the launcher is already busy, or it couldn't log in.
+    Q_SCRIPTABLE bool login(const QString &profile);
+
+    /// \return What the launcher is currently doing, see the implementation for the keys.
+    Q_SCRIPTABLE QVariantMap progress() const;
+
+    /// Does what a second instance was asked to do on the command line, like updating or launching a profile.
+    /// If there isn't anything to do, the window is shown instead.
+    /// \return False if it can't be done, like when the launcher is already busy or a profile doesn't exist.
+    Q_SCRIPTABLE bool handleArguments(const QStringList &arguments);
+
+Q_SIGNALS:
+    Q_SCRIPTABLE void stageChanged(const QString &stage, const QString &explanation);
+    Q_SCRIPTABLE void updateFinished(const QString &profile, bool succeeded);
+    Q_SCRIPTABLE void gameExited(const QString &profile);
+
+private:
+    enum class State {
+        Idle,
+        Updating,
+        LoggingIn,
+        Playing,
+    };
+
+    QCoro::Task<> runUpdates(QList<Profile *> profiles, Profile *launchProfile);
+    QCoro::Task<bool> runUpdate(Profile *profile);
+    bool startLogin(Profile *profile);
+
+    void setState(State state);
+    void updateTransferRate(qint64 received, qint64 total);
+
+    LauncherCore &m_launcher;
+    State m_state = State::Idle;
+    QString m_stage;
+    QString m_explanation;
+
+    qint64 m_received = 0;
+    qint64 m_total = 0;
+    double m_bytesPerSecond = 0.0;
+    QElapsedTimer m_sampleTimer;
+    qint64 m_sampleReceived = 0;
+};
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QDir>
+#include <QJsonObject>
+
+/// Installs DXVK into a Wine prefix, by copying its DLLs over the ones in system32.
+/// What was deployed is recorded in a manifest inside the prefix, so DLLs that are already up to date aren't copied again.
+class DxvkDeployer
+{
+public:
+    /// @p dxvkPath is where DXVK was extracted to, containing x64 and dxvk.ver.
+    DxvkDeployer(const QString &dxvkPath, const QString &winePrefixPath);
+
+    /// Copies any DLLs that are missing, out of date or were replaced by something else (like Wine updating the prefix).
+    /// This blocks, so it should be run on another thread.
+    /// \return False if a DLL couldn't be copied, see errorString().
+    bool deploy();
+
+    /// \return How many DLLs had to be copied during the last deploy().
+    [[nodiscard]] int copiedCount() const;
+
+    [[nodiscard]] QString errorString() const;
+
+    /// \return Where the manifest is stored in a prefix.
+    static QString manifestPath(const QString &winePrefixPath);
+
+private:
+    /// \return Whether @p target is still the same file that was deployed according to @p record.
+    static bool isDeployed(const QFileInfo &target, const QJsonObject &record, const QByteArray &hash);
+
+    QDir m_dxvkDir;
+    QString m_winePrefixPath;
+    int m_copiedCount = 0;
+    QString m_errorString;
+};
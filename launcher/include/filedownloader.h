@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QCryptographicHash>
+#include <QObject>
+#include <QUrl>
+#include <qcorotask.h>
+
+class BandwidthLimiter;
+class QNetworkAccessManager;
+class QNetworkReply;
+class QSaveFile;
+
+/// Downloads a file straight to disk as the data arrives, instead of keeping it all in memory.
+/// The file is hashed along the way, and is only put in place if the download (and hash check) succeeded.
+class FileDownloader : public QObject
+{
+    Q_OBJECT
+
+public:
+    FileDownloader(QNetworkAccessManager *mgr, const QUrl &url, const QString &filePath, QObject *parent = nullptr);
+
+    /// If set, the downloaded file has to match @p hash or it's thrown away.
+    void setExpectedHash(QCryptographicHash::Algorithm algorithm, const QByteArray &hash);
+
+    /// Keeps the download under the speed of @p limiter.
+    void setBandwidthLimiter(BandwidthLimiter *limiter);
+
+    /// Downloads the file, which can only be done once.
+    /// \return True if the file was downloaded and written to disk.
+    QCoro::Task<bool> download();
+
+    /// \return A user-readable description of why the download failed.
+    [[nodiscard]] QString errorString() const;
+
+    /// \return The hash of the downloaded file, if setExpectedHash was called.
+    [[nodiscard]] QByteArray hash() const;
+
+Q_SIGNALS:
+    void progress(qint64 received, qint64 total);
+
+private:
+    void write(QNetworkReply *reply, QSaveFile &file, const QByteArray &data);
+
+    QNetworkAccessManager *m_mgr = nullptr;
+    QUrl m_url;
+    QString m_filePath;
+    QString m_errorString;
+
+    std::optional<QCryptographicHash> m_hash;
+    QByteArray m_expectedHash;
+
+    BandwidthLimiter *m_limiter = nullptr;
+};
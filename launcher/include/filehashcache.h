@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QJsonObject>
+#include <QMutex>
+
+/// Remembers the SHA-256 of files along with their size and modification time, so files that haven't changed don't have to be read again.
+/// Hashing is safe to do from multiple threads at once.
+class FileHashCache
+{
+public:
+    /// Loads the cache stored at @p cachePath, if it exists.
+    explicit FileHashCache(const QString &cachePath);
+
+    /// \return The hex-encoded SHA-256 of the file at @p filePath, or an empty string if it couldn't be read.
+    QString hash(const QString &filePath);
+
+    /// Writes the cache back to disk, if anything changed.
+    /// \return False if it couldn't be written.
+    bool save();
+
+    /// \return How many files had to be read because they weren't cached, or changed since.
+    [[nodiscard]] int hashedCount() const;
+
+private:
+    QString m_cachePath;
+    mutable QMutex m_mutex;
+    QJsonObject m_entries;
+    int m_hashedCount = 0;
+    bool m_modified = false;
+};
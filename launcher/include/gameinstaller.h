@@ -4,6 +4,7 @@
 #pragma once
 
 #include <QtQml>
+#include <qcorotask.h>
 
 class LauncherCore;
 class Profile;
@@ -23,9 +24,14 @@ public:
 Q_SIGNALS:
     void installFinished();
     void error(QString message);
+    void stageChanged(QString message, QString explanation = {});
+    void stageIndeterminate();
+    /// How much of the installer has been downloaded, in bytes. @p total is -1 if the server didn't say.
+    void downloadProgress(qint64 received, qint64 total);
 
 private:
-    void installGame();
+    QCoro::Task<> downloadInstaller();
+    QCoro::Task<> installGame();
 
     LauncherCore &m_launcher;
     Profile &m_profile;
@@ -3,10 +3,13 @@
 
 #pragma once
 
+#include <QFuture>
 #include <QObject>
 #include <QProcess>
+#include <qcorotask.h>
 
 class LauncherCore;
+class ProcessTreeTracker;
 class Profile;
 struct LoginAuth;
 
@@ -16,29 +19,62 @@ public:
     explicit GameRunner(LauncherCore &launcher, QObject *parent = nullptr);
 
     /// Begins the game executable, but calls to Dalamud if needed.
-    void beginGameExecutable(Profile &profile, const std::optional<LoginAuth> &auth);
+    /// This finishes once the game has started, and reports its progress through LauncherCore::stageChanged.
+    QCoro::Task<> beginGameExecutable(Profile &profile, const std::optional<LoginAuth> &auth);
+
+    /// Starts a wineserver for @p profile's prefix ahead of time, so launching doesn't have to wait for one.
+    /// It exits by itself some time after nothing is using it anymore, in case stopWineServer() is never called.
+    /// Anything started in the same prefix connects to it. The registry is configured before it starts, since it can't be edited directly afterwards.
+    QCoro::Task<> startWineServer(const Profile &profile);
+
+    /// Stops the wineserver started by startWineServer(), unless the game is still running in that prefix.
+    /// If it's still starting, it's stopped once it's done.
+    void stopWineServer();
 
 private:
     /// Starts a vanilla game session with no Dalamud injection.
-    void beginVanillaGame(const QString &gameExecutablePath, Profile &profile, const std::optional<LoginAuth> &auth);
+    QCoro::Task<> beginVanillaGame(const QString &gameExecutablePath, Profile &profile, const std::optional<LoginAuth> &auth);
 
     /// Starts a game session with Dalamud injected.
-    void beginDalamudGame(const QString &gameExecutablePath, Profile &profile, const std::optional<LoginAuth> &auth);
+    QCoro::Task<> beginDalamudGame(const QString &gameExecutablePath, Profile &profile, const std::optional<LoginAuth> &auth);
+
+    /// Creates a tracker for a new game session, which also records resource usage if that's enabled.
+    ProcessTreeTracker *createSessionTracker();
 
     /// Returns the game arguments needed to properly launch the game. This encrypts it too if needed, and it's already joined!
     QString getGameArgs(const Profile &profile, const std::optional<LoginAuth> &auth) const;
 
     /// This wraps it in wine if needed.
-    void launchExecutable(const Profile &profile, QProcess *process, const QStringList &args, bool isGame, bool needsRegistrySetup);
+    void launchExecutable(const Profile &profile, QProcess *process, const QStringList &args, bool isGame);
+
+    /// Sets up the registry and copies DXVK into the Wine prefix, if there is one.
+    QCoro::Task<> prepareWinePrefix(const Profile &profile);
+
+    /// Runs a Wine program like winecfg, and waits for it to finish.
+    QCoro::Task<> runWineTool(const Profile &profile, const QStringList &args);
+
+    /// Waits for every Wine process in the prefix to exit.
+    QCoro::Task<> waitForWineServer(const Profile &profile);
 
     /// Set a Wine registry key
     /// \param settings The profile that's being launched
     /// \param key The path to the registry key, such as HKEY_CURRENT_USER\\Software\\Wine
     /// \param value The registry key name, like "HideWineExports"
     /// \param data What to set the value as, like "1" or "0"
-    void addRegistryKey(const Profile &settings, const QString &key, const QString &value, const QString &data);
+    QCoro::Task<> addRegistryKey(const Profile &settings, const QString &key, const QString &value, const QString &data);
+
+    QCoro::Task<> setWindowsVersion(const Profile &settings, const QString &version);
 
-    void setWindowsVersion(const Profile &settings, const QString &version);
+    /// \return Where wineserver is for the Wine used by @p profile.
+    static QString wineServerPath(const Profile &profile);
 
     LauncherCore &m_launcher;
+
+    /// The prefix that has a server from startWineServer(), if any.
+    QString m_wineServerPrefix;
+    QString m_wineServerPath;
+
+    /// Finishes once the server in m_wineServerPrefix has been started.
+    QFuture<void> m_wineServerStart;
+    bool m_wineServerStopRequested = false;
 };
\ No newline at end of file
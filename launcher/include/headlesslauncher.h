@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QJsonObject>
+#include <QObject>
+#include <qcorotask.h>
+
+class LauncherCore;
+class Profile;
+
+/// Updates, checks and launches profiles from the command line, without loading any of the UI.
+/// Progress is written to stdout as one JSON object per line so scripts can follow along, and the result is the exit code.
+class HeadlessLauncher : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ExitCode {
+        Success = 0,
+        /// Something went wrong along the way, the errors were reported.
+        Failed = 1,
+        /// The command line didn't make sense, like naming a profile that doesn't exist.
+        InvalidArguments = 2,
+        /// Another instance is already running, and it refused to do what was asked, like when it's busy or also running headless.
+        Refused = 3,
+    };
+
+    struct Options {
+        /// Profiles to update, by name or UUID.
+        QStringList update;
+        /// Update every profile.
+        bool all = false;
+        /// Check the installations of the profiles being updated, or every profile if none are.
+        bool verify = false;
+        /// Profile to launch after everything else, by name or UUID.
+        QString launch;
+    };
+
+    explicit HeadlessLauncher(LauncherCore &launcher, QObject *parent = nullptr);
+
+    /// Does everything asked for in @p options once the event loop starts, then exits the application with one of ExitCode.
+    void start(const Options &options);
+
+    /// \return Anything that's missing from the game installed at @p gamePath, as paths relative to it.
+    static QStringList verifyInstallation(const QString &gamePath);
+
+Q_SIGNALS:
+    void launchFinished();
+
+private:
+    QCoro::Task<> run(Options options);
+
+    QCoro::Task<int> update(const QList<Profile *> &profiles);
+    QCoro::Task<int> launch(Profile *profile);
+    int verify(const QList<Profile *> &profiles);
+
+    /// Writes a single line of progress to stdout.
+    static void report(const QString &event, QJsonObject fields = {});
+
+    LauncherCore &m_launcher;
+    std::optional<int> m_launchResult;
+};
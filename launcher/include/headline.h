@@ -6,6 +6,10 @@
 #include <QDateTime>
 #include <QObject>
 #include <QUrl>
+#include <QtQml>
+
+class BannerModel;
+class NewsModel;
 
 class News
 {
@@ -23,6 +27,8 @@ public:
     QString tag;
     QString title;
     QUrl url;
+
+    bool operator==(const News &other) const = default;
 };
 
 class Banner
@@ -35,29 +41,50 @@ class Banner
 public:
     QUrl link;
     QUrl bannerImage;
+
+    bool operator==(const Banner &other) const = default;
 };
 
+/// Holds the models for the launcher news, these are kept for the lifetime of the launcher and updated in-place.
 class Headline : public QObject
 {
     Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("Use LauncherCore.headline")
 
-    Q_PROPERTY(QList<Banner> banners MEMBER banners CONSTANT)
-    Q_PROPERTY(QList<News> news MEMBER news CONSTANT)
-    Q_PROPERTY(QList<News> pinned MEMBER pinned CONSTANT)
-    Q_PROPERTY(QList<News> topics MEMBER topics CONSTANT)
-    Q_PROPERTY(bool failedToLoad MEMBER failedToLoad CONSTANT)
+    Q_PROPERTY(BannerModel *banners READ banners CONSTANT)
+    Q_PROPERTY(NewsModel *news READ news CONSTANT)
+    Q_PROPERTY(NewsModel *pinned READ pinned CONSTANT)
+    Q_PROPERTY(NewsModel *topics READ topics CONSTANT)
+    Q_PROPERTY(bool loaded READ loaded NOTIFY loadedChanged)
+    Q_PROPERTY(bool failedToLoad READ failedToLoad NOTIFY failedToLoadChanged)
 
 public:
-    explicit Headline(QObject *parent = nullptr)
-        : QObject(parent)
-    {
-    }
-
-    QList<Banner> banners;
-    QList<News> news;
-    QList<News> pinned;
-    QList<News> topics;
-
-    // FIXME: wtf is this?
-    bool failedToLoad = false;
-};
\ No newline at end of file
+    explicit Headline(QObject *parent = nullptr);
+
+    [[nodiscard]] BannerModel *banners() const;
+    [[nodiscard]] NewsModel *news() const;
+    [[nodiscard]] NewsModel *pinned() const;
+    [[nodiscard]] NewsModel *topics() const;
+
+    /// \return True if the news has been fetched at least once, successful or not.
+    [[nodiscard]] bool loaded() const;
+    void setLoaded(bool loaded);
+
+    /// \return True if the last attempt to fetch the news failed. Any previous news is kept around in this case.
+    [[nodiscard]] bool failedToLoad() const;
+    void setFailedToLoad(bool failed);
+
+Q_SIGNALS:
+    void loadedChanged();
+    void failedToLoadChanged();
+
+private:
+    BannerModel *m_banners = nullptr;
+    NewsModel *m_news = nullptr;
+    NewsModel *m_pinned = nullptr;
+    NewsModel *m_topics = nullptr;
+
+    bool m_loaded = false;
+    bool m_failedToLoad = false;
+};
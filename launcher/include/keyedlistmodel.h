@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <algorithm>
+#include <functional>
+
+/// List model of @p T, which can be replaced in-place with replaceItems() instead of being reset.
+template<typename T>
+class KeyedListModel : public QAbstractListModel
+{
+public:
+    using QAbstractListModel::QAbstractListModel;
+
+    [[nodiscard]] int rowCount(const QModelIndex &parent = {}) const override
+    {
+        return parent.isValid() ? 0 : static_cast<int>(m_items.size());
+    }
+
+protected:
+    /// Replaces the contents of this model with @p items.
+    /// Items are matched by @p key (like a pointer to their id member), so only the rows that were added, removed, moved or modified are touched.
+    /// \return True if the number of rows changed.
+    template<typename KeyFunction>
+    bool replaceItems(const QList<T> &items, KeyFunction key)
+    {
+        const auto oldCount = m_items.size();
+
+        // First remove anything that no longer exists
+        for (qsizetype i = m_items.size() - 1; i >= 0; i--) {
+            const bool stillExists = std::ranges::any_of(items, [this, i, &key](const T &item) {
+                return std::invoke(key, item) == std::invoke(key, m_items[i]);
+            });
+            if (!stillExists) {
+                beginRemoveRows({}, static_cast<int>(i), static_cast<int>(i));
+                m_items.removeAt(i);
+                endRemoveRows();
+            }
+        }
+
+        // Then walk the new list, and move, insert or update rows so they line up
+        for (qsizetype i = 0; i < items.size(); i++) {
+            const auto &item = items[i];
+
+            if (i < m_items.size() && std::invoke(key, m_items[i]) == std::invoke(key, item)) {
+                updateItem(i, item);
+                continue;
+            }
+
+            const auto existing = std::find_if(m_items.cbegin() + i, m_items.cend(), [&item, &key](const T &other) {
+                return std::invoke(key, other) == std::invoke(key, item);
+            });
+
+            if (existing != m_items.cend()) {
+                const auto from = std::distance(m_items.cbegin(), existing);
+
+                beginMoveRows({}, static_cast<int>(from), static_cast<int>(from), {}, static_cast<int>(i));
+                m_items.move(from, i);
+                endMoveRows();
+
+                updateItem(i, item);
+            } else {
+                beginInsertRows({}, static_cast<int>(i), static_cast<int>(i));
+                m_items.insert(i, item);
+                endInsertRows();
+            }
+        }
+
+        return oldCount != m_items.size();
+    }
+
+    QList<T> m_items;
+
+private:
+    void updateItem(const qsizetype i, const T &item)
+    {
+        if (m_items[i] != item) {
+            m_items[i] = item;
+            Q_EMIT dataChanged(index(static_cast<int>(i)), index(static_cast<int>(i)));
+        }
+    }
+};
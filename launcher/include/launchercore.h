@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QNetworkAccessManager>
+#include <QTimer>
 #include <QtQml>
 #include <qcorotask.h>
 
@@ -17,11 +19,13 @@
 class SapphireLogin;
 class SquareEnixLogin;
 class AssetUpdater;
+class BackgroundUpdater;
 class GameInstaller;
 class CompatibilityToolInstaller;
 class GameRunner;
 class BenchmarkInstaller;
 class SyncManager;
+class UploadQueue;
 
 class LoginInformation : public QObject
 {
@@ -65,7 +69,7 @@ class LauncherCore : public QObject
     Q_PROPERTY(LauncherSettings *settings READ settings CONSTANT)
     Q_PROPERTY(ProfileManager *profileManager READ profileManager CONSTANT)
     Q_PROPERTY(AccountManager *accountManager READ accountManager CONSTANT)
-    Q_PROPERTY(Headline *headline READ headline NOTIFY newsChanged)
+    Q_PROPERTY(Headline *headline READ headline CONSTANT)
     Q_PROPERTY(Profile *currentProfile READ currentProfile WRITE setCurrentProfile NOTIFY currentProfileChanged)
     Q_PROPERTY(Profile *autoLoginProfile READ autoLoginProfile WRITE setAutoLoginProfile NOTIFY autoLoginProfileChanged)
     Q_PROPERTY(QString cachedLogoImage READ cachedLogoImage NOTIFY cachedLogoImageChanged)
@@ -90,6 +94,11 @@ public:
     /// check the result to see whether they need to "reset" or show a failed state or not. \note The login process is asynchronous.
     Q_INVOKABLE bool autoLogin(Profile *profile);
 
+    /// Installs any updates for @p profile without launching the game, using the stored credentials like autoLogin().
+    /// Game patches are only given out when logging in, so the account's password has to be remembered for those.
+    /// \return False if something couldn't be updated, the reason is sent through loginError() or miscError().
+    QCoro::Task<bool> updateProfile(Profile *profile);
+
     /// Launches the game without patching, or logging in.
     /// Meant to test if we can get to the title screen and is intended to fail to do anything else.
     Q_INVOKABLE void immediatelyLaunch(Profile *profile);
@@ -104,6 +113,13 @@ public:
     void fetchAvatar(Account *account);
     Q_INVOKABLE void clearAvatarCache();
 
+    /// Resolves and connects ahead of time to the servers @p profile will use when logging in.
+    /// These connections are kept warm for a limited time, so the handshakes are already done when the user logs in.
+    Q_INVOKABLE void prewarmConnections(Profile *profile);
+
+    /// Starts Wine for @p profile ahead of time if it's enabled, see GameRunner::startWineServer().
+    Q_INVOKABLE void prestartWine(Profile *profile);
+
     Q_INVOKABLE void refreshNews();
     Q_INVOKABLE void refreshLogoImage();
 
@@ -135,11 +151,14 @@ public:
 
 #ifdef BUILD_SYNC
     [[nodiscard]] SyncManager *syncManager() const;
+    [[nodiscard]] UploadQueue *uploadQueue() const;
 #endif
 
 Q_SIGNALS:
     void loadingFinished();
     void successfulLaunch();
+    /// Logging in stopped before the game could be launched. Whatever went wrong was already reported through one of the error signals.
+    void loginFailed();
     void gameClosed(Profile *profile);
     void loginError(QString message);
     void dalamudError(QString message);
@@ -147,7 +166,8 @@ Q_SIGNALS:
     void stageChanged(QString message, QString explanation = {});
     void stageIndeterminate();
     void stageDeterminate(int min, int max, int value);
-    void newsChanged();
+    /// The bytes downloaded so far for the current stage, out of @p total. Unlike stageDeterminate(), these are always in bytes.
+    void downloadProgress(qint64 received, qint64 total);
     void currentProfileChanged();
     void autoLoginProfileChanged();
     void cachedLogoImageChanged();
@@ -165,9 +185,23 @@ private:
 
     QCoro::Task<> handleGameExit(const Profile *profile);
 
+#ifdef BUILD_SYNC
+    /// Uploads the character data of the account with @p accountUuid, for the upload queue.
+    QCoro::Task<bool> uploadCharacterData(const QString &accountUuid);
+#endif
+
+    /// \return The one-time password for @p account if it uses one, an empty string if it doesn't, or nullopt if it can't be generated.
+    std::optional<QString> storedOneTimePassword(Account &account);
+
     /// Updates FFXIV.cfg with some recommended options like turning the opening cutscene movie off
     void updateConfig(const Account *account);
 
+    /// Starts a connection to @p host, if it isn't already warm.
+    void warmConnection(const QString &scheme, const QString &host, const QSslConfiguration &sslConfiguration);
+
+    /// Logs how long the pre-warmed connections took to set up, and stops keeping them warm.
+    void finishPrewarming();
+
     /// Tell the system to keep the screen on and don't go to sleep
     void inhibitSleep();
 
@@ -188,13 +222,25 @@ private:
     Headline *m_headline = nullptr;
     LauncherSettings *m_settings = nullptr;
     GameRunner *m_runner = nullptr;
+    BackgroundUpdater *m_backgroundUpdater = nullptr;
     QString m_cachedLogoImage;
 
 #ifdef BUILD_SYNC
     SyncManager *m_syncManager = nullptr;
+    UploadQueue *m_uploadQueue = nullptr;
 #endif
 
     int m_currentProfileIndex = 0;
 
+    struct WarmConnection {
+        QElapsedTimer age;
+        qint64 connectTime = -1;
+    };
+
+    QHash<QString, WarmConnection> m_warmConnections;
+    QPointer<Profile> m_prewarmProfile;
+    QTimer *m_prewarmTimer = nullptr;
+    QElapsedTimer m_prewarmStarted;
+
     unsigned int screenSaverDbusCookie = 0;
 };
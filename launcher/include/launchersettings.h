@@ -25,7 +25,12 @@ class LauncherSettings : public QObject
     Q_PROPERTY(QString screenshotDir READ screenshotDir WRITE setScreenshotDir NOTIFY screenshotDirChanged)
     Q_PROPERTY(bool argumentsEncrypted READ argumentsEncrypted WRITE setArgumentsEncrypted NOTIFY encryptedArgumentsChanged)
     Q_PROPERTY(bool enableRenderDocCapture READ enableRenderDocCapture WRITE setEnableRenderDocCapture NOTIFY enableRenderDocCaptureChanged)
+    Q_PROPERTY(int resourceSamplingInterval READ resourceSamplingInterval WRITE setResourceSamplingInterval NOTIFY resourceSamplingIntervalChanged)
     Q_PROPERTY(bool enableSync READ enableSync WRITE setEnableSync NOTIFY enableSyncChanged)
+    Q_PROPERTY(bool enableBackgroundUpdates READ enableBackgroundUpdates WRITE setEnableBackgroundUpdates NOTIFY enableBackgroundUpdatesChanged)
+    Q_PROPERTY(int backgroundUpdateInterval READ backgroundUpdateInterval WRITE setBackgroundUpdateInterval NOTIFY backgroundUpdateIntervalChanged)
+    Q_PROPERTY(int backgroundUpdateSpeedLimit READ backgroundUpdateSpeedLimit WRITE setBackgroundUpdateSpeedLimit NOTIFY backgroundUpdateSpeedLimitChanged)
+    Q_PROPERTY(bool prestartWineServer READ prestartWineServer WRITE setPrestartWineServer NOTIFY prestartWineServerChanged)
 
 public:
     explicit LauncherSettings(QObject *parent = nullptr);
@@ -68,12 +73,31 @@ public:
     [[nodiscard]] bool enableRenderDocCapture() const;
     void setEnableRenderDocCapture(bool value);
 
+    /// How often the game's resource usage is written to the log directory, in seconds. 0 means it's not recorded.
+    [[nodiscard]] int resourceSamplingInterval() const;
+    void setResourceSamplingInterval(int value);
+
     [[nodiscard]] QString currentProfile() const;
     void setCurrentProfile(const QString &value);
 
     [[nodiscard]] bool enableSync() const;
     void setEnableSync(bool enabled);
 
+    [[nodiscard]] bool enableBackgroundUpdates() const;
+    void setEnableBackgroundUpdates(bool enabled);
+
+    /// In minutes.
+    [[nodiscard]] int backgroundUpdateInterval() const;
+    void setBackgroundUpdateInterval(int value);
+
+    /// In KiB/s, or 0 if there's no limit.
+    [[nodiscard]] int backgroundUpdateSpeedLimit() const;
+    void setBackgroundUpdateSpeedLimit(int value);
+
+    /// Whether to start Wine for the selected profile ahead of time, so the game launches faster.
+    [[nodiscard]] bool prestartWineServer() const;
+    void setPrestartWineServer(bool enabled);
+
     Config *config();
 
 Q_SIGNALS:
@@ -88,7 +112,12 @@ Q_SIGNALS:
     void screenshotDirChanged();
     void encryptedArgumentsChanged();
     void enableRenderDocCaptureChanged();
+    void resourceSamplingIntervalChanged();
     void enableSyncChanged();
+    void enableBackgroundUpdatesChanged();
+    void backgroundUpdateIntervalChanged();
+    void backgroundUpdateSpeedLimitChanged();
+    void prestartWineServerChanged();
 
 private:
     Config *m_config = nullptr;
@@ -3,4 +3,7 @@
 
 #pragma once
 
-void initializeLogging();
\ No newline at end of file
+#include <cstdio>
+
+/// Starts writing log messages to the log file, and to @p console.
+void initializeLogging(FILE *console = stdout);
\ No newline at end of file
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QtQml>
+
+#include "headline.h"
+#include "keyedlistmodel.h"
+
+/// List of news entries from the headline, which is updated in-place when refreshed.
+class NewsModel : public KeyedListModel<News>
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("Use LauncherCore.headline")
+
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum CustomRoles {
+        DateRole = Qt::UserRole,
+        IdRole,
+        TagRole,
+        TitleRole,
+        UrlRole,
+    };
+
+    explicit NewsModel(QObject *parent = nullptr);
+
+    [[nodiscard]] QVariant data(const QModelIndex &index, int role) const override;
+    [[nodiscard]] QHash<int, QByteArray> roleNames() const override;
+
+    /// Replaces the contents of this model with @p news.
+    /// Entries are matched by their id, so only the rows that were added, removed, moved or modified are touched.
+    void setNews(const QList<News> &news);
+
+Q_SIGNALS:
+    void countChanged();
+};
@@ -26,6 +26,12 @@ public:
 
     QCoro::Task<bool> patch(const physis_PatchList &patchList);
 
+    /// \return The directory where patches are downloaded to, before they're installed.
+    static QDir patchesDirectory();
+
+    /// \return Where the patch at @p url is downloaded to.
+    static QString patchPath(const QString &url, const QString &version);
+
 private:
     void setupDirectories();
     [[nodiscard]] QString getBaseString() const;
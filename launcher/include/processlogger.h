@@ -3,15 +3,41 @@
 
 #pragma once
 
-#include <QFile>
+#include <QDir>
+#include <QFuture>
 #include <QObject>
 #include <QProcess>
+#include <QTimer>
 
+/// Captures the output of a process into <name>.log in the log directory.
+/// Output is buffered and written in batches on another thread. Each session has a size limit, and once it's reached the oldest
+/// output is overwritten (except for the very beginning, which usually has the most useful information).
+/// The logs from previous sessions are compressed, and only the last few are kept.
 class ProcessLogger : public QObject
 {
+    Q_OBJECT
+
 public:
     explicit ProcessLogger(const QString &baseName, QProcess *process);
 
+    /// Archives logs from previous sessions that were written by something else, like DXVK, with the same size limit and retention.
+    /// This happens on another thread, and should be done before they're written to again.
+    /// \param nameFilters Which files in the log directory to archive, like "*_d3d11.log"
+    static QFuture<void> archiveLogs(const QStringList &nameFilters);
+
+    /// \return Where logs are written to.
+    static QDir logDirectory();
+
+Q_SIGNALS:
+    /// Emitted once the process has exited, and all of its output is on disk.
+    void finished();
+
 private:
-    QFile m_file;
-};
\ No newline at end of file
+    /// Hands off everything buffered so far to be written.
+    void flush();
+
+    struct LogFile;
+    std::shared_ptr<LogFile> m_file;
+    QByteArray m_buffer;
+    QTimer m_flushTimer;
+};
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QProcessEnvironment>
+#include <QTimer>
+
+/// Keeps track of every process started for one game session, and can sample how many resources they use over time.
+/// Processes are recognized by a variable in their environment, which is inherited by everything they start, even through Wine.
+/// Following parent PIDs isn't enough because Wine detaches the processes it starts. This only works on Linux, where it can read /proc.
+class ProcessTreeTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProcessTreeTracker(QObject *parent = nullptr);
+
+    /// Marks anything started with @p environment as being part of this session.
+    void addToEnvironment(QProcessEnvironment &environment) const;
+
+    /// Starts writing a timeline of the session's resource usage to @p path, as CSV. A sample is taken every @p interval.
+    void startSampling(const QString &path, std::chrono::milliseconds interval);
+
+    /// Looks for any new processes in this session, and forgets the ones that exited.
+    void update();
+
+    /// \return The PID of the most recently started process in this session whose name contains @p name.
+    [[nodiscard]] std::optional<qint64> findProcess(const QString &name);
+
+    /// \return The PIDs of every process in the session that's still running.
+    [[nodiscard]] QList<qint64> processes() const;
+
+    /// Takes one last sample, and stops sampling.
+    void stop();
+
+private:
+    struct ProcessInfo {
+        qint64 pid = 0;
+        qint64 parentPid = 0;
+        quint64 startTime = 0;
+        QString name;
+        quint64 cpuTicks = 0;
+        qint64 residentPages = 0;
+        qint64 threads = 0;
+    };
+
+    /// \return What /proc/<pid>/stat says about @p pid, or nullopt if it's already gone.
+    static std::optional<ProcessInfo> readProcess(qint64 pid);
+
+    /// \return Whether @p pid was started with this session's environment variable.
+    [[nodiscard]] bool isInSession(qint64 pid) const;
+
+    void sample();
+
+    QString m_sessionId;
+    /// Processes in this session by PID.
+    QHash<qint64, ProcessInfo> m_processes;
+    /// Processes that were already checked and aren't in the session, by PID and start time.
+    QHash<qint64, quint64> m_ignored;
+
+    QTimer m_timer;
+    QFile m_timeline;
+    QElapsedTimer m_elapsed;
+    qint64 m_peakResidentPages = 0;
+};
@@ -5,16 +5,28 @@
 
 #include <QTimer>
 
+class QSocketNotifier;
+
 /// Listens and waits for a process to finish.
+/// On Linux this is notified as soon as the process exits, otherwise it's checked every few seconds.
 class ProcessWatcher : public QObject
 {
     Q_OBJECT
 public:
     explicit ProcessWatcher(qint64 PID, QObject *parent = nullptr);
+    ~ProcessWatcher() override;
 
 Q_SIGNALS:
     void finished();
 
 private:
+    /// Waits on a pidfd for the process, so the event loop wakes up when it exits.
+    /// \return False if pidfds aren't supported, and it has to be polled instead.
+    bool watchPidfd(qint64 PID);
+
+    void finish();
+
     QTimer *m_timer = nullptr;
-};
\ No newline at end of file
+    QSocketNotifier *m_notifier = nullptr;
+    int m_pidfd = -1;
+};
@@ -33,6 +33,9 @@ public:
     Q_INVOKABLE Profile *getProfile(int index);
     Profile *getProfileByUUID(const QString &uuid);
 
+    /// \return The profile whose UUID or name is @p nameOrUuid, or nullptr if there isn't one.
+    Profile *getProfileByNameOrUUID(const QString &nameOrUuid);
+
     int getProfileIndex(const QString &name);
     Q_INVOKABLE Profile *addProfile();
     Q_INVOKABLE void deleteProfile(Profile *profile);
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <QNetworkReply>
+#include <QPointer>
 #include <qcorotask.h>
 
 #include "launchercore.h"
@@ -20,17 +22,26 @@ public:
     /// \return Arguments used for logging into the game, if successful
     QCoro::Task<std::optional<LoginAuth>> login(LoginInformation *info);
 
+    /// \return The request for the list of boot patches @p profile needs. This doesn't need to be logged in.
+    static QNetworkRequest bootPatchListRequest(LauncherCore &launcher, const Profile &profile);
+
 private:
     /// Checks the gate status to see if the servers are closed for maintenance
-    /// \return False if the gate is closed, true if open.
-    QCoro::Task<bool> checkGateStatus() const;
+    /// \return An error message if the gate is closed, or nullopt if it's open.
+    QCoro::Task<std::optional<QString>> checkGateStatus();
 
     /// Checks the login status to see if the servers are closed for maintenance
-    /// \return False if logging in is disabled, true if open.
-    QCoro::Task<bool> checkLoginStatus() const;
+    /// \return An error message if logging in is disabled, or nullopt if it's open.
+    QCoro::Task<std::optional<QString>> checkLoginStatus();
+
+    /// Starts fetching the list of boot patches.
+    QNetworkReply *requestBootPatchList();
+
+    /// Applies the boot patches listed in @p reply. Even though we don't use these, it's checked by later login steps.
+    QCoro::Task<bool> checkBootUpdates(QNetworkReply *reply);
 
-    /// Check for updates to the boot components. Even though we don't use these, it's checked by later login steps.
-    QCoro::Task<bool> checkBootUpdates();
+    /// Keeps checking for boot updates until there are none left, starting with the patch list in @p reply.
+    QCoro::Task<bool> updateBootComponents(QNetworkReply *reply);
 
     using StoredInfo = std::pair<QString, QUrl>;
 
@@ -39,7 +50,7 @@ private:
 
     /// Logs into the server
     /// \return Returns false if the oauth call failed for some reason
-    QCoro::Task<bool> loginOAuth();
+    QCoro::Task<bool> loginOAuth(const StoredInfo &storedInfo);
 
     /// Registers a new session with the login server and patches the game if necessary
     /// \return Returns false if the session registration failed for some reason
@@ -51,12 +62,24 @@ private:
     /// Gets the SHA1 hash of a file
     static QString getFileHash(const QString &file);
 
+    /// Marks @p reply as speculative, meaning it's aborted if an earlier login stage fails.
+    void trackSpeculativeReply(QNetworkReply *reply);
+
+    /// Aborts any speculative requests that are still in flight.
+    void abortSpeculativeRequests();
+
+    /// Shows @p message as the reason logging in failed, unless another one was already shown.
+    void reportError(const QString &message);
+
     Patcher *m_patcher = nullptr;
 
     QString m_SID, m_username;
     LoginAuth m_auth;
     LoginInformation *m_info = nullptr;
     bool m_lastRunHasPatched = true;
+    bool m_gameHasPatched = false;
+    bool m_hasReportedError = false;
+    QList<QPointer<QNetworkReply>> m_speculativeReplies;
 
     LauncherCore &m_launcher;
 };
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QDir>
+#include <QSet>
+
+#include "archivefilewriter.h"
+
+/// Extracts a .tar.xz, .tar.gz or .zip archive while it's still being downloaded, so it never has to be written to disk first.
+/// Files that are identical to the ones already in the directory are left alone.
+/// The format is detected from the first few bytes of the archive.
+class StreamingExtractor
+{
+public:
+    /// Entries are extracted into @p directory. If @p root is given, only the entries inside of that top-level directory are extracted, without it in their path.
+    explicit StreamingExtractor(const QString &directory, const QString &root = {});
+    ~StreamingExtractor();
+
+    /// Extracts everything it can from the next chunk of the archive.
+    /// This can be called from any thread, but only one at a time.
+    /// \return False if the archive is invalid or a file couldn't be written, see errorString().
+    bool write(QByteArrayView data);
+
+    /// Checks that the whole archive was extracted. This must be called after the last write().
+    /// \return False if the archive was cut short.
+    bool finish();
+
+    [[nodiscard]] QString errorString() const;
+
+private:
+    enum class Format {
+        Unknown,
+        TarXz,
+        TarGz,
+        Zip,
+    };
+
+    enum class TarEntryKind {
+        File,
+        Skip,
+        LongName,
+        LongLink,
+        Pax,
+    };
+
+    enum class ZipState {
+        Header,
+        Data,
+        DataDescriptor,
+        End,
+    };
+
+    struct Decoder;
+
+    bool decompress(QByteArrayView data, bool finishing);
+
+    bool parseTar();
+    bool readTarHeader(const char *block);
+    bool finishTarEntry();
+
+    bool parseZip();
+    /// \return How many bytes were read, zero if more data is needed or -1 on error.
+    qsizetype readZipLocalHeader(const char *header, qsizetype available);
+    bool readZipData(qsizetype &offset);
+    bool writeZipData(QByteArrayView data);
+    bool finishZipEntry();
+    /// \return How many bytes were read, zero if more data is needed or -1 on error.
+    qsizetype readZipCentralDirectoryHeader(const char *header, qsizetype available);
+
+    /// \return Where the entry @p name should be extracted to, or an empty string if it should be skipped.
+    [[nodiscard]] QString outputPath(const QString &name) const;
+    /// \return Whether @p path is still inside of the directory once any links along the way are followed.
+    bool isInsideDirectory(const QString &path);
+    bool makeDirectory(const QString &path);
+    bool makeLink(const QString &path, const QString &target, bool symbolic);
+    /// Starts writing the file at @p path. If @p size isn't known up front, it can be -1.
+    bool beginFile(const QString &path, QFileDevice::Permissions permissions, qint64 size);
+    bool writeFile(QByteArrayView data);
+    bool endFile();
+
+    bool fail(const QString &message);
+
+    QDir m_directory;
+    // Where m_directory really is, once it's been created
+    QString m_canonicalDirectory;
+    QString m_root;
+    QString m_errorString;
+
+    Format m_format = Format::Unknown;
+    std::unique_ptr<Decoder> m_decoder;
+
+    // Data that's been received, but not parsed yet
+    QByteArray m_buffer;
+
+    // How much of the current entry's data is left, and the padding after it
+    qint64 m_remaining = 0;
+    qint64 m_padding = 0;
+
+    TarEntryKind m_tarEntryKind = TarEntryKind::Skip;
+    QByteArray m_tarMetadata;
+    QString m_tarLongName;
+    QString m_tarLongLink;
+    bool m_tarEnded = false;
+
+    ZipState m_zipState = ZipState::Header;
+    QString m_zipEntryName;
+    quint16 m_zipFlags = 0;
+    quint16 m_zipMethod = 0;
+    quint32 m_zipExpectedCrc = 0;
+    quint32 m_zipCrc = 0;
+    bool m_zipEntryIs64 = false;
+    QSet<QString> m_zipExtractedEntries;
+
+    // Files that are the same as what's already on disk aren't written again
+    ArchiveFileWriter m_writer;
+    QString m_filePath;
+    QFileDevice::Permissions m_filePermissions;
+    int m_changedFiles = 0;
+    int m_unchangedFiles = 0;
+};
@@ -62,9 +62,20 @@ public:
     bool isReady() const;
 
     struct PreviousCharacterData {
+        /// The archive uploaded by older versions, which is empty if the data was uploaded as chunks.
         QString mxcUri;
         QString hostname;
         QMap<QString, QString> fileHashes;
+        /// The hashes of the chunks that make up each file, in order.
+        QMap<QString, QStringList> fileChunks;
+        /// Where each chunk was uploaded to, by hash.
+        QMap<QString, QString> chunkUris;
+
+        /// \return Whether the data was uploaded as chunks, instead of an archive.
+        [[nodiscard]] bool isChunked() const
+        {
+            return mxcUri.isEmpty();
+        }
     };
 
     /**
@@ -73,13 +84,29 @@ public:
     QCoro::Task<std::optional<PreviousCharacterData>> getUploadedCharacterData(const QString &id);
 
     /**
-     * @brief Uploads character data for @p id from @p path.
-     * @return True if uploaded successfuly, false otherwise.
+     * @brief Uploads a single chunk of character data.
+     * @return The mxc URI of the chunk, or nullopt if it couldn't be uploaded.
      */
-    QCoro::Task<bool> uploadCharacterArchive(const QString &id, const QString &path, const QMap<QString, QString> &fileHashes);
+    QCoro::Task<std::optional<QString>> uploadChunk(const QByteArray &data);
+
+    /**
+     * @brief Downloads a single chunk of character data from @p mxcUri.
+     * @return The contents of the chunk, or nullopt if it couldn't be downloaded.
+     */
+    QCoro::Task<std::optional<QByteArray>> downloadChunk(const QString &mxcUri);
+
+    /**
+     * @brief Records which chunks make up the character data for @p id. The chunks have to be uploaded already.
+     * @return True if recorded successfuly, false otherwise.
+     */
+    QCoro::Task<bool> setCharacterManifest(const QString &id,
+                                           const QMap<QString, QString> &fileHashes,
+                                           const QMap<QString, QStringList> &fileChunks,
+                                           const QMap<QString, QString> &chunkUris);
 
     /**
      * @brief Downloads the character data archive from @p mxcUri and extracts it in @p destPath.
+     * Only data uploaded by older versions is stored as an archive.
      */
     QCoro::Task<bool> downloadCharacterArchive(const QString &mxcUri, const QString &destPath);
 
@@ -117,6 +144,9 @@ private:
     QString roomId() const;
     void setRoomId(const QString &roomId);
     QCoro::Task<> findRoom();
+    /// Looks up the sync room by its stored ID, without going through every room.
+    /// \return True if the room was found.
+    bool findKnownRoom();
 
     Quotient::AccountRegistry m_accountRegistry;
 
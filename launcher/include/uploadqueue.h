@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QDateTime>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <chrono>
+#include <functional>
+#include <qcorotask.h>
+
+/// Keeps track of uploads that still have to happen, and works through them in the background.
+/// The queue is written to disk as soon as it changes, so nothing is lost if the launcher is closed before they finish.
+/// Failed uploads are retried, waiting longer each time.
+class UploadQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Does the upload for an entry. \return False if it failed and should be retried later.
+    using Handler = std::function<QCoro::Task<bool>(const QString &id)>;
+
+    /// Loads any uploads that were left over in @p path.
+    explicit UploadQueue(const QString &path, QObject *parent = nullptr);
+
+    /// Sets what does the actual uploading, and starts working through the queue.
+    void setHandler(Handler handler);
+
+    /// Adds an upload for @p id, or tries it again right away if it's already queued.
+    void enqueue(const QString &id);
+
+    /// Tries the upload for @p id now, if it's still queued. If it's already being uploaded, that's waited for instead.
+    /// \return True if there's nothing left to upload for @p id.
+    QCoro::Task<bool> drain(const QString &id);
+
+    [[nodiscard]] bool isPending(const QString &id) const;
+    [[nodiscard]] bool isEmpty() const;
+
+    /// \return How long to wait before trying again, after @p attempts failed attempts.
+    static std::chrono::milliseconds retryDelay(int attempts);
+
+Q_SIGNALS:
+    /// There's nothing more that can be uploaded right now. Either the queue is empty, or everything left is waiting to be retried.
+    void idle();
+    void attemptFinished(const QString &id, bool succeeded);
+
+private:
+    struct Entry {
+        QString id;
+        int attempts = 0;
+        QDateTime nextAttempt;
+        /// Whether it was queued again while it was being uploaded, so it has to be uploaded again anyway.
+        bool requeued = false;
+    };
+
+    QCoro::Task<> process();
+    /// @p id is copied, since the entry it came from might be gone by the time this finishes.
+    QCoro::Task<bool> attempt(QString id);
+    void schedule();
+
+    [[nodiscard]] Entry *find(const QString &id);
+    void load();
+    void save() const;
+
+    QString m_path;
+    Handler m_handler;
+    QList<Entry> m_entries;
+    QSet<QString> m_inProgress;
+    QTimer m_timer;
+    bool m_processing = false;
+};
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <QDir>
+#include <QFileDevice>
 #include <QNetworkRequest>
 
 namespace Utility
@@ -16,4 +17,7 @@ QString readVersion(const QString &path);
 void writeVersion(const QString &path, const QString &version);
 bool isSteamDeck();
 QString repositoryFromPatchUrl(const QString &url);
+QFileDevice::Permissions permissionsFromMode(quint32 mode);
+/// Gives disk access from the calling thread the lowest priority, so background work doesn't slow down anything else.
+void setLowIoPriority(bool enabled);
 }
\ No newline at end of file
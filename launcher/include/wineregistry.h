@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QByteArrayList>
+#include <QString>
+#include <optional>
+
+/// Reads and writes one of the registry files in a Wine prefix (like user.reg or system.reg) directly, without starting Wine.
+/// Anything that isn't changed is kept as-is, and the file is only written if something actually changed.
+/// wineserver keeps its own copy of the registry while it's running, so this should only be used while it's not. See WinePrefixLock.
+class WineRegistry
+{
+public:
+    explicit WineRegistry(const QString &path);
+
+    /// \return False if the file doesn't exist or isn't a Wine registry file.
+    bool load();
+
+    /// Sets @p name under @p key to a REG_SZ @p value. Keys are relative to the root of the file, like "Software\\Wine".
+    void setString(const QString &key, const QString &name, const QString &value);
+    void setDword(const QString &key, const QString &name, quint32 value);
+
+    /// Removes the value @p name under @p key, if it exists.
+    void remove(const QString &key, const QString &name);
+
+    /// \return The value @p name under @p key as it's written in the file (like "\"1\"" or "dword:00000001"), or nullopt if it doesn't exist.
+    [[nodiscard]] std::optional<QByteArray> rawValue(const QString &key, const QString &name) const;
+
+    /// \return True if anything was changed since load().
+    [[nodiscard]] bool isModified() const;
+
+    /// Writes the file if it was modified, replacing it atomically.
+    bool save();
+
+private:
+    /// \return The index of the line where @p key starts, or -1 if it doesn't exist.
+    [[nodiscard]] qsizetype findKey(const QString &key) const;
+
+    /// \return The index of the line after the last one in the key starting at @p header.
+    [[nodiscard]] qsizetype keyEnd(qsizetype header) const;
+
+    /// \return The range of lines holding @p name in the key starting at @p header, or {-1, -1} if it doesn't exist.
+    [[nodiscard]] std::pair<qsizetype, qsizetype> findValue(qsizetype header, const QString &name) const;
+
+    void setValue(const QString &key, const QString &name, const QByteArray &data);
+
+    QString m_path;
+    QByteArrayList m_lines;
+    bool m_modified = false;
+};
+
+/// Takes the same lock wineserver does for a prefix, so it can't start while the registry files are being edited.
+/// If wineserver is already running, the lock can't be taken.
+class WinePrefixLock
+{
+public:
+    explicit WinePrefixLock(const QString &prefixPath);
+    ~WinePrefixLock();
+
+    Q_DISABLE_COPY_MOVE(WinePrefixLock)
+
+    /// \return True if wineserver isn't running for this prefix, and won't start until this is destroyed.
+    [[nodiscard]] bool isLocked() const;
+
+private:
+    int m_fd = -1;
+    bool m_locked = false;
+};
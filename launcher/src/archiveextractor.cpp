@@ -0,0 +1,357 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "archiveextractor.h"
+#include "archivefilewriter.h"
+#include "astra_log.h"
+#include "utility.h"
+
+#include <KLocalizedString>
+#include <KZip>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QScopeGuard>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrentMap>
+#include <map>
+#include <zlib.h>
+
+using namespace Qt::StringLiterals;
+
+// How much of an entry is read or inflated at once, per thread
+constexpr qint64 chunkSize = 256 * 1024;
+
+// Past this, more threads only make the disk seek around more
+constexpr int maximumThreads = 8;
+
+// How many inflated chunks can be waiting to be written, across every thread, so memory use stays bounded
+constexpr qsizetype maximumQueuedChunks = 32;
+
+constexpr int zipStoredMethod = 0;
+constexpr int zipDeflateMethod = 8;
+
+/// Hands chunks from the inflating threads to the writer, and makes them wait while it's full.
+class ArchiveExtractor::ChunkQueue
+{
+public:
+    void push(Chunk chunk)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_chunks.size() >= maximumQueuedChunks) {
+            m_notFull.wait(&m_mutex);
+        }
+
+        m_chunks.push_back(std::move(chunk));
+        m_notEmpty.wakeOne();
+    }
+
+    /// \return The next chunk, or nullopt once the queue is closed and empty.
+    std::optional<Chunk> pop()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_chunks.isEmpty() && !m_closed) {
+            m_notEmpty.wait(&m_mutex);
+        }
+
+        if (m_chunks.isEmpty()) {
+            return std::nullopt;
+        }
+
+        Chunk chunk = m_chunks.takeFirst();
+        m_notFull.wakeAll();
+        return chunk;
+    }
+
+    /// Lets the writer finish once everything that's left has been written.
+    void close()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+    QList<Chunk> m_chunks;
+    bool m_closed = false;
+};
+
+ArchiveExtractor::ArchiveExtractor(const QString &filePath, const QString &directory)
+    : m_filePath(filePath)
+    , m_directory(directory)
+{
+}
+
+void ArchiveExtractor::setEntries(const QStringList &names)
+{
+    m_entries = names;
+}
+
+bool ArchiveExtractor::extract()
+{
+    KZip archive(m_filePath);
+    if (!archive.open(QIODevice::ReadOnly)) {
+        m_errorString = archive.errorString();
+        return false;
+    }
+
+    // Everything is planned up front from the central directory, so the actual work can be split up
+    const QDir directory(m_directory);
+    QList<Entry> entries;
+    QSet<QString> directories;
+    QList<std::pair<const KArchiveFile *, QString>> unsupportedEntries;
+
+    std::function<void(const KArchiveDirectory *, const QString &)> collectEntries = [&](const KArchiveDirectory *archiveDirectory, const QString &prefix) {
+        const QStringList names = archiveDirectory->entries();
+        for (const QString &name : names) {
+            if (name == ".."_L1) {
+                qWarning(ASTRA_LOG) << "Skipping unsafe archive entry" << prefix << name;
+                continue;
+            }
+
+            const QString entryName = prefix.isEmpty() ? name : prefix + '/'_L1 + name;
+            const KArchiveEntry *entry = archiveDirectory->entry(name);
+
+            if (entry->isDirectory()) {
+                if (m_entries.isEmpty()) {
+                    directories.insert(directory.absoluteFilePath(entryName));
+                }
+                collectEntries(static_cast<const KArchiveDirectory *>(entry), entryName);
+            } else if (entry->isFile()) {
+                if (!m_entries.isEmpty() && !m_entries.contains(entryName)) {
+                    continue;
+                }
+
+                const auto file = static_cast<const KZipFileEntry *>(entry);
+                const QString path = directory.absoluteFilePath(entryName);
+                directories.insert(QFileInfo(path).absolutePath());
+
+                if (file->encoding() != zipStoredMethod && file->encoding() != zipDeflateMethod) {
+                    unsupportedEntries.push_back({file, path});
+                    continue;
+                }
+
+                entries.push_back(Entry{
+                    .path = path,
+                    .position = file->position(),
+                    .compressedSize = file->compressedSize(),
+                    .size = file->size(),
+                    .encoding = file->encoding(),
+                    .permissions = Utility::permissionsFromMode(file->permissions()),
+                });
+            }
+        }
+    };
+    collectEntries(archive.directory(), {});
+
+    if (!m_entries.isEmpty() && entries.size() + unsupportedEntries.size() != m_entries.size()) {
+        m_errorString = i18n("Some files are missing from the archive.");
+        return false;
+    }
+
+    // Only the deepest directories need to be created, since their parents are made along the way
+    QStringList sortedDirectories = directories.values();
+    std::ranges::sort(sortedDirectories);
+    for (qsizetype i = 0; i < sortedDirectories.size(); i++) {
+        const bool hasChildren = i + 1 < sortedDirectories.size() && sortedDirectories[i + 1].startsWith(sortedDirectories[i] + '/'_L1);
+        if (!hasChildren && !QDir().mkpath(sortedDirectories[i])) {
+            m_errorString = i18n("Failed to create %1.", sortedDirectories[i]);
+            return false;
+        }
+    }
+
+    // Compression methods other than deflate are rare, so let KArchive handle them one at a time
+    for (const auto &[file, path] : std::as_const(unsupportedEntries)) {
+        if (!file->copyTo(QFileInfo(path).absolutePath())) {
+            m_errorString = i18n("Failed to write %1.", path);
+            return false;
+        }
+    }
+
+    archive.close();
+
+    // The biggest entries are started first, so one of them doesn't end up holding everything up at the end
+    std::ranges::sort(entries, [](const Entry &a, const Entry &b) {
+        return a.compressedSize > b.compressedSize;
+    });
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMin(QThread::idealThreadCount(), maximumThreads));
+
+    QMutex errorMutex;
+    std::atomic_bool failed = false;
+
+    const auto setError = [this, &errorMutex, &failed](const QString &error) {
+        failed = true;
+
+        const QMutexLocker locker(&errorMutex);
+        if (m_errorString.isEmpty()) {
+            m_errorString = error;
+        }
+    };
+
+    // Inflating happens on the pool, while all of the writing happens on one thread so the disk isn't seeking between files as much.
+    // The queue between them is bounded, so the pool has to wait if it gets too far ahead of the disk.
+    ChunkQueue queue;
+    const std::unique_ptr<QThread> writer(QThread::create([&queue, &setError] {
+        if (const auto error = writeChunks(queue)) {
+            setError(*error);
+        }
+    }));
+    writer->start();
+
+    QtConcurrent::blockingMap(&pool, entries, [this, &queue, &failed, &setError](const Entry &entry) {
+        if (failed) {
+            return;
+        }
+
+        if (const auto error = inflateEntry(entry, queue)) {
+            setError(*error);
+        }
+    });
+
+    queue.close();
+    writer->wait();
+
+    return !failed;
+}
+
+QString ArchiveExtractor::errorString() const
+{
+    return m_errorString;
+}
+
+std::optional<QString> ArchiveExtractor::inflateEntry(const Entry &entry, ChunkQueue &queue) const
+{
+    // Each thread needs its own handle, since they're all reading from different places
+    QFile archive(m_filePath);
+    if (!archive.open(QIODevice::ReadOnly) || !archive.seek(entry.position)) {
+        return archive.errorString();
+    }
+
+    qint64 written = 0;
+    const auto write = [&entry, &queue, &written](const QByteArrayView data) {
+        if (!data.isEmpty()) {
+            queue.push(Chunk{.entry = &entry, .data = data.toByteArray()});
+            written += data.size();
+        }
+    };
+
+    QByteArray input(chunkSize, Qt::Uninitialized);
+    qint64 remaining = entry.compressedSize;
+
+    const auto readChunk = [&archive, &input, &remaining]() -> qint64 {
+        const qint64 read = archive.read(input.data(), qMin(remaining, chunkSize));
+        if (read > 0) {
+            remaining -= read;
+        }
+        return read;
+    };
+
+    if (entry.encoding == zipStoredMethod) {
+        while (remaining > 0) {
+            const qint64 read = readChunk();
+            if (read <= 0) {
+                return i18n("%1 is corrupted.", entry.path);
+            }
+
+            write(QByteArrayView(input.constData(), read));
+        }
+    } else {
+        z_stream stream{};
+        // zip entries are raw deflate streams, without any header
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            return i18n("Failed to start decompressing %1.", entry.path);
+        }
+        const auto cleanup = qScopeGuard([&stream] {
+            inflateEnd(&stream);
+        });
+
+        QByteArray output(chunkSize, Qt::Uninitialized);
+        int ret = Z_OK;
+        bool needsInput = true;
+        while (ret != Z_STREAM_END) {
+            if (stream.avail_in == 0 && needsInput) {
+                const qint64 read = remaining > 0 ? readChunk() : 0;
+                if (read <= 0) {
+                    return i18n("%1 is corrupted.", entry.path);
+                }
+
+                stream.next_in = reinterpret_cast<Bytef *>(input.data());
+                stream.avail_in = static_cast<uInt>(read);
+            }
+
+            stream.next_out = reinterpret_cast<Bytef *>(output.data());
+            stream.avail_out = static_cast<uInt>(output.size());
+
+            ret = inflate(&stream, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                return i18n("%1 is corrupted.", entry.path);
+            }
+
+            const qint64 produced = output.size() - static_cast<qint64>(stream.avail_out);
+            write(QByteArrayView(output.constData(), produced));
+
+            // If the output filled up, there might be more to inflate before it needs more input
+            needsInput = stream.avail_out != 0;
+        }
+    }
+
+    // Checked before the writer commits, so a corrupted entry never replaces a good file
+    if (written != entry.size) {
+        return i18n("%1 is corrupted.", entry.path);
+    }
+
+    queue.push(Chunk{.entry = &entry, .last = true});
+
+    return std::nullopt;
+}
+
+std::optional<QString> ArchiveExtractor::writeChunks(ChunkQueue &queue)
+{
+    // Entries that aren't finished yet. If one never gets its last chunk, it's thrown away without replacing anything.
+    std::map<const Entry *, std::unique_ptr<ArchiveFileWriter>> files;
+    std::optional<QString> error;
+
+    while (auto chunk = queue.pop()) {
+        // Keep taking chunks after an error, otherwise the inflating threads would be stuck waiting for space
+        if (error) {
+            continue;
+        }
+
+        const Entry &entry = *chunk->entry;
+
+        auto &file = files[&entry];
+        if (!file) {
+            file = std::make_unique<ArchiveFileWriter>();
+            if (!file->open(entry.path, entry.size)) {
+                error = file->errorString();
+                continue;
+            }
+        }
+
+        if (!chunk->data.isEmpty() && !file->write(chunk->data)) {
+            error = file->errorString();
+            continue;
+        }
+
+        if (chunk->last) {
+            if (!file->commit()) {
+                error = file->errorString();
+                continue;
+            }
+            files.erase(&entry);
+
+            if (entry.permissions.toInt() != 0 && QFile::permissions(entry.path) != entry.permissions) {
+                QFile::setPermissions(entry.path, entry.permissions);
+            }
+        }
+    }
+
+    return error;
+}
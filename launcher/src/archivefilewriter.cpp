@@ -0,0 +1,142 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "archivefilewriter.h"
+
+#include <KLocalizedString>
+#include <QFileInfo>
+
+// How much of the existing file is read at once
+constexpr qint64 compareChunkSize = 256 * 1024;
+
+bool ArchiveFileWriter::open(const QString &path, const qint64 expectedSize)
+{
+    m_path = path;
+    m_compared = 0;
+    m_changed = false;
+    m_errorString.clear();
+    m_output.reset();
+    m_existing.close();
+    m_open = true;
+
+    const QFileInfo info(path);
+
+    // Links are replaced instead of compared, otherwise we'd be writing to whatever they point to
+    if (info.isSymLink()) {
+        QFile::remove(path);
+        return startWriting();
+    }
+
+    if (!info.isFile() || (expectedSize != -1 && info.size() != expectedSize)) {
+        return startWriting();
+    }
+
+    m_existing.setFileName(path);
+    if (!m_existing.open(QIODevice::ReadOnly)) {
+        return startWriting();
+    }
+
+    return true;
+}
+
+bool ArchiveFileWriter::write(const QByteArrayView data)
+{
+    if (m_output) {
+        if (m_output->write(data.data(), data.size()) != data.size()) {
+            return fail(i18n("Failed to write %1: %2", m_path, m_output->errorString()));
+        }
+
+        return true;
+    }
+
+    const QByteArray existing = m_existing.read(data.size());
+    if (existing == data) {
+        m_compared += data.size();
+        return true;
+    }
+
+    return startWriting() && write(data);
+}
+
+bool ArchiveFileWriter::commit()
+{
+    m_open = false;
+
+    // If there's still more in the existing file, then the new one is shorter
+    if (!m_output && !m_existing.atEnd() && !startWriting()) {
+        return false;
+    }
+
+    if (!m_output) {
+        m_existing.close();
+        return true;
+    }
+
+    if (!m_output->commit()) {
+        return fail(i18n("Failed to write %1: %2", m_path, m_output->errorString()));
+    }
+
+    m_output.reset();
+
+    return true;
+}
+
+bool ArchiveFileWriter::isOpen() const
+{
+    return m_open;
+}
+
+bool ArchiveFileWriter::wasChanged() const
+{
+    return m_changed;
+}
+
+QString ArchiveFileWriter::errorString() const
+{
+    return m_errorString;
+}
+
+bool ArchiveFileWriter::startWriting()
+{
+    m_changed = true;
+
+    m_output = std::make_unique<QSaveFile>(m_path);
+    if (!m_output->open(QIODevice::WriteOnly)) {
+        return fail(i18n("Failed to write %1: %2", m_path, m_output->errorString()));
+    }
+
+    // Everything compared so far was the same, so it can be copied over from the existing file
+    if (m_compared > 0) {
+        if (!m_existing.seek(0)) {
+            return fail(i18n("Failed to read %1: %2", m_path, m_existing.errorString()));
+        }
+
+        qint64 remaining = m_compared;
+        while (remaining > 0) {
+            const QByteArray data = m_existing.read(qMin(remaining, compareChunkSize));
+            if (data.isEmpty()) {
+                return fail(i18n("Failed to read %1: %2", m_path, m_existing.errorString()));
+            }
+
+            if (m_output->write(data) != data.size()) {
+                return fail(i18n("Failed to write %1: %2", m_path, m_output->errorString()));
+            }
+
+            remaining -= data.size();
+        }
+    }
+
+    m_existing.close();
+
+    return true;
+}
+
+bool ArchiveFileWriter::fail(const QString &message)
+{
+    m_errorString = message;
+    m_open = false;
+    if (m_output) {
+        m_output->cancelWriting();
+    }
+    return false;
+}
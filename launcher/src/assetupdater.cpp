@@ -3,22 +3,52 @@
 
 #include "assetupdater.h"
 #include "astra_log.h"
+#include "bandwidthlimiter.h"
+#include "filedownloader.h"
+#include "streamingextractor.h"
 #include "utility.h"
 
+#include <KFormat>
 #include <KLocalizedString>
-#include <KTar>
-#include <KZip>
 #include <QFile>
 #include <QJsonDocument>
 #include <QNetworkReply>
+#include <QPromise>
 #include <QStandardPaths>
+#include <QThreadPool>
 #include <qcorofuture.h>
+#include <qcoroiodevice.h>
 #include <qcoronetworkreply.h>
+#include <qcorosignal.h>
 
+#include <QtConcurrentFilter>
 #include <QtConcurrentRun>
 
 using namespace Qt::StringLiterals;
 
+// How many downloads can run at the same time
+constexpr int maximumConcurrentTasks = 3;
+
+// How much of a download can be buffered in memory while waiting for it to be extracted
+constexpr qint64 readBufferSize = 4 * 1024 * 1024;
+constexpr qint64 throttledReadBufferSize = 64 * 1024;
+
+/// Runs @p function on another thread. If @p background is true, its disk access is given a low priority.
+template<typename Function>
+static auto runOnThread(const bool background, Function function)
+{
+    return QtConcurrent::run([background, function] {
+        if (background) {
+            Utility::setLowIoPriority(true);
+        }
+        const auto result = function();
+        if (background) {
+            Utility::setLowIoPriority(false);
+        }
+        return result;
+    });
+}
+
 AssetUpdater::AssetUpdater(Profile &profile, LauncherCore &launcher, QObject *parent)
     : QObject(parent)
     , launcher(launcher)
@@ -26,13 +56,23 @@ AssetUpdater::AssetUpdater(Profile &profile, LauncherCore &launcher, QObject *pa
 {
 }
 
-QCoro::Task<bool> AssetUpdater::update()
+void AssetUpdater::setBackground(BandwidthLimiter *limiter)
 {
-    qInfo(ASTRA_LOG) << "Checking for compatibility tool updates...";
+    m_limiter = limiter;
+}
 
+QCoro::Task<bool> AssetUpdater::update()
+{
     m_dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
 
+    // Most of these don't depend on each other, so they all run at the same time.
+    // The compatibility tool, DXVK, Dalamud assets and the Dalamud version check are independent.
+    // Dalamud and the .NET runtime depend on the version check, which starts them once it's finished.
+    std::vector<QCoro::Task<bool>> tasks;
+
     if (LauncherCore::needsCompatibilityTool()) {
+        qInfo(ASTRA_LOG) << "Checking for compatibility tool updates...";
+
         const QDir compatibilityToolDir = m_dataDir.absoluteFilePath(QStringLiteral("tool"));
         m_wineDir = compatibilityToolDir.absoluteFilePath(QStringLiteral("wine"));
         m_dxvkDir = compatibilityToolDir.absoluteFilePath(QStringLiteral("dxvk"));
@@ -40,44 +80,34 @@ QCoro::Task<bool> AssetUpdater::update()
         Utility::createPathIfNeeded(m_wineDir);
         Utility::createPathIfNeeded(m_dxvkDir);
 
-        if (m_profile.wineType() == Profile::WineType::BuiltIn && !co_await checkRemoteCompatibilityToolVersion()) {
-            co_return false;
-        }
+        if (m_profile.wineType() == Profile::WineType::BuiltIn) {
+            tasks.push_back(checkRemoteCompatibilityToolVersion());
 
-        // TODO: should DXVK be tied to this setting...?
-        if (m_profile.wineType() == Profile::WineType::BuiltIn && !co_await checkRemoteDxvkVersion()) {
-            co_return false;
+            // TODO: should DXVK be tied to this setting...?
+            tasks.push_back(checkRemoteDxvkVersion());
         }
     }
 
-    if (!m_profile.dalamudEnabled()) {
-        co_return true;
-    }
-
-    qInfo(ASTRA_LOG) << "Checking for asset updates...";
+    if (m_profile.dalamudEnabled()) {
+        qInfo(ASTRA_LOG) << "Checking for asset updates...";
 
-    m_dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    m_dalamudDir = m_dataDir.absoluteFilePath(QStringLiteral("dalamud"));
-    m_dalamudAssetDir = m_dalamudDir.absoluteFilePath(QStringLiteral("assets"));
-    m_dalamudRuntimeDir = m_dalamudDir.absoluteFilePath(QStringLiteral("runtime"));
+        m_dalamudDir = m_dataDir.absoluteFilePath(QStringLiteral("dalamud"));
+        m_dalamudAssetDir = m_dalamudDir.absoluteFilePath(QStringLiteral("assets"));
+        m_dalamudRuntimeDir = m_dalamudDir.absoluteFilePath(QStringLiteral("runtime"));
 
-    Utility::createPathIfNeeded(m_dalamudDir);
-    Utility::createPathIfNeeded(m_dalamudAssetDir);
-    Utility::createPathIfNeeded(m_dalamudRuntimeDir);
-
-    if (m_profile.dalamudChannel() != Profile::DalamudChannel::Local) {
-        if (!co_await checkRemoteDalamudAssetVersion()) {
-            co_return false;
-        }
+        Utility::createPathIfNeeded(m_dalamudDir);
+        Utility::createPathIfNeeded(m_dalamudAssetDir);
+        Utility::createPathIfNeeded(m_dalamudRuntimeDir);
 
-        if (!co_await checkRemoteDalamudVersion()) {
-            co_return false;
+        if (m_profile.dalamudChannel() != Profile::DalamudChannel::Local) {
+            tasks.push_back(checkRemoteDalamudAssetVersion());
+            tasks.push_back(checkRemoteDalamudVersion());
+        } else {
+            qInfo(ASTRA_LOG) << "Using a local Dalamud installation, skipping version checks!";
         }
-    } else {
-        qInfo(ASTRA_LOG) << "Using a local Dalamud installation, skipping version checks!";
     }
 
-    co_return true;
+    co_return co_await allSucceeded(std::move(tasks));
 }
 
 QCoro::Task<bool> AssetUpdater::checkRemoteCompatibilityToolVersion()
@@ -131,7 +161,7 @@ QCoro::Task<bool> AssetUpdater::checkRemoteDalamudAssetVersion()
     co_await reply;
 
     if (reply->error() != QNetworkReply::NetworkError::NoError) {
-        Q_EMIT launcher.dalamudError(i18n("Could not check for Dalamud asset updates.\n\n%1", reply->errorString()));
+        reportError(&LauncherCore::dalamudError, i18n("Could not check for Dalamud asset updates.\n\n%1", reply->errorString()));
         co_return false;
     }
 
@@ -173,7 +203,7 @@ QCoro::Task<bool> AssetUpdater::checkRemoteDalamudVersion()
     co_await reply;
 
     if (reply->error() != QNetworkReply::NetworkError::NoError) {
-        Q_EMIT launcher.dalamudError(i18n("Could not check for Dalamud updates.\n\n%1", reply->errorString()));
+        reportError(&LauncherCore::dalamudError, i18n("Could not check for Dalamud updates.\n\n%1", reply->errorString()));
         co_return false;
     }
 
@@ -188,212 +218,389 @@ QCoro::Task<bool> AssetUpdater::checkRemoteDalamudVersion()
     qInfo(ASTRA_LOG) << "Latest available Dalamud version:" << m_remoteDalamudVersion << "local:" << m_profile.dalamudVersion();
     qInfo(ASTRA_LOG) << "Latest available NET runtime:" << m_remoteRuntimeVersion;
 
+    std::vector<QCoro::Task<bool>> tasks;
+
     if (m_remoteDalamudVersion != m_profile.dalamudVersion()) {
-        if (!co_await installDalamud()) {
-            co_return false;
-        }
+        tasks.push_back(installDalamud());
     }
 
     if (m_profile.runtimeVersion() != m_remoteRuntimeVersion) {
-        if (!co_await installRuntime()) {
-            co_return false;
-        }
+        tasks.push_back(installRuntime());
     }
 
-    co_return true;
+    co_return co_await allSucceeded(std::move(tasks));
 }
 
-QCoro::Task<bool> AssetUpdater::installCompatibilityTool() const
+QCoro::Task<bool> AssetUpdater::installCompatibilityTool()
 {
-    Q_EMIT launcher.stageChanged(i18n("Updating compatibility tool..."));
-
-    const auto request = QNetworkRequest(QUrl(m_remoteCompatibilityToolUrl));
-    Utility::printRequest(QStringLiteral("GET"), request);
-
-    const auto reply = launcher.mgr()->get(request);
-    co_await reply;
-
-    if (reply->error() != QNetworkReply::NetworkError::NoError) {
-        Q_EMIT launcher.miscError(i18n("Could not update compatibility tool:\n\n%1", reply->errorString()));
+    // the first directory is the same as the version we download
+    if (const auto error =
+            co_await downloadAndExtract(i18n("compatibility tool"), QUrl(m_remoteCompatibilityToolUrl), m_wineDir.absolutePath(), m_remoteCompatibilityToolVersion)) {
+        reportError(&LauncherCore::miscError, i18n("Could not update compatibility tool:\n\n%1", *error));
         co_return false;
     }
 
-    qInfo(ASTRA_LOG) << "Finished downloading compatibility tool";
+    qInfo(ASTRA_LOG) << "Finished installing compatibility tool";
 
-    QFile file(m_tempDir.filePath(QStringLiteral("wine.tar.xz")));
-    file.open(QIODevice::WriteOnly);
-    file.write(reply->readAll());
-    file.close();
+    Utility::writeVersion(m_wineDir.absoluteFilePath(QStringLiteral("wine.ver")), m_remoteCompatibilityToolVersion);
 
-    KTar archive(m_tempDir.filePath(QStringLiteral("wine.tar.xz")));
-    if (!archive.open(QIODevice::ReadOnly)) {
-        qCritical(ASTRA_LOG) << "Failed to install compatibility tool";
-        Q_EMIT launcher.miscError(i18n("Failed to install compatibility tool."));
-        co_return false;
-    }
+    m_profile.setCompatibilityToolVersion(m_remoteCompatibilityToolVersion);
 
-    // the first directory is the same as the version we download
-    const auto *root = dynamic_cast<const KArchiveDirectory *>(archive.directory()->entry(m_remoteCompatibilityToolVersion));
-    Q_UNUSED(root->copyTo(m_wineDir.absolutePath(), true))
+    co_return true;
+}
 
-    archive.close();
+QCoro::Task<bool> AssetUpdater::installDxvkTool()
+{
+    // the first directory is the same as the version we download
+    if (const auto error = co_await downloadAndExtract(QStringLiteral("DXVK"), QUrl(m_remoteDxvkToolUrl), m_dxvkDir.absolutePath(), m_remoteDxvkToolVersion)) {
+        reportError(&LauncherCore::miscError, i18n("Could not update DXVK:\n\n%1", *error));
+        co_return false;
+    }
 
-    Utility::writeVersion(m_wineDir.absoluteFilePath(QStringLiteral("wine.ver")), m_remoteCompatibilityToolVersion);
+    qInfo(ASTRA_LOG) << "Finished installing DXVK";
 
-    m_profile.setCompatibilityToolVersion(m_remoteCompatibilityToolVersion);
+    Utility::writeVersion(m_dxvkDir.absoluteFilePath(QStringLiteral("dxvk.ver")), m_remoteDxvkToolVersion);
 
     co_return true;
 }
 
-QCoro::Task<bool> AssetUpdater::installDxvkTool() const
+QCoro::Task<bool> AssetUpdater::installDalamudAssets()
 {
-    Q_EMIT launcher.stageChanged(i18n("Updating DXVK..."));
+    // The whole package is only worth downloading when there's nothing here yet, otherwise only what changed is fetched
+    if (m_profile.dalamudAssetVersion() == -1) {
+        if (const auto error = co_await downloadAndExtract(i18n("Dalamud assets"), QUrl(m_remoteDalamudAssetPackageUrl), m_dalamudAssetDir.absolutePath())) {
+            reportError(&LauncherCore::dalamudError, i18n("Could not update Dalamud assets:\n\n%1", *error));
+            co_return false;
+        }
 
-    const auto request = QNetworkRequest(QUrl(m_remoteDxvkToolUrl));
-    Utility::printRequest(QStringLiteral("GET"), request);
+        qInfo(ASTRA_LOG) << "Finished installing Dalamud asset package";
+    }
 
-    const auto reply = launcher.mgr()->get(request);
-    co_await reply;
+    QList<DalamudAsset> assets;
+    for (const auto &value : std::as_const(m_remoteDalamudAssetArray)) {
+        const QJsonObject asset = value.toObject();
 
-    qInfo(ASTRA_LOG) << "Finished downloading DXVK";
+        const QString fileName = QDir::cleanPath(asset["fileName"_L1].toString());
+        if (fileName.isEmpty() || QDir::isAbsolutePath(fileName) || fileName.startsWith(".."_L1)) {
+            qWarning(ASTRA_LOG) << "Skipping unsafe Dalamud asset" << fileName;
+            continue;
+        }
 
-    if (reply->error() != QNetworkReply::NetworkError::NoError) {
-        Q_EMIT launcher.miscError(i18n("Could not update DXVK:\n\n%1", reply->errorString()));
+        assets.push_back(DalamudAsset{
+            .url = QUrl(asset["url"_L1].toString()),
+            .path = m_dalamudAssetDir.absoluteFilePath(fileName),
+            .hash = QByteArray::fromHex(asset["hash"_L1].toString().toLatin1()),
+        });
+    }
+
+    // Hashing is done across multiple threads, since there's quite a few assets
+    const bool background = isBackground();
+    const QList<DalamudAsset> outdatedAssets = co_await QtConcurrent::run([assets, background] {
+        QThreadPool pool;
+        return QtConcurrent::blockingFiltered(&pool, assets, [background](const DalamudAsset &asset) {
+            // These threads go away with the pool, so there's no need to put the priority back
+            if (background) {
+                Utility::setLowIoPriority(true);
+            }
+            return isAssetOutdated(asset);
+        });
+    });
+
+    qInfo(ASTRA_LOG) << outdatedAssets.size() << "of" << assets.size() << "Dalamud assets need to be updated";
+
+    std::vector<QCoro::Task<std::optional<QString>>> downloads;
+    for (const auto &asset : outdatedAssets) {
+        Utility::createPathIfNeeded(QFileInfo(asset.path).absolutePath());
+        // Keyed by the relative path, since assets in different folders can have the same name
+        downloads.push_back(download(m_dalamudAssetDir.relativeFilePath(asset.path), asset.url, asset.path, asset.hash));
+    }
+
+    bool success = true;
+    for (auto &assetDownload : downloads) {
+        if (const auto error = co_await assetDownload) {
+            // Only show the first error, there's no point in showing the same one for every asset
+            if (success) {
+                reportError(&LauncherCore::dalamudError, i18n("Could not update Dalamud assets:\n\n%1", *error));
+            }
+            success = false;
+        }
+    }
+
+    if (!success) {
         co_return false;
     }
 
-    QFile file(m_tempDir.filePath(QStringLiteral("dxvk.tar.xz")));
-    file.open(QIODevice::WriteOnly);
-    file.write(reply->readAll());
-    file.close();
+    qInfo(ASTRA_LOG) << "Finished updating Dalamud assets";
+
+    m_profile.setDalamudAssetVersion(m_remoteDalamudAssetVersion);
+
+    Utility::writeVersion(m_dalamudAssetDir.absoluteFilePath(QStringLiteral("asset.ver")), QString::number(m_remoteDalamudAssetVersion));
 
-    KTar archive(m_tempDir.filePath(QStringLiteral("dxvk.tar.xz")));
-    if (!archive.open(QIODevice::ReadOnly)) {
-        qCritical(ASTRA_LOG) << "Failed to install DXVK";
-        Q_EMIT launcher.miscError(i18n("Failed to install DXVK."));
+    co_return true;
+}
+
+QCoro::Task<bool> AssetUpdater::installDalamud()
+{
+    if (const auto error = co_await downloadAndExtract(QStringLiteral("Dalamud"),
+                                                        QUrl(m_remoteDalamudDownloadUrl),
+                                                        m_dalamudDir.absoluteFilePath(m_profile.dalamudChannelName()))) {
+        reportError(&LauncherCore::dalamudError, i18n("Could not update Dalamud:\n\n%1", *error));
         co_return false;
     }
 
-    // the first directory is the same as the version we download
-    const auto *root = dynamic_cast<const KArchiveDirectory *>(archive.directory()->entry(m_remoteDxvkToolVersion));
-    Q_UNUSED(root->copyTo(m_dxvkDir.absolutePath(), true))
+    qInfo(ASTRA_LOG) << "Finished installing Dalamud";
 
-    archive.close();
+    m_profile.setDalamudVersion(m_remoteDalamudVersion);
 
-    Utility::writeVersion(m_dxvkDir.absoluteFilePath(QStringLiteral("dxvk.ver")), m_remoteDxvkToolVersion);
+    co_return true;
+}
+
+QCoro::Task<bool> AssetUpdater::installRuntime()
+{
+    // The core and desktop runtimes are separate packages, so grab both at once.
+    // They share some files though, so the desktop runtime isn't extracted until the core one is done, otherwise they'd be writing over each other.
+    QPromise<void> coreExtracted;
+    coreExtracted.start();
+
+    auto coreInstall = downloadAndExtract(i18n(".NET Runtime"), dotnetRuntimePackageUrl(m_remoteRuntimeVersion), m_dalamudRuntimeDir.absolutePath());
+    auto desktopInstall = downloadAndExtract(i18n(".NET Desktop Runtime"),
+                                             dotnetDesktopPackageUrl(m_remoteRuntimeVersion),
+                                             m_dalamudRuntimeDir.absolutePath(),
+                                             {},
+                                             coreExtracted.future());
+
+    const auto coreError = co_await coreInstall;
+    coreExtracted.finish();
+    const auto desktopError = co_await desktopInstall;
+
+    for (const auto &error : {coreError, desktopError}) {
+        if (error) {
+            reportError(&LauncherCore::dalamudError, i18n("Could not update .NET runtime:\n\n%1", *error));
+            co_return false;
+        }
+    }
+
+    qInfo(ASTRA_LOG) << "Finished installing Dotnet-core and Dotnet-desktop";
+
+    Utility::writeVersion(m_dalamudRuntimeDir.absoluteFilePath(QStringLiteral("runtime.ver")), m_remoteRuntimeVersion);
 
     co_return true;
 }
 
-QCoro::Task<bool> AssetUpdater::installDalamudAssets()
+QCoro::Task<bool> AssetUpdater::allSucceeded(std::vector<QCoro::Task<bool>> tasks)
 {
-    Q_EMIT launcher.stageChanged(i18n("Updating Dalamud assets..."));
+    bool success = true;
+    for (auto &task : tasks) {
+        if (!co_await task) {
+            success = false;
+        }
+    }
 
-    const auto request = QNetworkRequest(QUrl(m_remoteDalamudAssetPackageUrl));
-    Utility::printRequest(QStringLiteral("GET"), request);
+    co_return success;
+}
 
-    const auto reply = launcher.mgr()->get(request);
-    co_await reply;
+QCoro::Task<> AssetUpdater::acquireSlot()
+{
+    while (m_activeSlots >= maximumConcurrentTasks) {
+        co_await qCoro(this, &AssetUpdater::slotReleased);
+    }
 
-    qInfo(ASTRA_LOG) << "Finished downloading Dalamud assets";
+    m_activeSlots++;
+}
 
-    QFile file(m_tempDir.filePath(QStringLiteral("dalamud-assets.zip")));
-    file.open(QIODevice::WriteOnly);
-    file.write(reply->readAll());
-    file.close();
+void AssetUpdater::releaseSlot()
+{
+    m_activeSlots--;
+    Q_EMIT slotReleased();
+}
 
-    if (!extractZip(m_tempDir.filePath(QStringLiteral("dalamud-assets.zip")), m_dalamudAssetDir.absolutePath())) {
-        qCritical(ASTRA_LOG) << "Failed to install Dalamud assets";
-        Q_EMIT launcher.dalamudError(i18n("Failed to install Dalamud assets."));
-        co_return false;
+QCoro::Task<std::optional<QString>> AssetUpdater::download(const QString &task, const QUrl &url, const QString &filePath, const QByteArray &sha1Hash)
+{
+    co_await acquireSlot();
+
+    // This is only shown once it's actually downloading, since a lot of these can be queued up at once
+    updateProgress(task, 0, 0);
+
+    FileDownloader downloader(launcher.mgr(), url, filePath);
+    downloader.setBandwidthLimiter(m_limiter);
+    if (!sha1Hash.isEmpty()) {
+        downloader.setExpectedHash(QCryptographicHash::Sha1, sha1Hash);
     }
+    connect(&downloader, &FileDownloader::progress, this, [this, task](const qint64 received, const qint64 total) {
+        updateProgress(task, received, total);
+    });
 
-    // TODO: check for file hashes
+    const bool success = co_await downloader.download();
 
-    m_profile.setDalamudAssetVersion(m_remoteDalamudAssetVersion);
+    releaseSlot();
+    finishProgress(task);
 
-    Utility::writeVersion(m_dalamudAssetDir.absoluteFilePath(QStringLiteral("asset.ver")), QString::number(m_remoteDalamudAssetVersion));
+    if (!success) {
+        qCritical(ASTRA_LOG) << "Failed to download" << url << downloader.errorString();
+        co_return downloader.errorString();
+    }
 
-    co_return true;
+    co_return std::nullopt;
 }
 
-QCoro::Task<bool> AssetUpdater::installDalamud()
+QCoro::Task<std::optional<QString>>
+AssetUpdater::downloadAndExtract(const QString &task, const QUrl &url, const QString &directory, const QString &root, QFuture<void> extractAfter)
 {
-    Q_EMIT launcher.stageChanged(i18n("Updating Dalamud..."));
+    updateProgress(task, 0, 0);
 
-    const auto request = QNetworkRequest(QUrl(m_remoteDalamudDownloadUrl));
+    co_await acquireSlot();
+
+    const QNetworkRequest request(url);
     Utility::printRequest(QStringLiteral("GET"), request);
 
     const auto reply = launcher.mgr()->get(request);
-    co_await reply;
+    // The socket is paused once this fills up, so the download can't get too far ahead of extraction (or the bandwidth limit)
+    reply->setReadBufferSize(isBackground() ? throttledReadBufferSize : readBufferSize);
+    connect(reply, &QNetworkReply::downloadProgress, this, [this, task](const qint64 received, const qint64 total) {
+        updateProgress(task, received, total);
+    });
+
+    StreamingExtractor extractor(directory, root);
+    std::optional<QString> error;
+
+    // Anything downloaded before extraction is allowed to start
+    QByteArray held;
+
+    // Each chunk is extracted on another thread, while the next one is downloading
+    while (!error && (!reply->isFinished() || reply->bytesAvailable() > 0)) {
+        QByteArray data = co_await qCoro(reply).readAll();
+        if (data.isEmpty()) {
+            continue;
+        }
 
-    qInfo(ASTRA_LOG) << "Finished downloading Dalamud";
+        if (m_limiter) {
+            co_await m_limiter->acquire(data.size());
+        }
 
-    QFile file(m_tempDir.filePath(QStringLiteral("latest.zip")));
-    file.open(QIODevice::WriteOnly);
-    file.write(reply->readAll());
-    file.close();
+        if (!extractAfter.isFinished()) {
+            held += data;
+            continue;
+        }
 
-    if (!extractZip(m_tempDir.filePath(QStringLiteral("latest.zip")), m_dalamudDir.absoluteFilePath(m_profile.dalamudChannelName()))) {
-        qCritical(ASTRA_LOG) << "Failed to install Dalamud";
-        Q_EMIT launcher.dalamudError(i18n("Failed to install Dalamud."));
-        co_return false;
+        if (!held.isEmpty()) {
+            data.prepend(held);
+            held.clear();
+        }
+
+        if (!co_await runOnThread(isBackground(), [&extractor, data] {
+                return extractor.write(data);
+            })) {
+            error = extractor.errorString();
+            reply->abort();
+        }
     }
 
-    m_profile.setDalamudVersion(m_remoteDalamudVersion);
+    // The whole archive arrived before it could be extracted
+    if (!error && !held.isEmpty()) {
+        co_await extractAfter;
 
-    co_return true;
-}
+        if (!co_await runOnThread(isBackground(), [&extractor, held] {
+                return extractor.write(held);
+            })) {
+            error = extractor.errorString();
+        }
+    }
 
-QCoro::Task<bool> AssetUpdater::installRuntime()
-{
-    Q_EMIT launcher.stageChanged(i18n("Updating .NET Runtime..."));
+    if (!error && reply->error() != QNetworkReply::NetworkError::NoError) {
+        error = reply->errorString();
+    }
 
-    // core
-    {
-        const QNetworkRequest request(dotnetRuntimePackageUrl(m_remoteRuntimeVersion));
-        Utility::printRequest(QStringLiteral("GET"), request);
+    if (!error && !extractor.finish()) {
+        error = extractor.errorString();
+    }
 
-        const auto reply = launcher.mgr()->get(request);
-        co_await reply;
+    reply->deleteLater();
 
-        qInfo(ASTRA_LOG) << "Finished downloading Dotnet-core";
+    releaseSlot();
+    finishProgress(task);
 
-        QFile file(m_tempDir.filePath(QStringLiteral("dotnet-core.zip")));
-        file.open(QIODevice::WriteOnly);
-        file.write(reply->readAll());
-        file.close();
+    if (error) {
+        qCritical(ASTRA_LOG) << "Failed to download and extract" << url << *error;
     }
 
-    // desktop
-    {
-        const QNetworkRequest request(dotnetDesktopPackageUrl(m_remoteRuntimeVersion));
-        Utility::printRequest(QStringLiteral("GET"), request);
+    co_return error;
+}
 
-        const auto reply = launcher.mgr()->get(request);
-        co_await reply;
+bool AssetUpdater::isAssetOutdated(const DalamudAsset &asset)
+{
+    QFile file(asset.path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return true;
+    }
 
-        qInfo(ASTRA_LOG) << "Finished downloading Dotnet-desktop";
+    // Some assets don't have a hash, so all we can do is check that they exist
+    if (asset.hash.isEmpty()) {
+        return false;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+
+    return hash.result() != asset.hash;
+}
+
+void AssetUpdater::updateProgress(const QString &task, const qint64 received, const qint64 total)
+{
+    m_taskProgress[task] = TaskProgress{.received = received, .total = total};
+    updateStage();
+}
+
+void AssetUpdater::finishProgress(const QString &task)
+{
+    m_taskProgress.remove(task);
+    updateStage();
+}
 
-        QFile file(m_tempDir.filePath(QStringLiteral("dotnet-desktop.zip")));
-        file.open(QIODevice::WriteOnly);
-        file.write(reply->readAll());
-        file.close();
+void AssetUpdater::updateStage()
+{
+    // Nobody is waiting on a background update, so there's nothing to show
+    if (m_taskProgress.isEmpty() || isBackground()) {
+        return;
     }
 
-    bool success = extractZip(m_tempDir.filePath(QStringLiteral("dotnet-core.zip")), m_dalamudRuntimeDir.absolutePath());
-    success |= extractZip(m_tempDir.filePath(QStringLiteral("dotnet-desktop.zip")), m_dalamudRuntimeDir.absolutePath());
+    qint64 received = 0;
+    qint64 total = 0;
+    bool knowsTotal = true;
+    for (const auto &progress : std::as_const(m_taskProgress)) {
+        received += progress.received;
+        total += progress.total;
+        knowsTotal &= progress.total > 0;
+    }
 
-    if (!success) {
-        qCritical(ASTRA_LOG) << "Failed to install dotnet";
-        Q_EMIT launcher.dalamudError(i18n("Failed to install .NET runtime."));
+    const QString tasks = QLocale().createSeparatedList(m_taskProgress.keys());
 
-        co_return false;
+    if (knowsTotal) {
+        KFormat format;
+        Q_EMIT launcher.stageChanged(i18n("Updating %1...", tasks),
+                                     i18n("%1 of %2", format.formatByteSize(static_cast<double>(received)), format.formatByteSize(static_cast<double>(total))));
+        // In kilobytes, since this wouldn't fit in an int otherwise
+        Q_EMIT launcher.stageDeterminate(0, static_cast<int>(total / 1024), static_cast<int>(received / 1024));
+        Q_EMIT launcher.downloadProgress(received, total);
     } else {
-        Utility::writeVersion(m_dalamudRuntimeDir.absoluteFilePath(QStringLiteral("runtime.ver")), m_remoteRuntimeVersion);
+        Q_EMIT launcher.stageChanged(i18n("Updating %1...", tasks));
+        Q_EMIT launcher.stageIndeterminate();
+    }
+}
 
-        co_return true;
+bool AssetUpdater::isBackground() const
+{
+    return m_limiter != nullptr;
+}
+
+void AssetUpdater::reportError(void (LauncherCore::*signal)(QString), const QString &message)
+{
+    if (isBackground()) {
+        // It'll be tried again when logging in, which is when the user actually needs to know about it
+        qWarning(ASTRA_LOG) << "Background update failed:" << message;
+        return;
     }
+
+    Q_EMIT(launcher.*signal)(message);
 }
 
 QUrl AssetUpdater::dalamudVersionManifestUrl() const
@@ -436,22 +643,4 @@ QUrl AssetUpdater::dotnetDesktopPackageUrl(const QString &version) const
     return url;
 }
 
-bool AssetUpdater::extractZip(const QString &filePath, const QString &directory)
-{
-    KZip archive(filePath);
-    if (!archive.open(QIODevice::ReadOnly)) {
-        return false;
-    }
-
-    const KArchiveDirectory *root = archive.directory();
-    if (!root->copyTo(directory, true)) {
-        archive.close();
-        return false;
-    }
-
-    archive.close();
-
-    return true;
-}
-
 #include "moc_assetupdater.cpp"
\ No newline at end of file
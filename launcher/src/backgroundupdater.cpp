@@ -0,0 +1,248 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "backgroundupdater.h"
+#include "account.h"
+#include "assetupdater.h"
+#include "astra_log.h"
+#include "bandwidthlimiter.h"
+#include "filedownloader.h"
+#include "launchercore.h"
+#include "patcher.h"
+#include "squareenixlogin.h"
+#include "utility.h"
+
+#include <KLocalizedString>
+#include <QCryptographicHash>
+#include <QNetworkReply>
+#include <QStorageInfo>
+#include <QtConcurrentRun>
+#include <algorithm>
+#include <qcorofuture.h>
+#include <qcoronetworkreply.h>
+#include <qcorosignal.h>
+
+// Give the launcher some time to settle down after starting, before the first check
+constexpr auto initialDelay = std::chrono::minutes(1);
+
+// Checking any more often than this isn't useful
+constexpr int minimumInterval = 15;
+
+/// \return True if the patch at @p path is the right size, and matches @p hashes if there are any.
+static bool isPatchValid(const QString &path, const qint64 length, const QStringList &hashes, const qint64 hashBlockSize)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() != length) {
+        return false;
+    }
+
+    for (const auto &expectedHash : hashes) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(file.read(hashBlockSize));
+
+        if (QString::fromUtf8(hash.result().toHex()) != expectedHash) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+BackgroundUpdater::BackgroundUpdater(LauncherCore &launcher, QObject *parent)
+    : QObject(parent)
+    , m_launcher(launcher)
+    , m_limiter(new BandwidthLimiter(this))
+{
+    connect(&m_timer, &QTimer::timeout, this, &BackgroundUpdater::update);
+
+    m_initialTimer.setSingleShot(true);
+    m_initialTimer.setInterval(initialDelay);
+    connect(&m_initialTimer, &QTimer::timeout, this, &BackgroundUpdater::update);
+
+    connect(m_launcher.settings(), &LauncherSettings::enableBackgroundUpdatesChanged, this, &BackgroundUpdater::updateSchedule);
+    connect(m_launcher.settings(), &LauncherSettings::backgroundUpdateIntervalChanged, this, &BackgroundUpdater::updateSchedule);
+    connect(m_launcher.settings(), &LauncherSettings::backgroundUpdateSpeedLimitChanged, this, &BackgroundUpdater::updateSpeedLimit);
+
+    updateSpeedLimit();
+    updateSchedule();
+}
+
+QCoro::Task<> BackgroundUpdater::update()
+{
+    if (m_running || !canUpdate()) {
+        co_return;
+    }
+
+    m_running = true;
+    qInfo(ASTRA_LOG) << "Checking for updates in the background...";
+
+    for (const auto profile : profilesToUpdate()) {
+        if (m_pauseCount > 0) {
+            // Whatever is left is going to be updated by the login anyway
+            break;
+        }
+
+        if (profile->account() != nullptr && !profile->account()->isSapphire()) {
+            co_await prefetchBootPatches(*profile);
+        }
+
+        AssetUpdater assetUpdater(*profile, m_launcher);
+        assetUpdater.setBackground(m_limiter);
+        co_await assetUpdater.update();
+    }
+
+    qInfo(ASTRA_LOG) << "Finished checking for updates in the background";
+
+    m_running = false;
+    Q_EMIT finished();
+}
+
+QCoro::Task<> BackgroundUpdater::pause()
+{
+    m_pauseCount++;
+    updateSpeedLimit();
+
+    if (m_running) {
+        Q_EMIT m_launcher.stageChanged(i18n("Finishing background update..."));
+        Q_EMIT m_launcher.stageIndeterminate();
+
+        co_await qCoro(this, &BackgroundUpdater::finished);
+    }
+}
+
+void BackgroundUpdater::resume()
+{
+    Q_ASSERT(m_pauseCount > 0);
+
+    m_pauseCount--;
+    updateSpeedLimit();
+}
+
+bool BackgroundUpdater::isRunning() const
+{
+    return m_running;
+}
+
+void BackgroundUpdater::updateSchedule()
+{
+    if (!m_launcher.settings()->enableBackgroundUpdates()) {
+        m_timer.stop();
+        m_initialTimer.stop();
+        return;
+    }
+
+    const int interval = qMax(m_launcher.settings()->backgroundUpdateInterval(), minimumInterval);
+    m_timer.start(std::chrono::minutes(interval));
+
+    // Restarted instead of queueing another one, so changing the settings a few times only checks once
+    m_initialTimer.start();
+}
+
+void BackgroundUpdater::updateSpeedLimit()
+{
+    // Someone is waiting on us, so there's no reason to hold back anymore
+    if (m_pauseCount > 0) {
+        m_limiter->setLimit(0);
+        return;
+    }
+
+    m_limiter->setLimit(static_cast<qint64>(qMax(m_launcher.settings()->backgroundUpdateSpeedLimit(), 0)) * 1024);
+}
+
+bool BackgroundUpdater::canUpdate() const
+{
+    if (m_pauseCount > 0 || m_launcher.isPatching()) {
+        return false;
+    }
+
+    // Don't compete with the game for bandwidth, or replace files it's using
+    const auto profiles = m_launcher.profileManager()->profiles();
+    return std::ranges::none_of(profiles, [](const Profile *profile) {
+        return profile->loggedIn();
+    });
+}
+
+QList<Profile *> BackgroundUpdater::profilesToUpdate() const
+{
+    QList<Profile *> profiles;
+    for (const auto profile : {m_launcher.currentProfile(), m_launcher.autoLoginProfile()}) {
+        if (profile == nullptr || profiles.contains(profile) || profile->isBenchmark() || !profile->isGameInstalled()) {
+            continue;
+        }
+
+        profiles.push_back(profile);
+    }
+
+    return profiles;
+}
+
+QCoro::Task<> BackgroundUpdater::prefetchBootPatches(Profile &profile)
+{
+    const auto request = SquareEnixLogin::bootPatchListRequest(m_launcher, profile);
+    Utility::printRequest(QStringLiteral("GET"), request);
+
+    const auto reply = m_launcher.mgr()->get(request);
+    co_await reply;
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        qWarning(ASTRA_LOG) << "Failed to check for boot updates in the background:" << reply->errorString();
+        co_return;
+    }
+
+    const std::string patchListStd = reply->readAll().toStdString();
+    if (patchListStd.empty()) {
+        co_return;
+    }
+
+    // The server only gives out one boot patch at a time, and the game patches aren't given out until you're logged in.
+    // So this is all we can get ahead of time, but it's still better than nothing on patch day.
+    const auto patchList = physis_parse_patchlist(PatchListType::Boot, patchListStd.c_str());
+    for (int i = 0; i < patchList.num_entries; i++) {
+        const auto &patch = patchList.entries[i];
+
+        const QString path = Patcher::patchPath(QLatin1String(patch.url), QLatin1String(patch.version));
+        if (QFile::exists(path)) {
+            continue;
+        }
+
+        Utility::createPathIfNeeded(QFileInfo(path).absolutePath());
+
+        if (QStorageInfo(QFileInfo(path).absolutePath()).bytesAvailable() < static_cast<qint64>(patch.length)) {
+            qWarning(ASTRA_LOG) << "Not enough space to download" << patch.version << "in the background";
+            co_return;
+        }
+
+        qInfo(ASTRA_LOG) << "Downloading boot patch" << patch.version << "in the background";
+
+        FileDownloader downloader(m_launcher.mgr(), QUrl(QLatin1String(patch.url)), path);
+        downloader.setBandwidthLimiter(m_limiter);
+        if (!co_await downloader.download()) {
+            qWarning(ASTRA_LOG) << "Failed to download" << patch.version << "in the background:" << downloader.errorString();
+            co_return;
+        }
+
+        QStringList hashes;
+        for (uint64_t j = 0; j < patch.hash_count; j++) {
+            hashes.push_back(QLatin1String(patch.hashes[j]));
+        }
+
+        const auto length = static_cast<qint64>(patch.length);
+        const auto hashBlockSize = static_cast<qint64>(patch.hash_block_size);
+
+        // Check it now, so logging in doesn't have to find out the patch is broken
+        const bool valid = co_await QtConcurrent::run([path, length, hashes, hashBlockSize] {
+            Utility::setLowIoPriority(true);
+            const bool valid = isPatchValid(path, length, hashes, hashBlockSize);
+            Utility::setLowIoPriority(false);
+            return valid;
+        });
+
+        if (!valid) {
+            qWarning(ASTRA_LOG) << "Discarding" << patch.version << "since it failed the integrity check";
+            QFile::remove(path);
+        }
+    }
+}
+
+#include "moc_backgroundupdater.cpp"
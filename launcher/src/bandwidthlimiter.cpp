@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "bandwidthlimiter.h"
+
+#include <qcorotimer.h>
+
+// Waiting is done in small steps, so a changed limit is noticed quickly
+constexpr auto maximumWait = std::chrono::milliseconds(250);
+
+constexpr qint64 nanosecondsPerSecond = 1000 * 1000 * 1000;
+
+BandwidthLimiter::BandwidthLimiter(QObject *parent)
+    : QObject(parent)
+{
+    m_lastRefill.start();
+}
+
+void BandwidthLimiter::setLimit(const qint64 bytesPerSecond)
+{
+    refill();
+    m_limit = qMax<qint64>(bytesPerSecond, 0);
+    m_available = qMin(m_available, m_limit);
+}
+
+qint64 BandwidthLimiter::limit() const
+{
+    return m_limit;
+}
+
+QCoro::Task<> BandwidthLimiter::acquire(const qint64 bytes)
+{
+    refill();
+    m_available -= bytes;
+
+    while (m_limit > 0 && m_available < 0) {
+        const auto wait = std::chrono::milliseconds(-m_available * 1000 / m_limit + 1);
+        co_await QCoro::sleepFor(qMin(wait, maximumWait));
+        refill();
+    }
+}
+
+void BandwidthLimiter::refill()
+{
+    if (m_limit == 0) {
+        m_available = 0;
+        m_lastRefill.restart();
+        return;
+    }
+
+    // Only allow a second's worth of bursting, otherwise an idle limiter lets everything through at once
+    const qint64 elapsed = qMin(m_lastRefill.nsecsElapsed(), nanosecondsPerSecond);
+    m_lastRefill.restart();
+    m_available = qMin(m_available + elapsed * m_limit / nanosecondsPerSecond, m_limit);
+}
+
+#include "moc_bandwidthlimiter.cpp"
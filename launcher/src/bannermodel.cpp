@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "bannermodel.h"
+
+BannerModel::BannerModel(QObject *parent)
+    : KeyedListModel(parent)
+{
+}
+
+QVariant BannerModel::data(const QModelIndex &index, const int role) const
+{
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    const auto &banner = m_items[index.row()];
+
+    switch (role) {
+    case LinkRole:
+        return banner.link;
+    case BannerImageRole:
+        return banner.bannerImage;
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> BannerModel::roleNames() const
+{
+    return {
+        {LinkRole, "link"},
+        {BannerImageRole, "bannerImage"},
+    };
+}
+
+Banner BannerModel::banner(const int index) const
+{
+    if (index < 0 || index >= m_items.size()) {
+        return {};
+    }
+
+    return m_items[index];
+}
+
+void BannerModel::setBanners(const QList<Banner> &banners)
+{
+    if (replaceItems(banners, &Banner::bannerImage)) {
+        Q_EMIT countChanged();
+    }
+}
+
+#include "moc_bannermodel.cpp"
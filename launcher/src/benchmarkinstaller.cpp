@@ -3,11 +3,14 @@
 
 #include "benchmarkinstaller.h"
 
-#include <KArchiveDirectory>
+#include <KFormat>
 #include <KLocalizedString>
-#include <KZip>
+#include <QtConcurrentRun>
+#include <qcorofuture.h>
 
+#include "archiveextractor.h"
 #include "astra_log.h"
+#include "filedownloader.h"
 #include "launchercore.h"
 #include "profile.h"
 #include "utility.h"
@@ -31,51 +34,55 @@ BenchmarkInstaller::BenchmarkInstaller(LauncherCore &launcher, Profile &profile,
 void BenchmarkInstaller::start()
 {
     if (m_localInstallerPath.isEmpty()) {
-        const auto request = QNetworkRequest(QUrl(installerUrl));
-        Utility::printRequest(QStringLiteral("GET"), request);
-
-        // TODO: benchmarks are usually quite large, and need download progress reporting
-        auto reply = m_launcher.mgr()->get(request);
-
-        QObject::connect(reply, &QNetworkReply::finished, [this, reply] {
-            if (reply->error() != QNetworkReply::NetworkError::NoError) {
-                Q_EMIT error(reply->errorString());
-                return;
-            }
-
-            const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-
-            const QByteArray data = reply->readAll();
-
-            QFile file(dataDir.absoluteFilePath(QStringLiteral("ffxiv-bench.zip")));
-            file.open(QIODevice::WriteOnly);
-            file.write(data);
-            file.close();
-
-            m_localInstallerPath = file.fileName();
-            installGame();
-        });
+        downloadInstaller();
     } else {
         installGame();
     }
 }
 
-void BenchmarkInstaller::installGame()
+QCoro::Task<> BenchmarkInstaller::downloadInstaller()
 {
-    const QDir installDirectory = m_profile.gamePath();
-
-    KZip archive(m_localInstallerPath);
-    if (!archive.open(QIODevice::ReadOnly)) {
-        qCritical(ASTRA_LOG) << "Failed to extract benchmark files:" << archive.errorString();
-        Q_EMIT error(i18n("Failed to extract benchmark files:\n\n%1", archive.errorString()));
-        return;
+    const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    const QString filePath = dataDir.absoluteFilePath(QStringLiteral("ffxiv-bench.zip"));
+
+    Q_EMIT stageChanged(i18n("Downloading benchmark…"));
+
+    // Benchmarks are usually quite large, so show how far along the download is
+    FileDownloader downloader(m_launcher.mgr(), QUrl(installerUrl), filePath);
+    connect(&downloader, &FileDownloader::progress, this, [this](const qint64 received, const qint64 total) {
+        const KFormat format;
+        if (total > 0) {
+            Q_EMIT stageChanged(i18n("Downloading benchmark…"),
+                                i18n("%1 of %2", format.formatByteSize(static_cast<double>(received)), format.formatByteSize(static_cast<double>(total))));
+        } else {
+            Q_EMIT stageChanged(i18n("Downloading benchmark…"), format.formatByteSize(static_cast<double>(received)));
+        }
+        Q_EMIT downloadProgress(received, total);
+    });
+
+    if (!co_await downloader.download()) {
+        Q_EMIT error(downloader.errorString());
+        co_return;
     }
 
-    // the first directory is the same as the version we download
-    const KArchiveDirectory *root = archive.directory();
-    Q_UNUSED(root->copyTo(installDirectory.absolutePath(), true))
+    m_localInstallerPath = filePath;
+    co_await installGame();
+}
 
-    archive.close();
+QCoro::Task<> BenchmarkInstaller::installGame()
+{
+    const QDir installDirectory = m_profile.gamePath();
+
+    Q_EMIT stageChanged(i18n("Installing…"));
+    Q_EMIT stageIndeterminate();
+
+    // The benchmark is several gigabytes, so extract it on other threads
+    ArchiveExtractor extractor(m_localInstallerPath, installDirectory.absolutePath());
+    if (!co_await QtConcurrent::run(&ArchiveExtractor::extract, &extractor)) {
+        qCritical(ASTRA_LOG) << "Failed to extract benchmark files:" << extractor.errorString();
+        Q_EMIT error(i18n("Failed to extract benchmark files:\n\n%1", extractor.errorString()));
+        co_return;
+    }
 
     m_profile.readGameVersion();
 
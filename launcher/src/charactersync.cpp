@@ -4,14 +4,22 @@
 #include "charactersync.h"
 
 #include <KLocalizedString>
-#include <KZip>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+#include <qcorofuture.h>
 #include <qcorosignal.h>
 #include <qcorotask.h>
 
+#include "archiveextractor.h"
 #include "astra_log.h"
+#include "contentchunker.h"
+#include "filehashcache.h"
 #include "syncmanager.h"
 
-const auto gearsetFilename = QStringLiteral("GEARSET.DAT");
+// How many characters are uploaded or downloaded at the same time
+constexpr int maximumConcurrentTransfers = 4;
 
 CharacterSync::CharacterSync(Account &account, LauncherCore &launcher, QObject *parent)
     : QObject(parent)
@@ -26,10 +34,19 @@ QCoro::Task<bool> CharacterSync::sync(const bool initialSync)
         co_return true;
     }
 
+    // Uploads after the game exits happen in the background and are retried later, so they shouldn't interrupt anything
+    const auto reportError = [this, initialSync](const QString &message) {
+        if (initialSync) {
+            Q_EMIT launcher.loginError(message);
+        } else {
+            qCWarning(ASTRA_LOG) << message;
+        }
+    };
+
     const auto syncManager = launcher.syncManager();
     if (!syncManager->connected()) {
         // TODO: provide an option to continue in the UI
-        Q_EMIT launcher.loginError(i18n("Failed to connect to sync server! Please check your sync settings."));
+        reportError(i18n("Failed to connect to sync server! Please check your sync settings."));
         co_return false;
     }
 
@@ -37,15 +54,19 @@ QCoro::Task<bool> CharacterSync::sync(const bool initialSync)
     co_await syncManager->sync();
 
     if (!syncManager->isReady()) {
-        Q_EMIT launcher.stageChanged(i18n("Waiting for sync connection..."));
+        if (initialSync) {
+            Q_EMIT launcher.stageChanged(i18n("Waiting for sync connection..."));
+        }
 
         // NOTE: probably does not handle errors well?
         co_await qCoro(syncManager, &SyncManager::isReadyChanged);
     }
 
-    Q_EMIT launcher.stageChanged(i18n("Synchronizing character data..."));
+    if (initialSync) {
+        Q_EMIT launcher.stageChanged(i18n("Synchronizing character data..."));
+    }
 
-    // On game boot, check if we need the lock. Otherwise break it when we clean up.
+    // On game boot, check if we need the lock. Otherwise break it once everything is uploaded.
     if (initialSync) {
         if (const auto hostname = co_await syncManager->checkLock(); hostname.has_value()) {
             // Don't warn about our own failures
@@ -56,8 +77,6 @@ QCoro::Task<bool> CharacterSync::sync(const bool initialSync)
         }
 
         syncManager->setLock();
-    } else {
-        syncManager->breakLock();
     }
 
     // so first, we need to list the character folders
@@ -82,115 +101,310 @@ QCoro::Task<bool> CharacterSync::sync(const bool initialSync)
     // Reset initial sync setting
     syncManager->setInitialSync(false);
 
+    QList<Character> characters;
     for (const auto &dir : characterDirs) {
         const QString id = dir.fileName(); // FFXIV_CHR0040000001000001 for example
         const auto previousData = co_await syncManager->getUploadedCharacterData(id);
+        characters.push_back(Character{.path = dir.absoluteFilePath(), .id = id, .previousData = previousData});
+    }
+
+    // Every character is hashed at once, and files that haven't changed since the last sync aren't read again
+    FileHashCache hashCache(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).absoluteFilePath(QStringLiteral("character-hashes.json")));
+    co_await QtConcurrent::map(characters, [&hashCache](Character &character) {
+        const QDir dir(character.path);
+
+        QStringList files = dir.entryList(QDir::Files | QDir::NoDotAndDotDot);
+        if (character.previousData) {
+            files += character.previousData->fileHashes.keys();
+        }
+
+        for (const QString &file : std::as_const(files)) {
+            character.localHashes[file] = hashCache.hash(dir.absoluteFilePath(file));
+        }
+    });
+    hashCache.save();
 
-        // The files are packed into an archive. So if only one of the files doesn't exist or fails the hash check, download the whole thing and overwrite.
+    qCDebug(ASTRA_LOG) << "Hashed" << hashCache.hashedCount() << "changed character files";
+
+    // Chunks can be shared between characters, so any of them that were uploaded before can be reused
+    QMap<QString, QString> knownChunkUris;
+
+    for (auto &character : characters) {
+        // If only one of the files doesn't exist or fails the hash check, download everything that's different and overwrite.
         bool areFilesDifferent = false;
-        for (const auto &[file, hash] : previousData->fileHashes.asKeyValueRange()) {
-            QFile existingFile(QDir(dir.absoluteFilePath()).absoluteFilePath(file));
-            if (!existingFile.exists()) {
-                areFilesDifferent = true;
-                qCDebug(ASTRA_LOG) << id << "does not match locally, reason:" << existingFile.fileName() << "does not exist";
-                break;
+        bool hasLocalChanges = true;
+        if (character.previousData) {
+            for (const auto &[file, hash] : character.previousData->fileHashes.asKeyValueRange()) {
+                const QString existingHash = character.localHashes.value(file);
+                if (existingHash.isEmpty()) {
+                    areFilesDifferent = true;
+                    qCDebug(ASTRA_LOG) << character.id << "does not match locally, reason:" << file << "does not exist";
+                    break;
+                }
+
+                if (existingHash != hash) {
+                    areFilesDifferent = true;
+                    qCDebug(ASTRA_LOG) << character.id << "does not match locally, reason: hashes do not match for" << file;
+                    break;
+                }
             }
 
-            existingFile.open(QIODevice::ReadOnly);
-            const auto existingHash = QString::fromUtf8(QCryptographicHash::hash(existingFile.readAll(), QCryptographicHash::Algorithm::Sha256).toHex());
-            if (existingHash != hash) {
-                areFilesDifferent = true;
-                qCDebug(ASTRA_LOG) << id << "does not match locally, reason: hashes do not match for" << file;
-                break;
+            // Files that were added locally don't need a download, but do need an upload. So does anything stored in the old archive format.
+            hasLocalChanges = areFilesDifferent || !character.previousData->isChunked();
+            for (const auto &[file, hash] : character.localHashes.asKeyValueRange()) {
+                if (!hash.isEmpty() && !character.previousData->fileHashes.contains(file)) {
+                    hasLocalChanges = true;
+                }
             }
+
+            knownChunkUris.insert(character.previousData->chunkUris);
         }
 
-        const bool hasPreviousUpload = !previousData.has_value();
+        const bool hasNoPreviousUpload = !character.previousData.has_value();
         const bool isGameClosing = !initialSync;
 
         // We want to upload if the files are truly different, or there is no existing data on the server.
-        const bool needsUpload = (areFilesDifferent && isGameClosing) || hasPreviousUpload || manualOverwrite;
+        const bool needsUpload = (hasLocalChanges && isGameClosing) || hasNoPreviousUpload || manualOverwrite;
 
         // We want to download if the files are different.
         const bool needsDownload = areFilesDifferent;
 
         if (needsUpload) {
-            qCDebug(ASTRA_LOG) << id << "uploading character data";
-            // if we didn't upload character data yet, upload it now
-            co_await uploadCharacterData(dir.absoluteFilePath(), id);
+            character.transfer = Transfer::Upload;
         } else if (needsDownload) {
-            qCDebug(ASTRA_LOG) << id << "downloading character data";
-            if (!co_await downloadCharacterData(dir.absoluteFilePath(), id, previousData->mxcUri)) {
-                Q_EMIT launcher.loginError(i18n("Failed to sync character data from the server. You can try overwriting existing data under Settings."));
-                co_return false;
-            }
+            character.transfer = Transfer::Download;
         }
     }
 
+    // The transfers are mostly waiting on the server, so a few of them are run at the same time
+    qsizetype next = 0;
+    std::vector<QCoro::Task<bool>> transfers;
+    for (int i = 0; i < maximumConcurrentTransfers; i++) {
+        transfers.push_back(runTransfers(characters, next, knownChunkUris));
+    }
+
+    bool succeeded = true;
+    for (auto &transfer : transfers) {
+        succeeded &= co_await std::move(transfer);
+    }
+
+    if (!succeeded) {
+        reportError(i18n("Failed to sync character data from the server. You can try overwriting existing data under Settings."));
+        co_return false;
+    }
+
+    // Other devices can only continue once our data is actually on the server
+    if (!initialSync) {
+        co_await syncManager->breakLock();
+    }
+
     co_return true;
 }
 
-QCoro::Task<void> CharacterSync::uploadCharacterData(const QDir &dir, const QString &id)
+QCoro::Task<bool> CharacterSync::runTransfers(const QList<Character> &characters, qsizetype &next, const QMap<QString, QString> &knownChunkUris)
 {
-    qCDebug(ASTRA_LOG) << "Uploading" << dir << id;
-    const QTemporaryDir tempDir;
-
-    const auto tempZipPath = tempDir.filePath(QStringLiteral("%1.zip").arg(id));
+    bool succeeded = true;
+    while (next < characters.size()) {
+        const Character &character = characters[next++];
 
-    const auto zip = new KZip(tempZipPath);
-    zip->setCompression(KZip::DeflateCompression);
-    zip->open(QIODevice::WriteOnly);
+        switch (character.transfer) {
+        case Transfer::Upload:
+            qCDebug(ASTRA_LOG) << character.id << "uploading character data";
+            // if we didn't upload character data yet, upload it now
+            if (!co_await uploadCharacterData(character, knownChunkUris)) {
+                succeeded = false;
+            }
+            break;
+        case Transfer::Download:
+            qCDebug(ASTRA_LOG) << character.id << "downloading character data";
+            if (!co_await downloadCharacterData(character)) {
+                succeeded = false;
+            }
+            break;
+        case Transfer::None:
+            break;
+        }
+    }
 
-    QFile gearsetFile(dir.filePath(gearsetFilename));
-    gearsetFile.open(QFile::ReadOnly);
+    co_return succeeded;
+}
 
-    const auto data = gearsetFile.readAll();
+QCoro::Task<bool> CharacterSync::uploadCharacterData(const Character &character, const QMap<QString, QString> &knownChunkUris)
+{
+    qCDebug(ASTRA_LOG) << "Uploading" << character.path << character.id;
 
-    zip->writeFile(gearsetFilename, data);
-    zip->close();
-    delete zip;
+    const auto &previousData = character.previousData;
 
     QMap<QString, QString> fileHashes;
-    fileHashes[gearsetFilename] = QString::fromUtf8(QCryptographicHash::hash(data, QCryptographicHash::Algorithm::Sha256).toHex());
+    QMap<QString, QStringList> fileChunks;
+    QMap<QString, QString> chunkUris;
+
+    // Files that are the same as last time keep their chunks, without reading them again
+    QStringList changedFiles;
+    for (const auto &[file, hash] : character.localHashes.asKeyValueRange()) {
+        if (hash.isEmpty()) {
+            continue;
+        }
 
-    co_await launcher.syncManager()->uploadCharacterArchive(id, tempZipPath, fileHashes);
-    // TODO: error handling
+        const bool isUnchanged = previousData && previousData->isChunked() && previousData->fileHashes.value(file) == hash && previousData->fileChunks.contains(file)
+            && std::ranges::all_of(previousData->fileChunks[file], [&previousData](const QString &chunk) {
+                                     return previousData->chunkUris.contains(chunk);
+                                 });
+        if (isUnchanged) {
+            fileHashes[file] = hash;
+            fileChunks[file] = previousData->fileChunks[file];
+            for (const QString &chunk : previousData->fileChunks[file]) {
+                chunkUris[chunk] = previousData->chunkUris[chunk];
+            }
+        } else {
+            changedFiles.push_back(file);
+        }
+    }
+
+    struct ChunkedFile {
+        QString name;
+        QByteArray data;
+        QList<ContentChunker::Chunk> chunks;
+    };
+
+    const QList<ChunkedFile> chunkedFiles = co_await QtConcurrent::run([dir = QDir(character.path), changedFiles] {
+        QList<ChunkedFile> files;
+        for (const QString &file : changedFiles) {
+            QFile existingFile(dir.absoluteFilePath(file));
+            if (!existingFile.open(QIODevice::ReadOnly)) {
+                continue;
+            }
 
-    co_return;
+            ChunkedFile chunkedFile{.name = file, .data = existingFile.readAll()};
+            chunkedFile.chunks = ContentChunker::split(chunkedFile.data);
+            files.push_back(chunkedFile);
+        }
+        return files;
+    });
+
+    const auto syncManager = launcher.syncManager();
+    qsizetype uploadedSize = 0;
+
+    for (const auto &file : chunkedFiles) {
+        // Hashed again, since the file may have changed after it was first hashed
+        fileHashes[file.name] = ContentChunker::hash(file.data);
+
+        QStringList chunks;
+        for (const auto &chunk : file.chunks) {
+            chunks.push_back(chunk.hash);
+            if (chunkUris.contains(chunk.hash)) {
+                continue;
+            }
+
+            if (const QString knownUri = knownChunkUris.value(chunk.hash); !knownUri.isEmpty()) {
+                chunkUris[chunk.hash] = knownUri;
+                continue;
+            }
+
+            const auto uri = co_await syncManager->uploadChunk(file.data.sliced(chunk.offset, chunk.size));
+            if (!uri) {
+                co_return false;
+            }
+
+            chunkUris[chunk.hash] = *uri;
+            uploadedSize += chunk.size;
+        }
+        fileChunks[file.name] = chunks;
+    }
+
+    qCDebug(ASTRA_LOG) << "Uploaded" << uploadedSize << "bytes of character data for" << character.id;
+
+    co_return co_await syncManager->setCharacterManifest(character.id, fileHashes, fileChunks, chunkUris);
 }
 
-QCoro::Task<bool> CharacterSync::downloadCharacterData(const QDir &dir, const QString &id, const QString &contentUri)
+QCoro::Task<bool> CharacterSync::downloadCharacterData(const Character &character)
 {
-    const QTemporaryDir tempDir;
+    const auto &previousData = *character.previousData;
+    if (!previousData.isChunked()) {
+        co_return co_await downloadCharacterArchive(character);
+    }
 
-    const auto tempZipPath = tempDir.filePath(QStringLiteral("%1.zip").arg(id));
+    const QDir dir(character.path);
+
+    QStringList changedFiles;
+    for (const auto &[file, hash] : previousData.fileHashes.asKeyValueRange()) {
+        if (character.localHashes.value(file) != hash) {
+            changedFiles.push_back(file);
+        }
+    }
 
-    co_await launcher.syncManager()->downloadCharacterArchive(contentUri, tempZipPath);
+    // Most of an edited file is usually still the same, so anything already on disk doesn't have to be downloaded
+    auto chunks = co_await QtConcurrent::run([dir, changedFiles] {
+        QHash<QString, QByteArray> localChunks;
+        for (const QString &file : changedFiles) {
+            QFile existingFile(dir.absoluteFilePath(file));
+            if (!existingFile.open(QIODevice::ReadOnly)) {
+                continue;
+            }
 
-    auto zip = new KZip(tempZipPath);
-    zip->setCompression(KZip::DeflateCompression);
-    zip->open(QIODevice::ReadOnly);
-    if (zip->isOpen()) {
-        qCDebug(ASTRA_LOG) << "contents:" << zip->directory()->entries();
+            const QByteArray data = existingFile.readAll();
+            for (const auto &chunk : ContentChunker::split(data)) {
+                localChunks[chunk.hash] = data.sliced(chunk.offset, chunk.size);
+            }
+        }
+        return localChunks;
+    });
 
-        if (auto file = zip->directory()->file(gearsetFilename); file != nullptr) {
-            Q_UNUSED(file->copyTo(dir.absolutePath()))
+    const auto syncManager = launcher.syncManager();
+    qsizetype downloadedSize = 0;
+
+    for (const QString &file : std::as_const(changedFiles)) {
+        QByteArray data;
+        for (const QString &chunk : previousData.fileChunks.value(file)) {
+            if (!chunks.contains(chunk)) {
+                const auto chunkData = co_await syncManager->downloadChunk(previousData.chunkUris.value(chunk));
+                if (!chunkData || ContentChunker::hash(*chunkData) != chunk) {
+                    qCWarning(ASTRA_LOG) << "Failed to download chunk" << chunk << "of" << file << "for" << character.id;
+                    co_return false;
+                }
+
+                chunks[chunk] = *chunkData;
+                downloadedSize += chunkData->size();
+            }
 
-            qCDebug(ASTRA_LOG) << "Extracted character data!";
+            data += chunks[chunk];
+        }
 
-            zip->close();
-            delete zip;
+        if (ContentChunker::hash(data) != previousData.fileHashes[file]) {
+            qCWarning(ASTRA_LOG) << "Downloaded" << file << "for" << character.id << "is corrupted";
+            co_return false;
+        }
 
-            co_return true;
+        QSaveFile outputFile(dir.absoluteFilePath(file));
+        if (!outputFile.open(QIODevice::WriteOnly) || outputFile.write(data) != data.size() || !outputFile.commit()) {
+            qCWarning(ASTRA_LOG) << "Failed to write" << outputFile.fileName() << outputFile.errorString();
+            co_return false;
         }
     }
 
-    zip->close();
-    delete zip;
+    qCDebug(ASTRA_LOG) << "Downloaded" << downloadedSize << "bytes of character data for" << character.id;
+
+    co_return true;
+}
+
+QCoro::Task<bool> CharacterSync::downloadCharacterArchive(const Character &character)
+{
+    const QTemporaryDir tempDir;
+
+    const auto tempZipPath = tempDir.filePath(QStringLiteral("%1.zip").arg(character.id));
 
-    qCDebug(ASTRA_LOG) << "Failed to read character ZIP!";
+    co_await launcher.syncManager()->downloadCharacterArchive(character.previousData->mxcUri, tempZipPath);
 
-    co_return false;
+    ArchiveExtractor extractor(tempZipPath, character.path);
+    extractor.setEntries(character.previousData->fileHashes.keys());
+    if (!co_await QtConcurrent::run(&ArchiveExtractor::extract, &extractor)) {
+        qCDebug(ASTRA_LOG) << "Failed to read character ZIP:" << extractor.errorString();
+        co_return false;
+    }
+
+    qCDebug(ASTRA_LOG) << "Extracted character data!";
+
+    co_return true;
 }
 
 #include "moc_charactersync.cpp"
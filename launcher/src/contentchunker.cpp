@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "contentchunker.h"
+
+#include <QCryptographicHash>
+#include <array>
+#include <bit>
+
+namespace
+{
+// Random values for each byte, generated the same way every time so the boundaries never change
+constexpr std::array<quint64, 256> gearTable = [] {
+    std::array<quint64, 256> table{};
+    quint64 state = 0x4153545241434443; // "ASTRACDC"
+    for (auto &value : table) {
+        // splitmix64
+        state += 0x9E3779B97F4A7C15;
+        quint64 z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        value = z ^ (z >> 31);
+    }
+    return table;
+}();
+
+// The top bits of the gear hash depend on the last 64 bytes, so those are the ones checked.
+// Before the average size a boundary is harder to find, and after it easier, which keeps most chunks close to the average.
+constexpr int averageBits = std::countr_zero(static_cast<quint64>(ContentChunker::averageChunkSize));
+constexpr quint64 smallMask = ~quint64(0) << (64 - (averageBits + 2));
+constexpr quint64 largeMask = ~quint64(0) << (64 - (averageBits - 2));
+
+/// \return The size of the chunk at the start of @p data.
+qsizetype nextBoundary(const QByteArrayView data)
+{
+    const qsizetype size = qMin(data.size(), ContentChunker::maximumChunkSize);
+    if (size <= ContentChunker::minimumChunkSize) {
+        return size;
+    }
+
+    const auto bytes = reinterpret_cast<const uchar *>(data.data());
+    const qsizetype normalSize = qMin(size, ContentChunker::averageChunkSize);
+
+    quint64 hash = 0;
+    qsizetype i = ContentChunker::minimumChunkSize;
+    for (; i < normalSize; i++) {
+        hash = (hash << 1) + gearTable[bytes[i]];
+        if ((hash & smallMask) == 0) {
+            return i + 1;
+        }
+    }
+
+    for (; i < size; i++) {
+        hash = (hash << 1) + gearTable[bytes[i]];
+        if ((hash & largeMask) == 0) {
+            return i + 1;
+        }
+    }
+
+    return size;
+}
+}
+
+QList<ContentChunker::Chunk> ContentChunker::split(const QByteArrayView data)
+{
+    QList<Chunk> chunks;
+
+    qsizetype offset = 0;
+    while (offset < data.size()) {
+        const qsizetype size = nextBoundary(data.sliced(offset));
+        chunks.push_back(Chunk{.offset = offset, .size = size, .hash = hash(data.sliced(offset, size))});
+        offset += size;
+    }
+
+    return chunks;
+}
+
+QString ContentChunker::hash(const QByteArrayView data)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
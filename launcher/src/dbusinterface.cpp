@@ -0,0 +1,289 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dbusinterface.h"
+#include "astra_log.h"
+#include "launchercore.h"
+
+#include <QCommandLineParser>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusError>
+#include <QDBusMessage>
+
+const auto serviceName = QStringLiteral("zone.xiv.astra");
+const auto objectPath = QStringLiteral("/Launcher");
+const auto interfaceName = QStringLiteral("zone.xiv.astra.Launcher");
+
+// How often the transfer rate is sampled, so it doesn't jump around with every packet
+constexpr qint64 rateSampleInterval = 1000;
+
+// How much each sample counts towards the transfer rate, the rest comes from the previous ones
+constexpr double rateSmoothing = 0.3;
+
+// The primary instance only has to start things, so it should never take long to answer
+constexpr int forwardTimeout = 5000;
+
+DBusInterface::DBusInterface(LauncherCore &launcher, QObject *parent)
+    : QObject(parent)
+    , m_launcher(launcher)
+{
+    connect(&m_launcher, &LauncherCore::stageChanged, this, [this](const QString &stage, const QString &explanation) {
+        m_stage = stage;
+        m_explanation = explanation;
+        Q_EMIT stageChanged(stage, explanation);
+    });
+    connect(&m_launcher, &LauncherCore::downloadProgress, this, &DBusInterface::updateTransferRate);
+    connect(&m_launcher, &LauncherCore::loginFailed, this, [this] {
+        if (m_state == State::LoggingIn) {
+            setState(State::Idle);
+        }
+    });
+    connect(&m_launcher, &LauncherCore::successfulLaunch, this, [this] {
+        setState(State::Playing);
+    });
+    connect(&m_launcher, &LauncherCore::gameClosed, this, [this](const Profile *profile) {
+        setState(State::Idle);
+        Q_EMIT gameExited(profile->uuid());
+    });
+}
+
+bool DBusInterface::registerOnSessionBus()
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected()) {
+        qWarning(ASTRA_LOG) << "Not exposing the D-Bus interface, the session bus isn't available";
+        return false;
+    }
+
+    if (!bus.registerService(serviceName)) {
+        qWarning(ASTRA_LOG) << "Failed to register" << serviceName << "on the session bus:" << bus.lastError().message();
+        return false;
+    }
+
+    if (!bus.registerObject(objectPath, this, QDBusConnection::ExportScriptableSlots | QDBusConnection::ExportScriptableSignals)) {
+        qWarning(ASTRA_LOG) << "Failed to export the D-Bus interface:" << bus.lastError().message();
+        bus.unregisterService(serviceName);
+        return false;
+    }
+
+    return true;
+}
+
+std::optional<bool> DBusInterface::forwardArguments(const QStringList &arguments)
+{
+    const QDBusConnection bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected() || !bus.interface()->isServiceRegistered(serviceName)) {
+        return std::nullopt;
+    }
+
+    QDBusMessage message = QDBusMessage::createMethodCall(serviceName, objectPath, interfaceName, QStringLiteral("handleArguments"));
+    message << arguments;
+
+    const QDBusMessage reply = bus.call(message, QDBus::Block, forwardTimeout);
+    if (reply.type() != QDBusMessage::ReplyMessage) {
+        qWarning(ASTRA_LOG) << "Failed to forward the command line to the running instance:" << reply.errorMessage();
+        return std::nullopt;
+    }
+
+    return reply.arguments().value(0).toBool();
+}
+
+QVariantMap DBusInterface::profiles() const
+{
+    QVariantMap profiles;
+    for (const auto profile : m_launcher.profileManager()->profiles()) {
+        profiles.insert(profile->uuid(), profile->name());
+    }
+    return profiles;
+}
+
+bool DBusInterface::update(const QString &profile)
+{
+    const auto foundProfile = m_launcher.profileManager()->getProfileByNameOrUUID(profile);
+    if (foundProfile == nullptr || m_state != State::Idle || m_launcher.isPatching()) {
+        return false;
+    }
+
+    runUpdate(foundProfile);
+
+    return true;
+}
+
+bool DBusInterface::login(const QString &profile)
+{
+    const auto foundProfile = m_launcher.profileManager()->getProfileByNameOrUUID(profile);
+    if (foundProfile == nullptr || m_state != State::Idle || m_launcher.isPatching()) {
+        return false;
+    }
+
+    return startLogin(foundProfile);
+}
+
+QVariantMap DBusInterface::progress() const
+{
+    QString state;
+    switch (m_state) {
+    case State::Idle:
+        state = QStringLiteral("idle");
+        break;
+    case State::Updating:
+        state = QStringLiteral("updating");
+        break;
+    case State::LoggingIn:
+        state = QStringLiteral("loggingIn");
+        break;
+    case State::Playing:
+        state = QStringLiteral("playing");
+        break;
+    }
+
+    // -1 when there's nothing to go off of yet
+    qint64 secondsRemaining = -1;
+    if (m_bytesPerSecond > 0.0 && m_total > m_received) {
+        secondsRemaining = static_cast<qint64>(static_cast<double>(m_total - m_received) / m_bytesPerSecond);
+    }
+
+    return {
+        {QStringLiteral("state"), state},
+        {QStringLiteral("stage"), m_stage},
+        {QStringLiteral("explanation"), m_explanation},
+        {QStringLiteral("bytesReceived"), m_received},
+        {QStringLiteral("bytesTotal"), m_total},
+        {QStringLiteral("bytesPerSecond"), m_bytesPerSecond},
+        {QStringLiteral("secondsRemaining"), secondsRemaining},
+    };
+}
+
+bool DBusInterface::handleArguments(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    const QCommandLineOption updateOption(QStringLiteral("update"), QString(), QStringLiteral("profile"));
+    const QCommandLineOption allOption(QStringLiteral("all"));
+    const QCommandLineOption verifyOption(QStringLiteral("verify"));
+    const QCommandLineOption launchOption(QStringLiteral("launch"), QString(), QStringLiteral("profile"));
+    parser.addOptions({updateOption, allOption, verifyOption, launchOption});
+
+    // Anything else (like --steam) is meant for the instance that's already running, so errors are expected here
+    parser.parse(arguments);
+
+    // The results can't be sent back, and checking the installation while this instance could be patching it wouldn't be reliable anyway
+    if (parser.isSet(verifyOption)) {
+        qWarning(ASTRA_LOG) << "Refusing to verify for another instance, since this one owns the installation:" << arguments;
+        return false;
+    }
+
+    if (!parser.isSet(updateOption) && !parser.isSet(allOption) && !parser.isSet(launchOption)) {
+        Q_EMIT m_launcher.showWindow();
+        return true;
+    }
+
+    if (m_state != State::Idle || m_launcher.isPatching()) {
+        qWarning(ASTRA_LOG) << "Refusing the command line from another instance, since the launcher is busy:" << arguments;
+        return false;
+    }
+
+    QList<Profile *> profiles;
+    if (parser.isSet(allOption)) {
+        profiles = m_launcher.profileManager()->profiles();
+    } else {
+        for (const auto &name : parser.values(updateOption)) {
+            const auto profile = m_launcher.profileManager()->getProfileByNameOrUUID(name);
+            if (profile == nullptr) {
+                qWarning(ASTRA_LOG) << "Another instance asked to update" << name << "but there's no such profile";
+                return false;
+            }
+            profiles.push_back(profile);
+        }
+    }
+
+    Profile *launchProfile = nullptr;
+    if (parser.isSet(launchOption)) {
+        launchProfile = m_launcher.profileManager()->getProfileByNameOrUUID(parser.value(launchOption));
+        if (launchProfile == nullptr) {
+            qWarning(ASTRA_LOG) << "Another instance asked to launch" << parser.value(launchOption) << "but there's no such profile";
+            return false;
+        }
+    }
+
+    runUpdates(profiles, launchProfile);
+
+    return true;
+}
+
+QCoro::Task<> DBusInterface::runUpdates(const QList<Profile *> profiles, Profile *launchProfile)
+{
+    for (const auto profile : profiles) {
+        if (!co_await runUpdate(profile)) {
+            // Launching an out of date game wouldn't get far anyway
+            co_return;
+        }
+    }
+
+    if (launchProfile != nullptr) {
+        startLogin(launchProfile);
+    }
+}
+
+QCoro::Task<bool> DBusInterface::runUpdate(Profile *profile)
+{
+    const QString uuid = profile->uuid();
+
+    setState(State::Updating);
+    const bool succeeded = co_await m_launcher.updateProfile(profile);
+    setState(State::Idle);
+
+    Q_EMIT updateFinished(uuid, succeeded);
+
+    co_return succeeded;
+}
+
+bool DBusInterface::startLogin(Profile *profile)
+{
+    setState(State::LoggingIn);
+    if (!m_launcher.autoLogin(profile)) {
+        setState(State::Idle);
+        return false;
+    }
+
+    return true;
+}
+
+void DBusInterface::setState(const State state)
+{
+    m_state = state;
+
+    // Whatever was being transferred before has nothing to do with what's next
+    m_received = 0;
+    m_total = 0;
+    m_bytesPerSecond = 0.0;
+    m_sampleTimer.invalidate();
+}
+
+void DBusInterface::updateTransferRate(const qint64 received, const qint64 total)
+{
+    // Something else started downloading, so the previous rate doesn't mean much anymore
+    if (received < m_received) {
+        m_bytesPerSecond = 0.0;
+        m_sampleTimer.invalidate();
+    }
+
+    m_received = received;
+    m_total = total;
+
+    if (!m_sampleTimer.isValid()) {
+        m_sampleTimer.start();
+        m_sampleReceived = received;
+        return;
+    }
+
+    if (m_sampleTimer.elapsed() < rateSampleInterval) {
+        return;
+    }
+
+    const double rate = static_cast<double>(received - m_sampleReceived) * 1000.0 / static_cast<double>(m_sampleTimer.restart());
+    m_bytesPerSecond = m_bytesPerSecond > 0.0 ? m_bytesPerSecond * (1.0 - rateSmoothing) + rate * rateSmoothing : rate;
+    m_sampleReceived = received;
+}
+
+#include "moc_dbusinterface.cpp"
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dxvkdeployer.h"
+#include "astra_log.h"
+#include "utility.h"
+
+#include <KLocalizedString>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+using namespace Qt::StringLiterals;
+
+/// \return The SHA-256 of the file at @p path, or an empty array if it couldn't be read.
+static QByteArray hashFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return {};
+    }
+
+    return hash.result().toHex();
+}
+
+static qint64 lastModified(const QFileInfo &info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+DxvkDeployer::DxvkDeployer(const QString &dxvkPath, const QString &winePrefixPath)
+    : m_dxvkDir(dxvkPath)
+    , m_winePrefixPath(winePrefixPath)
+{
+}
+
+bool DxvkDeployer::deploy()
+{
+    m_copiedCount = 0;
+    m_errorString.clear();
+
+    const QDir dxvk64Dir = m_dxvkDir.absoluteFilePath(QStringLiteral("x64"));
+    const QDir system32 = QDir(m_winePrefixPath).absoluteFilePath(QStringLiteral("drive_c/windows/system32"));
+
+    QString version;
+    if (const QString versionPath = m_dxvkDir.absoluteFilePath(QStringLiteral("dxvk.ver")); QFile::exists(versionPath)) {
+        version = Utility::readVersion(versionPath);
+    }
+
+    QJsonObject manifest;
+    QFile manifestFile(manifestPath(m_winePrefixPath));
+    if (manifestFile.open(QIODevice::ReadOnly)) {
+        manifest = QJsonDocument::fromJson(manifestFile.readAll()).object();
+        manifestFile.close();
+    }
+
+    // Nothing recorded for a different version can be trusted
+    const QJsonObject deployedFiles = manifest["version"_L1].toString() == version ? manifest["files"_L1].toObject() : QJsonObject{};
+
+    QJsonObject files;
+    for (const QFileInfo &source : dxvk64Dir.entryInfoList(QDir::Files | QDir::NoDotAndDotDot)) {
+        const QString targetPath = system32.absoluteFilePath(source.fileName());
+        const QFileInfo target(targetPath);
+        QJsonObject record = deployedFiles[source.fileName()].toObject();
+
+        // Only hash the source again if it looks like it changed since it was last deployed
+        QByteArray hash;
+        if (!record.isEmpty() && record["size"_L1].toInteger() == source.size() && record["sourceModified"_L1].toInteger() == lastModified(source)) {
+            hash = record["sha256"_L1].toString().toLatin1();
+        } else {
+            hash = hashFile(source.absoluteFilePath());
+        }
+
+        if (!isDeployed(target, record, hash)) {
+            // QFile::copy won't overwrite anything, but it clones the file on filesystems that support it (like Btrfs or XFS)
+            if (target.exists() && !QFile::remove(targetPath)) {
+                m_errorString = i18n("Failed to replace %1.", targetPath);
+                return false;
+            }
+
+            if (!QFile::copy(source.absoluteFilePath(), targetPath)) {
+                m_errorString = i18n("Failed to copy %1 to %2.", source.absoluteFilePath(), targetPath);
+                return false;
+            }
+
+            m_copiedCount++;
+        }
+
+        record["sha256"_L1] = QString::fromLatin1(hash);
+        record["size"_L1] = source.size();
+        record["sourceModified"_L1] = lastModified(source);
+        record["modified"_L1] = lastModified(QFileInfo(targetPath));
+        files[source.fileName()] = record;
+    }
+
+    if (manifest["version"_L1].toString() == version && manifest["files"_L1].toObject() == files) {
+        return true;
+    }
+
+    QJsonObject newManifest;
+    newManifest["version"_L1] = version;
+    newManifest["files"_L1] = files;
+
+    QSaveFile newManifestFile(manifestPath(m_winePrefixPath));
+    if (!newManifestFile.open(QIODevice::WriteOnly)) {
+        // Everything was still deployed, it'll just be checked again next time
+        qWarning(ASTRA_LOG) << "Failed to write DXVK manifest" << newManifestFile.errorString();
+        return true;
+    }
+
+    newManifestFile.write(QJsonDocument(newManifest).toJson());
+    if (!newManifestFile.commit()) {
+        qWarning(ASTRA_LOG) << "Failed to write DXVK manifest" << newManifestFile.errorString();
+    }
+
+    return true;
+}
+
+int DxvkDeployer::copiedCount() const
+{
+    return m_copiedCount;
+}
+
+QString DxvkDeployer::errorString() const
+{
+    return m_errorString;
+}
+
+QString DxvkDeployer::manifestPath(const QString &winePrefixPath)
+{
+    return QDir(winePrefixPath).absoluteFilePath(QStringLiteral("astra-dxvk.json"));
+}
+
+bool DxvkDeployer::isDeployed(const QFileInfo &target, const QJsonObject &record, const QByteArray &hash)
+{
+    if (!target.isFile() || hash.isEmpty()) {
+        return false;
+    }
+
+    // The usual case, where nothing has touched it since it was copied
+    if (!record.isEmpty() && record["sha256"_L1].toString().toLatin1() == hash && record["size"_L1].toInteger() == target.size()
+        && record["modified"_L1].toInteger() == lastModified(target)) {
+        return true;
+    }
+
+    // Otherwise it might still be the right file, like in prefixes that were set up before there was a manifest
+    return hashFile(target.absoluteFilePath()) == hash;
+}
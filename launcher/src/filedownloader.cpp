@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filedownloader.h"
+#include "astra_log.h"
+#include "bandwidthlimiter.h"
+#include "utility.h"
+
+#include <KLocalizedString>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSaveFile>
+#include <qcoronetworkreply.h>
+
+// How much data Qt is allowed to buffer before we write it out, the socket is paused once this is full
+constexpr qint64 readBufferSize = 1024 * 1024;
+constexpr qint64 throttledReadBufferSize = 64 * 1024;
+
+FileDownloader::FileDownloader(QNetworkAccessManager *mgr, const QUrl &url, const QString &filePath, QObject *parent)
+    : QObject(parent)
+    , m_mgr(mgr)
+    , m_url(url)
+    , m_filePath(filePath)
+{
+}
+
+void FileDownloader::setExpectedHash(const QCryptographicHash::Algorithm algorithm, const QByteArray &hash)
+{
+    m_hash.emplace(algorithm);
+    m_expectedHash = hash;
+}
+
+void FileDownloader::setBandwidthLimiter(BandwidthLimiter *limiter)
+{
+    m_limiter = limiter;
+}
+
+QCoro::Task<bool> FileDownloader::download()
+{
+    // QSaveFile makes sure a failed download never replaces an existing file
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_errorString = file.errorString();
+        co_return false;
+    }
+
+    const QNetworkRequest request(m_url);
+    Utility::printRequest(QStringLiteral("GET"), request);
+
+    const auto reply = m_mgr->get(request);
+    // When throttled, a lot less is buffered so the socket is paused sooner
+    reply->setReadBufferSize(m_limiter ? throttledReadBufferSize : readBufferSize);
+
+    connect(reply, &QNetworkReply::downloadProgress, this, &FileDownloader::progress);
+
+    while (m_errorString.isEmpty() && (!reply->isFinished() || reply->bytesAvailable() > 0)) {
+        const QByteArray data = co_await qCoro(reply).readAll();
+        if (data.isEmpty()) {
+            continue;
+        }
+
+        if (m_limiter) {
+            co_await m_limiter->acquire(data.size());
+        }
+
+        write(reply, file, data);
+    }
+
+    reply->disconnect(this);
+    reply->deleteLater();
+
+    if (!m_errorString.isEmpty()) {
+        // This was already set when writing failed, which is more useful than "operation cancelled"
+        file.cancelWriting();
+        co_return false;
+    }
+
+    if (reply->error() != QNetworkReply::NetworkError::NoError) {
+        m_errorString = reply->errorString();
+        file.cancelWriting();
+        co_return false;
+    }
+
+    if (m_hash && m_hash->result() != m_expectedHash) {
+        qWarning(ASTRA_LOG) << m_url << "failed the integrity check, expected" << m_expectedHash.toHex() << "but got" << m_hash->result().toHex();
+        m_errorString = i18n("The downloaded file failed the integrity check!");
+        file.cancelWriting();
+        co_return false;
+    }
+
+    if (!file.commit()) {
+        m_errorString = file.errorString();
+        co_return false;
+    }
+
+    co_return true;
+}
+
+QString FileDownloader::errorString() const
+{
+    return m_errorString;
+}
+
+QByteArray FileDownloader::hash() const
+{
+    if (m_hash) {
+        return m_hash->result();
+    }
+
+    return {};
+}
+
+void FileDownloader::write(QNetworkReply *reply, QSaveFile &file, const QByteArray &data)
+{
+    if (m_hash) {
+        m_hash->addData(data);
+    }
+
+    if (file.write(data) != data.size()) {
+        m_errorString = file.errorString();
+        reply->abort();
+    }
+}
+
+#include "moc_filedownloader.cpp"
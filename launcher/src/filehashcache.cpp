@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filehashcache.h"
+#include "astra_log.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+using namespace Qt::StringLiterals;
+
+// A file changed this soon after its last modification could still have the same timestamp, so it isn't cached yet
+constexpr qint64 racyModificationWindow = 2000;
+
+FileHashCache::FileHashCache(const QString &cachePath)
+    : m_cachePath(cachePath)
+{
+    QFile file(cachePath);
+    if (file.open(QIODevice::ReadOnly)) {
+        m_entries = QJsonDocument::fromJson(file.readAll()).object();
+    }
+}
+
+QString FileHashCache::hash(const QString &filePath)
+{
+    const QFileInfo info(filePath);
+    if (!info.isFile()) {
+        return {};
+    }
+
+    const QString key = info.absoluteFilePath();
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+
+    {
+        const QMutexLocker locker(&m_mutex);
+        const QJsonObject entry = m_entries[key].toObject();
+        if (!entry.isEmpty() && entry["size"_L1].toInteger() == info.size() && entry["modified"_L1].toInteger() == modified) {
+            return entry["sha256"_L1].toString();
+        }
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return {};
+    }
+
+    const QString result = QString::fromLatin1(hash.result().toHex());
+
+    const QMutexLocker locker(&m_mutex);
+    m_hashedCount++;
+
+    if (QDateTime::currentMSecsSinceEpoch() - modified > racyModificationWindow) {
+        m_entries[key] = QJsonObject{
+            {"size"_L1, info.size()},
+            {"modified"_L1, modified},
+            {"sha256"_L1, result},
+        };
+        m_modified = true;
+    }
+
+    return result;
+}
+
+bool FileHashCache::save()
+{
+    const QMutexLocker locker(&m_mutex);
+    if (!m_modified) {
+        return true;
+    }
+
+    // Files that were deleted since don't need to be remembered anymore
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (QFileInfo::exists(it.key())) {
+            ++it;
+        } else {
+            it = m_entries.erase(it);
+        }
+    }
+
+    QDir().mkpath(QFileInfo(m_cachePath).absolutePath());
+
+    QSaveFile file(m_cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning(ASTRA_LOG) << "Failed to write hash cache" << file.errorString();
+        return false;
+    }
+
+    file.write(QJsonDocument(m_entries).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning(ASTRA_LOG) << "Failed to write hash cache" << file.errorString();
+        return false;
+    }
+
+    m_modified = false;
+
+    return true;
+}
+
+int FileHashCache::hashedCount() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_hashedCount;
+}
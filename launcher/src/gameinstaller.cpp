@@ -3,13 +3,17 @@
 
 #include "gameinstaller.h"
 
+#include <KFormat>
 #include <KLocalizedString>
 #include <QFile>
 #include <QNetworkReply>
 #include <QStandardPaths>
+#include <QtConcurrentRun>
 #include <physis.hpp>
+#include <qcorofuture.h>
 
 #include "astra_log.h"
+#include "filedownloader.h"
 #include "launchercore.h"
 #include "profile.h"
 #include "utility.h"
@@ -33,49 +37,54 @@ GameInstaller::GameInstaller(LauncherCore &launcher, Profile &profile, const QSt
 void GameInstaller::start()
 {
     if (m_localInstallerPath.isEmpty()) {
-        const auto request = QNetworkRequest(QUrl(installerUrl));
-        Utility::printRequest(QStringLiteral("GET"), request);
-
-        auto reply = m_launcher.mgr()->get(request);
-
-        QObject::connect(reply, &QNetworkReply::finished, [this, reply] {
-            if (reply->error() != QNetworkReply::NetworkError::NoError) {
-                Q_EMIT error(reply->errorString());
-                return;
-            }
-
-            const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-
-            const QByteArray data = reply->readAll();
-            QCryptographicHash hash(QCryptographicHash::Sha256);
-            hash.addData(data);
-
-            if (hash.result() != installerSha256) {
-                Q_EMIT error(i18n("The installer failed the integrity check!"));
-                return;
-            }
-
-            QFile file(dataDir.absoluteFilePath(QStringLiteral("ffxivsetup.exe")));
-            file.open(QIODevice::WriteOnly);
-            file.write(data);
-            file.close();
-
-            m_localInstallerPath = file.fileName();
-            installGame();
-        });
+        downloadInstaller();
     } else {
         installGame();
     }
 }
 
-void GameInstaller::installGame()
+QCoro::Task<> GameInstaller::downloadInstaller()
+{
+    const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    const QString filePath = dataDir.absoluteFilePath(QStringLiteral("ffxivsetup.exe"));
+
+    Q_EMIT stageChanged(i18n("Downloading installer…"));
+
+    // The installer is written to disk and hashed as it arrives, so it's never held in memory
+    FileDownloader downloader(m_launcher.mgr(), QUrl(installerUrl), filePath);
+    downloader.setExpectedHash(QCryptographicHash::Sha256, installerSha256);
+    connect(&downloader, &FileDownloader::progress, this, [this](const qint64 received, const qint64 total) {
+        const KFormat format;
+        if (total > 0) {
+            Q_EMIT stageChanged(i18n("Downloading installer…"),
+                                i18n("%1 of %2", format.formatByteSize(static_cast<double>(received)), format.formatByteSize(static_cast<double>(total))));
+        } else {
+            Q_EMIT stageChanged(i18n("Downloading installer…"), format.formatByteSize(static_cast<double>(received)));
+        }
+        Q_EMIT downloadProgress(received, total);
+    });
+
+    if (!co_await downloader.download()) {
+        Q_EMIT error(downloader.errorString());
+        co_return;
+    }
+
+    m_localInstallerPath = filePath;
+    co_await installGame();
+}
+
+QCoro::Task<> GameInstaller::installGame()
 {
     const QDir installDirectory = m_profile.gamePath();
 
-    const std::string installDirectoryStd = installDirectory.absolutePath().toStdString();
-    const std::string fileNameStd = m_localInstallerPath.toStdString();
+    // physis doesn't report how far along it is, so there's nothing to show besides that it's working
+    Q_EMIT stageChanged(i18n("Installing…"));
+    Q_EMIT stageIndeterminate();
 
-    physis_install_game(fileNameStd.c_str(), installDirectoryStd.c_str());
+    // Unpacking the installer takes a while, so keep it off of the UI thread
+    co_await QtConcurrent::run([installDirectoryStd = installDirectory.absolutePath().toStdString(), fileNameStd = m_localInstallerPath.toStdString()] {
+        physis_install_game(fileNameStd.c_str(), installDirectoryStd.c_str());
+    });
 
     m_profile.readGameVersion();
 
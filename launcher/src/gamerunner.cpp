@@ -8,23 +8,114 @@
 #endif
 
 #include "astra_log.h"
+#include "dxvkdeployer.h"
 #include "encryptedarg.h"
 #include "launchercore.h"
 #include "processlogger.h"
+#include "processtreetracker.h"
 #include "processwatcher.h"
 #include "utility.h"
+#include "wineregistry.h"
 
+#include <KLocalizedString>
 #include <KProcessList>
+#include <QDateTime>
+#include <QPromise>
+#include <QScopeGuard>
+#include <QtConcurrentRun>
+#include <qcorofuture.h>
+#include <qcoroprocess.h>
 
 using namespace Qt::StringLiterals;
 
+// Nothing run while preparing the prefix should take anywhere near this long, unless something is stuck
+constexpr auto wineToolTimeout = std::chrono::seconds(30);
+
+// How long a started wineserver stays around once nothing is using it, so it still exits if we never get to stop it
+constexpr int wineServerPersistence = 15 * 60;
+
+/// \return Whether to set HideWineExports for @p profile, or nullopt if it should be left alone.
+static std::optional<bool> hideWineExports(const Profile &profile)
+{
+    if (profile.isBenchmark()) {
+        return std::nullopt;
+    }
+
+    // FFXIV detects this as a "macOS" build by checking if Wine shows up
+    return profile.account()->license() != Account::GameLicense::macOS;
+}
+
+/// Makes the same changes to @p userRegistry and @p systemRegistry that reg and winecfg would've done.
+/// @p hideWineExports is skipped if it's nullopt.
+static void applyWineRegistry(WineRegistry &userRegistry, WineRegistry &systemRegistry, const std::optional<bool> hideWineExports)
+{
+    if (hideWineExports) {
+        userRegistry.setString(QStringLiteral("Software\\Wine"), QStringLiteral("HideWineExports"), *hideWineExports ? QStringLiteral("1") : QStringLiteral("0"));
+    }
+
+    // The same as "winecfg /v win7", which also removes any per-user override
+    userRegistry.remove(QStringLiteral("Software\\Wine"), QStringLiteral("Version"));
+
+    QStringList versionKeys{QStringLiteral("Software\\Microsoft\\Windows NT\\CurrentVersion")};
+    // 64-bit prefixes have a separate view for 32-bit programs
+    if (systemRegistry.rawValue(QStringLiteral("Software\\Wow6432Node\\Microsoft\\Windows NT\\CurrentVersion"), QStringLiteral("CurrentVersion"))) {
+        versionKeys.push_back(QStringLiteral("Software\\Wow6432Node\\Microsoft\\Windows NT\\CurrentVersion"));
+    }
+
+    for (const QString &key : versionKeys) {
+        systemRegistry.setString(key, QStringLiteral("CurrentVersion"), QStringLiteral("6.1"));
+        systemRegistry.setString(key, QStringLiteral("CSDVersion"), QStringLiteral("Service Pack 1"));
+        systemRegistry.setString(key, QStringLiteral("CurrentBuild"), QStringLiteral("7601"));
+        systemRegistry.setString(key, QStringLiteral("CurrentBuildNumber"), QStringLiteral("7601"));
+        systemRegistry.setString(key, QStringLiteral("ProductName"), QStringLiteral("Windows 7"));
+        systemRegistry.remove(key, QStringLiteral("CurrentMajorVersionNumber"));
+        systemRegistry.remove(key, QStringLiteral("CurrentMinorVersionNumber"));
+    }
+
+    systemRegistry.setString(QStringLiteral("System\\CurrentControlSet\\Control\\ProductOptions"), QStringLiteral("ProductType"), QStringLiteral("WinNT"));
+    systemRegistry.setDword(QStringLiteral("System\\CurrentControlSet\\Control\\Windows"), QStringLiteral("CSDVersion"), 0x100);
+}
+
+/// Configures the registry in @p winePrefixPath by editing user.reg and system.reg directly, see applyWineRegistry().
+/// \return False if the files couldn't be edited, because the prefix is new or wineserver is running.
+static bool configureWineRegistry(const QString &winePrefixPath, const std::optional<bool> hideWineExports)
+{
+    const QDir winePrefix(winePrefixPath);
+    WineRegistry userRegistry(winePrefix.absoluteFilePath(QStringLiteral("user.reg")));
+    WineRegistry systemRegistry(winePrefix.absoluteFilePath(QStringLiteral("system.reg")));
+    if (!userRegistry.load() || !systemRegistry.load()) {
+        return false;
+    }
+
+    // wineserver saves what it has back to these files, so if they're already right it doesn't matter if it's running
+    applyWineRegistry(userRegistry, systemRegistry, hideWineExports);
+    if (!userRegistry.isModified() && !systemRegistry.isModified()) {
+        qCDebug(ASTRA_LOG) << "Wine prefix registry is already configured";
+        return true;
+    }
+
+    const WinePrefixLock lock(winePrefixPath);
+    if (!lock.isLocked()) {
+        qCInfo(ASTRA_LOG) << "Couldn't lock the Wine prefix, so the registry can't be edited directly";
+        return false;
+    }
+
+    // They could've been saved again before we got the lock
+    if (!userRegistry.load() || !systemRegistry.load()) {
+        return false;
+    }
+    applyWineRegistry(userRegistry, systemRegistry, hideWineExports);
+
+    return userRegistry.save() && systemRegistry.save();
+}
+
 GameRunner::GameRunner(LauncherCore &launcher, QObject *parent)
     : QObject(parent)
     , m_launcher(launcher)
 {
 }
 
-void GameRunner::beginGameExecutable(Profile &profile, const std::optional<LoginAuth> &auth)
+QCoro::Task<> GameRunner::beginGameExecutable(Profile &profile, const std::optional<LoginAuth> &auth)
 {
     QString gameExectuable;
     if (profile.directx9Enabled() && profile.hasDirectx9()) {
@@ -34,21 +125,29 @@ void GameRunner::beginGameExecutable(Profile &profile, const std::optional<Login
     }
 
     if (profile.dalamudShouldLaunch()) {
-        beginDalamudGame(gameExectuable, profile, auth);
+        co_await beginDalamudGame(gameExectuable, profile, auth);
     } else {
-        beginVanillaGame(gameExectuable, profile, auth);
+        co_await beginVanillaGame(gameExectuable, profile, auth);
     }
 
     Q_EMIT m_launcher.successfulLaunch();
 }
 
-void GameRunner::beginVanillaGame(const QString &gameExecutablePath, Profile &profile, const std::optional<LoginAuth> &auth)
+QCoro::Task<> GameRunner::beginVanillaGame(const QString &gameExecutablePath, Profile &profile, const std::optional<LoginAuth> &auth)
 {
     profile.setLoggedIn(true);
 
+    const auto tracker = createSessionTracker();
+
+    auto env = QProcessEnvironment::systemEnvironment();
+    tracker->addToEnvironment(env);
+
     const auto gameProcess = new QProcess(this);
-    gameProcess->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
-    connect(gameProcess, &QProcess::finished, this, [this, &profile](const int exitCode) {
+    gameProcess->setProcessEnvironment(env);
+    connect(gameProcess, &QProcess::finished, this, [this, &profile, tracker](const int exitCode) {
+        tracker->stop();
+        tracker->deleteLater();
+
         profile.setLoggedIn(false);
         Q_UNUSED(exitCode)
         Q_EMIT m_launcher.gameClosed(&profile);
@@ -58,10 +157,13 @@ void GameRunner::beginVanillaGame(const QString &gameExecutablePath, Profile &pr
 
     new ProcessLogger(QStringLiteral("ffxiv"), gameProcess);
 
-    launchExecutable(profile, gameProcess, {gameExecutablePath, args}, true, true);
+    co_await prepareWinePrefix(profile);
+
+    Q_EMIT m_launcher.stageChanged(i18n("Launching game..."));
+    launchExecutable(profile, gameProcess, {gameExecutablePath, args}, true);
 }
 
-void GameRunner::beginDalamudGame(const QString &gameExecutablePath, Profile &profile, const std::optional<LoginAuth> &auth)
+QCoro::Task<> GameRunner::beginDalamudGame(const QString &gameExecutablePath, Profile &profile, const std::optional<LoginAuth> &auth)
 {
     profile.setLoggedIn(true);
 
@@ -89,10 +191,13 @@ void GameRunner::beginDalamudGame(const QString &gameExecutablePath, Profile &pr
     const QDir dalamudInstallDir = dalamudDir.absoluteFilePath(profile.dalamudChannelName());
     const QString dalamudInjector = dalamudInstallDir.absoluteFilePath(QStringLiteral("Dalamud.Injector.exe"));
 
+    const auto tracker = createSessionTracker();
+
     const auto dalamudProcess = new QProcess(this);
-    connect(dalamudProcess, &QProcess::finished, this, [this, &profile, logDir](const int exitCode) {
-        Q_UNUSED(exitCode)
+    const auto injectionLogger = new ProcessLogger(QStringLiteral("dalamud-initial-injection"), dalamudProcess);
 
+    // The injector's output is read back from its log, so this has to wait until that's completely written
+    connect(injectionLogger, &ProcessLogger::finished, this, [this, &profile, logDir, tracker] {
         // So here's the kicker, we can't depend on Dalamud to give us an accurate finished signal for the game.
         // finished() is called when the injector exits.
 
@@ -105,31 +210,49 @@ void GameRunner::beginDalamudGame(const QString &gameExecutablePath, Profile &pr
 
         const auto match = pidRegex.match(log);
         if (match.hasCaptured(1)) {
-            qint64 PID = match.captured(1).toInt();
+            const qint64 PID = match.captured(1).toInt();
             if (PID > 0) {
                 qCInfo(ASTRA_LOG) << "Recieved PID from Dalamud:" << PID;
-#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
-                // Dalamud gives us a Windows PID, but that's useless to us. We need to find the PID of the game now:
 
+                std::optional<qint64> gamePid;
+#if defined(Q_OS_LINUX)
+                // Dalamud gives us a Windows PID, but that's useless to us. The game isn't a child of the injector either since Wine
+                // detaches it, so instead look for it among the processes started for this session. Looking any further could find another client.
+                gamePid = tracker->findProcess(QStringLiteral("ffxiv"));
+#elif defined(Q_OS_MAC)
+                // Dalamud gives us a Windows PID, but that's useless to us. We need to find the PID of the game now:
                 const auto info = KProcessList::processInfoList();
                 for (const auto &entry : info) {
                     if (entry.name().contains(QLatin1String("ffxiv"))) {
-                        qCInfo(ASTRA_LOG) << "Using PID of" << entry.name() << "which is" << entry.pid();
-                        PID = entry.pid();
+                        gamePid = entry.pid();
                     }
                 }
-
+#else
+                gamePid = PID;
 #endif
-                auto watcher = new ProcessWatcher(PID);
-                connect(watcher, &ProcessWatcher::finished, this, [this, &profile] {
-                    profile.setLoggedIn(false);
-                    Q_EMIT m_launcher.gameClosed(&profile);
-                });
-                return;
+
+                if (gamePid) {
+                    qCInfo(ASTRA_LOG) << "Using PID of the game which is" << *gamePid;
+
+                    auto watcher = new ProcessWatcher(*gamePid);
+                    connect(watcher, &ProcessWatcher::finished, this, [this, &profile, tracker] {
+                        tracker->stop();
+                        tracker->deleteLater();
+
+                        profile.setLoggedIn(false);
+                        Q_EMIT m_launcher.gameClosed(&profile);
+                    });
+                    return;
+                }
+
+                qCWarning(ASTRA_LOG) << "Couldn't find the game process, so there's no way to tell when it exits";
             }
         }
 
         // If Dalamud didn't give a valid PID, OK. Let's just do our previous status quo and inidcate we did log out.
+        tracker->stop();
+        tracker->deleteLater();
+
         profile.setLoggedIn(false);
         Q_EMIT m_launcher.gameClosed(&profile);
     });
@@ -140,12 +263,14 @@ void GameRunner::beginDalamudGame(const QString &gameExecutablePath, Profile &pr
 #if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
     env.insert(QStringLiteral("XL_WINEONLINUX"), QStringLiteral("true"));
 #endif
+    tracker->addToEnvironment(env);
     dalamudProcess->setProcessEnvironment(env);
 
-    new ProcessLogger(QStringLiteral("dalamud-initial-injection"), dalamudProcess);
-
     const auto args = getGameArgs(profile, auth);
 
+    co_await prepareWinePrefix(profile);
+
+    Q_EMIT m_launcher.stageChanged(i18n("Launching game..."));
     launchExecutable(profile,
                      dalamudProcess,
                      {Utility::toWindowsPath(dalamudInjector),
@@ -161,10 +286,25 @@ void GameRunner::beginDalamudGame(const QString &gameExecutablePath, Profile &pr
                       QStringLiteral("--logpath=") + Utility::toWindowsPath(logDir),
                       QStringLiteral("--"),
                       args},
-                     true,
                      true);
 }
 
+ProcessTreeTracker *GameRunner::createSessionTracker()
+{
+    const auto tracker = new ProcessTreeTracker(this);
+
+    if (const int interval = m_launcher.settings()->resourceSamplingInterval(); interval > 0) {
+        const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        const QDir logDir = dataDir.absoluteFilePath(QStringLiteral("log"));
+        Utility::createPathIfNeeded(logDir);
+
+        const QString fileName = QStringLiteral("resources-%1.csv").arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyy-MM-dd-HH-mm-ss")));
+        tracker->startSampling(logDir.absoluteFilePath(fileName), std::chrono::seconds(interval));
+    }
+
+    return tracker;
+}
+
 QString GameRunner::getGameArgs(const Profile &profile, const std::optional<LoginAuth> &auth) const
 {
     QList<std::pair<QString, QString>> gameArgs;
@@ -251,44 +391,11 @@ QString GameRunner::getGameArgs(const Profile &profile, const std::optional<Logi
     return !profile.isBenchmark() && m_launcher.settings()->argumentsEncrypted() ? encryptGameArg(argJoined) : argJoined;
 }
 
-void GameRunner::launchExecutable(const Profile &profile, QProcess *process, const QStringList &args, bool isGame, bool needsRegistrySetup)
+void GameRunner::launchExecutable(const Profile &profile, QProcess *process, const QStringList &args, const bool isGame)
 {
     QList<QString> arguments;
     auto env = process->processEnvironment();
 
-    if (needsRegistrySetup) {
-#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
-        // FFXIV detects this as a "macOS" build by checking if Wine shows up
-        if (!profile.isBenchmark()) {
-            const int value = profile.account()->license() == Account::GameLicense::macOS ? 0 : 1;
-            addRegistryKey(profile, QStringLiteral("HKEY_CURRENT_USER\\Software\\Wine"), QStringLiteral("HideWineExports"), QString::number(value));
-        }
-
-        setWindowsVersion(profile, QStringLiteral("win7"));
-
-        // TODO: band-aid fix to wait for wine to exit, otherwise gamescope will collide
-        QThread::sleep(2);
-
-        // copy DXVK
-        const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-        const QDir compatibilityToolDir = dataDir.absoluteFilePath(QStringLiteral("tool"));
-        const QDir dxvkDir = compatibilityToolDir.absoluteFilePath(QStringLiteral("dxvk"));
-        const QDir dxvk64Dir = dxvkDir.absoluteFilePath(QStringLiteral("x64"));
-
-        const QDir winePrefix = profile.winePrefixPath();
-        const QDir driveC = winePrefix.absoluteFilePath(QStringLiteral("drive_c"));
-        const QDir windows = driveC.absoluteFilePath(QStringLiteral("windows"));
-        const QDir system32 = windows.absoluteFilePath(QStringLiteral("system32"));
-
-        for (const auto &entry : dxvk64Dir.entryInfoList(QDir::Files | QDir::NoDotAndDotDot)) {
-            if (QFile::exists(system32.absoluteFilePath(entry.fileName()))) {
-                QFile::remove(system32.absoluteFilePath(entry.fileName()));
-            }
-            QFile::copy(entry.absoluteFilePath(), system32.absoluteFilePath(entry.fileName()));
-        }
-#endif
-    }
-
     if (isGame && profile.gamescopeEnabled()) {
         arguments.push_back(QStringLiteral("gamescope"));
 
@@ -373,22 +480,220 @@ void GameRunner::launchExecutable(const Profile &profile, QProcess *process, con
     process->start();
 }
 
-void GameRunner::addRegistryKey(const Profile &settings, const QString &key, const QString &value, const QString &data)
+QCoro::Task<> GameRunner::prepareWinePrefix(const Profile &profile)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+    Q_EMIT m_launcher.stageChanged(i18n("Configuring Wine..."));
+    Q_EMIT m_launcher.stageIndeterminate();
+
+    const std::optional<bool> hideExports = hideWineExports(profile);
+
+    // Starting Wine just to change a few registry values is slow, so they're edited directly when possible
+    const bool configured = co_await QtConcurrent::run(configureWineRegistry, profile.winePrefixPath(), hideExports);
+    if (!configured) {
+        if (hideExports) {
+            co_await addRegistryKey(profile, QStringLiteral("HKEY_CURRENT_USER\\Software\\Wine"), QStringLiteral("HideWineExports"), QString::number(*hideExports ? 1 : 0));
+        }
+
+        co_await setWindowsVersion(profile, QStringLiteral("win7"));
+
+        // Wine has to be completely gone before the game starts, otherwise gamescope will collide with it
+        Q_EMIT m_launcher.stageChanged(i18n("Waiting for Wine to exit..."));
+        co_await waitForWineServer(profile);
+    }
+
+    Q_EMIT m_launcher.stageChanged(i18n("Installing DXVK..."));
+    co_await QtConcurrent::run([winePrefixPath = profile.winePrefixPath()] {
+        const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        const QDir compatibilityToolDir = dataDir.absoluteFilePath(QStringLiteral("tool"));
+
+        DxvkDeployer deployer(compatibilityToolDir.absoluteFilePath(QStringLiteral("dxvk")), winePrefixPath);
+        if (!deployer.deploy()) {
+            qCWarning(ASTRA_LOG) << "Failed to install DXVK:" << deployer.errorString();
+        } else if (deployer.copiedCount() > 0) {
+            qCInfo(ASTRA_LOG) << "Copied" << deployer.copiedCount() << "DXVK files into the Wine prefix";
+        }
+    });
+
+#if defined(Q_OS_LINUX)
+    // DXVK writes its logs to DXVK_LOG_PATH itself, so the last session's are archived before it starts writing new ones
+    co_await ProcessLogger::archiveLogs({QStringLiteral("*_d3d9.log"), QStringLiteral("*_d3d11.log"), QStringLiteral("*_dxgi.log")});
+#endif
+#else
+    Q_UNUSED(profile)
+    co_return;
+#endif
+}
+
+QCoro::Task<> GameRunner::runWineTool(const Profile &profile, const QStringList &args)
+{
+    QProcess process;
+    process.setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+    launchExecutable(profile, &process, args, false);
+
+    if (!co_await qCoro(process).waitForFinished(wineToolTimeout)) {
+        qCWarning(ASTRA_LOG) << args.first() << "took too long to finish, killing it";
+        process.kill();
+        co_await qCoro(process).waitForFinished();
+    }
+}
+
+QCoro::Task<> GameRunner::waitForWineServer(const Profile &profile)
+{
+    // The server started ahead of time only exits after it has been idle for a while, and gamescope isn't used with one anyway
+    if (!m_wineServerPrefix.isEmpty() && m_wineServerPrefix == profile.winePrefixPath()) {
+        co_return;
+    }
+
+    const QString wineServerPath = GameRunner::wineServerPath(profile);
+    if (!QFileInfo::exists(wineServerPath)) {
+        qCWarning(ASTRA_LOG) << "Could not find wineserver at" << wineServerPath << "so not waiting for Wine to exit";
+        co_return;
+    }
+
+    auto env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("WINEPREFIX"), profile.winePrefixPath());
+
+    QProcess process;
+    process.setProcessEnvironment(env);
+    process.setProgram(wineServerPath);
+    // This blocks until every Wine process in the prefix has exited, and the server has shut down
+    process.setArguments({QStringLiteral("-w")});
+    process.start();
+
+    if (!co_await qCoro(process).waitForFinished(wineToolTimeout)) {
+        qCWarning(ASTRA_LOG) << "Wine didn't exit in time, launching anyway";
+        process.kill();
+        co_await qCoro(process).waitForFinished();
+    }
+}
+
+QCoro::Task<> GameRunner::startWineServer(const Profile &profile)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+    // gamescope needs every Wine process to be started inside of it, so it can't share a server started out here
+    if (profile.gamescopeEnabled() || !profile.isWineInstalled()) {
+        co_return;
+    }
+
+    // Only one is started at a time, otherwise a second call could stop the server the first is still starting
+    while (m_wineServerStart.isRunning()) {
+        co_await m_wineServerStart;
+    }
+
+    const QString winePrefixPath = profile.winePrefixPath();
+    if (winePrefixPath == m_wineServerPrefix) {
+        co_return;
+    }
+
+    // New prefixes are set up by the first Wine program run in them, which should happen when launching as usual
+    if (!QFileInfo::exists(QDir(winePrefixPath).absoluteFilePath(QStringLiteral("system.reg")))) {
+        co_return;
+    }
+
+    const QString serverPath = wineServerPath(profile);
+    if (!QFileInfo::exists(serverPath)) {
+        co_return;
+    }
+
+    stopWineServer();
+    m_wineServerPrefix = winePrefixPath;
+    m_wineServerPath = serverPath;
+    m_wineServerStopRequested = false;
+
+    QPromise<void> startPromise;
+    m_wineServerStart = startPromise.future();
+    startPromise.start();
+    const auto finishStart = qScopeGuard([this, &startPromise] {
+        startPromise.finish();
+
+        if (m_wineServerStopRequested) {
+            m_wineServerStopRequested = false;
+            stopWineServer();
+        }
+    });
+
+    // Once the server is running the registry can't be edited directly anymore, so do it now
+    co_await QtConcurrent::run(configureWineRegistry, winePrefixPath, hideWineExports(profile));
+
+    auto env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("WINEPREFIX"), winePrefixPath);
+
+    QProcess process;
+    process.setProcessEnvironment(env);
+    process.setProgram(serverPath);
+    // This keeps running for a while after the last Wine process exits, or until it's told to stop. It forks into the background once it's ready.
+    process.setArguments({QStringLiteral("-p%1").arg(wineServerPersistence)});
+    process.start();
+
+    const bool finished = co_await qCoro(process).waitForFinished(wineToolTimeout);
+    if (!finished || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        qCWarning(ASTRA_LOG) << "Failed to start wineserver for" << winePrefixPath << process.readAllStandardError();
+        if (!finished) {
+            process.kill();
+            co_await qCoro(process).waitForFinished();
+        }
+        if (m_wineServerPrefix == winePrefixPath) {
+            m_wineServerPrefix.clear();
+        }
+        co_return;
+    }
+
+    qCInfo(ASTRA_LOG) << "Started a wineserver ahead of time for" << winePrefixPath;
+#else
+    Q_UNUSED(profile)
+    co_return;
+#endif
+}
+
+void GameRunner::stopWineServer()
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+    if (m_wineServerPrefix.isEmpty()) {
+        return;
+    }
+
+    // It's stopped once it has finished starting, otherwise it could start again right after being told to stop
+    if (m_wineServerStart.isRunning()) {
+        m_wineServerStopRequested = true;
+        return;
+    }
+
+    // Stopping it would take the game down too, so it's left alone
+    for (const auto profile : m_launcher.profileManager()->profiles()) {
+        if (profile->loggedIn() && profile->winePrefixPath() == m_wineServerPrefix) {
+            qCInfo(ASTRA_LOG) << "Not stopping wineserver for" << m_wineServerPrefix << "because the game is still running";
+            return;
+        }
+    }
+
+    auto env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("WINEPREFIX"), m_wineServerPrefix);
+
+    // Nothing should be running in the prefix now, except for Wine's own background services
+    QProcess process;
+    process.setProcessEnvironment(env);
+    process.setProgram(m_wineServerPath);
+    process.setArguments({QStringLiteral("-k")});
+    process.startDetached();
+
+    qCInfo(ASTRA_LOG) << "Stopped wineserver for" << m_wineServerPrefix;
+    m_wineServerPrefix.clear();
+#endif
+}
+
+QString GameRunner::wineServerPath(const Profile &profile)
+{
+    // wineserver always lives next to wine, so there's no need to ask for another path
+    return QFileInfo(profile.winePath()).absoluteDir().absoluteFilePath(QStringLiteral("wineserver"));
+}
+
+QCoro::Task<> GameRunner::addRegistryKey(const Profile &settings, const QString &key, const QString &value, const QString &data)
 {
-    const auto process = new QProcess(this);
-    process->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
-    launchExecutable(settings,
-                     process,
-                     {QStringLiteral("reg"), QStringLiteral("add"), key, QStringLiteral("/v"), value, QStringLiteral("/d"), data, QStringLiteral("/f")},
-                     false,
-                     false);
-    process->waitForFinished();
+    co_await runWineTool(settings, {QStringLiteral("reg"), QStringLiteral("add"), key, QStringLiteral("/v"), value, QStringLiteral("/d"), data, QStringLiteral("/f")});
 }
 
-void GameRunner::setWindowsVersion(const Profile &settings, const QString &version)
+QCoro::Task<> GameRunner::setWindowsVersion(const Profile &settings, const QString &version)
 {
-    const auto process = new QProcess(this);
-    process->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
-    launchExecutable(settings, process, {QStringLiteral("winecfg"), QStringLiteral("/v"), version}, false, false);
-    process->waitForFinished();
+    co_await runWineTool(settings, {QStringLiteral("winecfg"), QStringLiteral("/v"), version});
 }
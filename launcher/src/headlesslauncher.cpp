@@ -0,0 +1,261 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "headlesslauncher.h"
+#include "launchercore.h"
+
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QJsonDocument>
+#include <QTimer>
+#include <cstdio>
+#include <qcorosignal.h>
+
+#ifdef BUILD_SYNC
+#include "uploadqueue.h"
+#endif
+
+using namespace Qt::StringLiterals;
+
+// How long to wait for the character data to be uploaded after the game exits, before giving up until next time
+constexpr auto uploadWaitTimeout = std::chrono::seconds(30);
+
+HeadlessLauncher::HeadlessLauncher(LauncherCore &launcher, QObject *parent)
+    : QObject(parent)
+    , m_launcher(launcher)
+{
+    connect(&m_launcher, &LauncherCore::stageChanged, this, [](const QString &message, const QString &explanation) {
+        report(QStringLiteral("stage"), {{"message"_L1, message}, {"explanation"_L1, explanation}});
+    });
+    connect(&m_launcher, &LauncherCore::stageDeterminate, this, [](const int min, const int max, const int value) {
+        report(QStringLiteral("progress"), {{"min"_L1, min}, {"max"_L1, max}, {"value"_L1, value}});
+    });
+    connect(&m_launcher, &LauncherCore::loginError, this, [](const QString &message) {
+        report(QStringLiteral("error"), {{"kind"_L1, "login"_L1}, {"message"_L1, message}});
+    });
+    connect(&m_launcher, &LauncherCore::miscError, this, [](const QString &message) {
+        report(QStringLiteral("error"), {{"kind"_L1, "misc"_L1}, {"message"_L1, message}});
+    });
+    connect(&m_launcher, &LauncherCore::dalamudError, this, [](const QString &message) {
+        report(QStringLiteral("error"), {{"kind"_L1, "dalamud"_L1}, {"message"_L1, message}});
+    });
+}
+
+void HeadlessLauncher::start(const Options &options)
+{
+    // Exiting only works once the event loop is running
+    QTimer::singleShot(0, this, [this, options] {
+        run(options);
+    });
+}
+
+QStringList HeadlessLauncher::verifyInstallation(const QString &gamePath)
+{
+    const QDir gameDir(gamePath);
+
+    QStringList requiredFiles = {
+        QStringLiteral("boot/ffxivboot.ver"),
+        QStringLiteral("boot/ffxivboot.exe"),
+        QStringLiteral("boot/ffxivlauncher64.exe"),
+        QStringLiteral("boot/ffxivupdater64.exe"),
+        QStringLiteral("game/ffxivgame.ver"),
+        QStringLiteral("game/ffxiv_dx11.exe"),
+    };
+
+    // Each expansion keeps its version next to its data
+    const QDir sqpackDir = gameDir.absoluteFilePath(QStringLiteral("game/sqpack"));
+    for (const QString &repository : sqpackDir.entryList({QStringLiteral("ex*")}, QDir::Dirs | QDir::NoDotAndDotDot)) {
+        requiredFiles.push_back(QStringLiteral("game/sqpack/%1/%1.ver").arg(repository));
+    }
+
+    // An index is useless without the data it points into
+    QDirIterator indexIterator(sqpackDir.absolutePath(), {QStringLiteral("*.index"), QStringLiteral("*.index2")}, QDir::Files, QDirIterator::Subdirectories);
+    while (indexIterator.hasNext()) {
+        const QFileInfo index = indexIterator.nextFileInfo();
+        const QString dataPath = index.absoluteDir().absoluteFilePath(index.completeBaseName() + QStringLiteral(".dat0"));
+        requiredFiles.push_back(gameDir.relativeFilePath(dataPath));
+    }
+
+    QStringList missingFiles;
+    for (const QString &file : std::as_const(requiredFiles)) {
+        if (!QFileInfo(gameDir.absoluteFilePath(file)).isFile()) {
+            missingFiles.push_back(file);
+        }
+    }
+    missingFiles.removeDuplicates();
+
+    return missingFiles;
+}
+
+QCoro::Task<> HeadlessLauncher::run(Options options)
+{
+    QList<Profile *> profiles;
+    if (options.all || (options.verify && options.update.isEmpty())) {
+        profiles = m_launcher.profileManager()->profiles();
+    } else {
+        for (const QString &name : std::as_const(options.update)) {
+            const auto profile = m_launcher.profileManager()->getProfileByNameOrUUID(name);
+            if (profile == nullptr) {
+                report(QStringLiteral("error"), {{"kind"_L1, "arguments"_L1}, {"message"_L1, QStringLiteral("No profile named %1").arg(name)}});
+                QCoreApplication::exit(InvalidArguments);
+                co_return;
+            }
+            profiles.push_back(profile);
+        }
+    }
+
+    Profile *launchProfile = nullptr;
+    if (!options.launch.isEmpty()) {
+        launchProfile = m_launcher.profileManager()->getProfileByNameOrUUID(options.launch);
+        if (launchProfile == nullptr) {
+            report(QStringLiteral("error"), {{"kind"_L1, "arguments"_L1}, {"message"_L1, QStringLiteral("No profile named %1").arg(options.launch)}});
+            QCoreApplication::exit(InvalidArguments);
+            co_return;
+        }
+    }
+
+    int result = Success;
+    if (options.all || !options.update.isEmpty()) {
+        result = qMax(result, co_await update(profiles));
+    }
+
+    if (options.verify) {
+        result = qMax(result, verify(profiles));
+    }
+
+    // Launching with something already broken isn't going to go well
+    if (launchProfile != nullptr && result == Success) {
+        result = co_await launch(launchProfile);
+    }
+
+    report(QStringLiteral("finished"), {{"exitCode"_L1, result}});
+    QCoreApplication::exit(result);
+}
+
+QCoro::Task<int> HeadlessLauncher::update(const QList<Profile *> &profiles)
+{
+    int result = Success;
+    for (const auto profile : profiles) {
+        if (!profile->isGameInstalled()) {
+            report(QStringLiteral("updated"), {{"profile"_L1, profile->name()}, {"success"_L1, false}, {"reason"_L1, "not-installed"_L1}});
+            result = Failed;
+            continue;
+        }
+
+        report(QStringLiteral("updating"), {{"profile"_L1, profile->name()}});
+
+        const bool succeeded = co_await m_launcher.updateProfile(profile);
+        report(QStringLiteral("updated"), {{"profile"_L1, profile->name()}, {"success"_L1, succeeded}, {"version"_L1, profile->expansionVersionText()}});
+
+        if (!succeeded) {
+            result = Failed;
+        }
+    }
+
+    co_return result;
+}
+
+QCoro::Task<int> HeadlessLauncher::launch(Profile *profile)
+{
+    m_launchResult.reset();
+
+    const auto finish = [this](const int result) {
+        if (!m_launchResult) {
+            m_launchResult = result;
+            Q_EMIT launchFinished();
+        }
+    };
+
+    // The errors themselves were already reported, this is only emitted if the game never started
+    QList<QMetaObject::Connection> connections;
+    connections.push_back(connect(&m_launcher, &LauncherCore::loginFailed, this, [&finish] {
+        finish(Failed);
+    }));
+    connections.push_back(connect(&m_launcher, &LauncherCore::successfulLaunch, this, [profile] {
+        report(QStringLiteral("launched"), {{"profile"_L1, profile->name()}});
+    }));
+
+    // The upload after the game exits shouldn't hold things up for long
+    QTimer uploadTimeout;
+    uploadTimeout.setSingleShot(true);
+    uploadTimeout.setInterval(uploadWaitTimeout);
+    connect(&uploadTimeout, &QTimer::timeout, this, [finish] {
+        finish(Success);
+    });
+
+    connections.push_back(connect(&m_launcher, &LauncherCore::gameClosed, this, [this, &finish, &connections, &uploadTimeout, profile] {
+        report(QStringLiteral("exited"), {{"profile"_L1, profile->name()}});
+
+#ifdef BUILD_SYNC
+        // Give this session's character data a chance to be uploaded, otherwise it waits until the next time the launcher runs.
+        // Anything else in the queue could be waiting a long time to be retried, so that isn't waited for.
+        const auto uploadQueue = m_launcher.uploadQueue();
+        if (const QString accountUuid = profile->account() ? profile->account()->uuid() : QString(); uploadQueue->isPending(accountUuid)) {
+            connections.push_back(connect(uploadQueue, &UploadQueue::attemptFinished, this, [finish, accountUuid](const QString &id) {
+                if (id == accountUuid) {
+                    finish(Success);
+                }
+            }));
+            uploadTimeout.start();
+            return;
+        }
+#endif
+
+        finish(Success);
+    }));
+
+    report(QStringLiteral("launching"), {{"profile"_L1, profile->name()}});
+
+    if (profile->isBenchmark()) {
+        m_launcher.login(profile, {}, {}, {});
+    } else if (profile->account() == nullptr || !m_launcher.autoLogin(profile)) {
+        finish(Failed);
+    }
+
+    // The login may have already failed before getting here
+    if (!m_launchResult) {
+        co_await qCoro(this, &HeadlessLauncher::launchFinished);
+    }
+
+    for (const auto &connection : std::as_const(connections)) {
+        disconnect(connection);
+    }
+
+    co_return *m_launchResult;
+}
+
+int HeadlessLauncher::verify(const QList<Profile *> &profiles)
+{
+    int result = Success;
+    for (const auto profile : profiles) {
+        if (!profile->isGameInstalled()) {
+            continue;
+        }
+
+        const QStringList missingFiles = verifyInstallation(profile->gamePath());
+        for (const QString &file : missingFiles) {
+            report(QStringLiteral("missing"), {{"profile"_L1, profile->name()}, {"path"_L1, file}});
+        }
+
+        report(QStringLiteral("verified"), {{"profile"_L1, profile->name()}, {"success"_L1, missingFiles.isEmpty()}});
+
+        if (!missingFiles.isEmpty()) {
+            result = Failed;
+        }
+    }
+
+    return result;
+}
+
+void HeadlessLauncher::report(const QString &event, QJsonObject fields)
+{
+    fields["event"_L1] = event;
+
+    QByteArray line = QJsonDocument(fields).toJson(QJsonDocument::Compact);
+    line += '\n';
+
+    std::fwrite(line.constData(), 1, line.size(), stdout);
+    std::fflush(stdout);
+}
+
+#include "moc_headlesslauncher.cpp"
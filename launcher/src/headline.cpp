@@ -1,4 +1,63 @@
 // SPDX-FileCopyrightText: 2023 Joshua Goins <josh@redstrate.com>
 // SPDX-License-Identifier: GPL-3.0-or-later
 
-#include "moc_headline.cpp"
\ No newline at end of file
+#include "headline.h"
+#include "bannermodel.h"
+#include "newsmodel.h"
+
+Headline::Headline(QObject *parent)
+    : QObject(parent)
+    , m_banners(new BannerModel(this))
+    , m_news(new NewsModel(this))
+    , m_pinned(new NewsModel(this))
+    , m_topics(new NewsModel(this))
+{
+}
+
+BannerModel *Headline::banners() const
+{
+    return m_banners;
+}
+
+NewsModel *Headline::news() const
+{
+    return m_news;
+}
+
+NewsModel *Headline::pinned() const
+{
+    return m_pinned;
+}
+
+NewsModel *Headline::topics() const
+{
+    return m_topics;
+}
+
+bool Headline::loaded() const
+{
+    return m_loaded;
+}
+
+void Headline::setLoaded(const bool loaded)
+{
+    if (m_loaded != loaded) {
+        m_loaded = loaded;
+        Q_EMIT loadedChanged();
+    }
+}
+
+bool Headline::failedToLoad() const
+{
+    return m_failedToLoad;
+}
+
+void Headline::setFailedToLoad(const bool failed)
+{
+    if (m_failedToLoad != failed) {
+        m_failedToLoad = failed;
+        Q_EMIT failedToLoadChanged();
+    }
+}
+
+#include "moc_headline.cpp"
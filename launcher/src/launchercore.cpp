@@ -7,17 +7,22 @@
 #include <QDir>
 #include <QImage>
 #include <QNetworkAccessManager>
+#include <QScopeGuard>
 #include <QStandardPaths>
 #include <algorithm>
 #include <qcoronetworkreply.h>
 
 #include "account.h"
 #include "assetupdater.h"
+#include "astra_http_log.h"
 #include "astra_log.h"
+#include "backgroundupdater.h"
+#include "bannermodel.h"
 #include "benchmarkinstaller.h"
 #include "compatibilitytoolinstaller.h"
 #include "gamerunner.h"
 #include "launchercore.h"
+#include "newsmodel.h"
 #include "sapphirelogin.h"
 #include "squareenixlogin.h"
 #include "utility.h"
@@ -25,6 +30,7 @@
 #ifdef BUILD_SYNC
 #include "charactersync.h"
 #include "syncmanager.h"
+#include "uploadqueue.h"
 #endif
 
 #ifdef HAS_DBUS
@@ -35,11 +41,21 @@
 
 using namespace Qt::StringLiterals;
 
+// QNetworkAccessManager keeps idle connections around for 120 seconds, so refresh them a bit before that
+constexpr auto prewarmLifetime = std::chrono::seconds(110);
+
+// Don't keep connections open forever if the launcher is left sitting on the login page
+constexpr auto maximumPrewarmDuration = std::chrono::minutes(10);
+
+// How long the upload after the game exits can hold up quitting, when the launcher is set to close
+constexpr auto quitUploadTimeout = std::chrono::seconds(30);
+
 LauncherCore::LauncherCore()
     : QObject()
 {
     m_settings = new LauncherSettings(this);
     m_mgr = new QNetworkAccessManager(this);
+    m_headline = new Headline(this);
     m_sapphireLogin = new SapphireLogin(*this, this);
     m_squareEnixLogin = new SquareEnixLogin(*this, this);
     m_profileManager = new ProfileManager(this);
@@ -51,6 +67,38 @@ LauncherCore::LauncherCore()
 
     connect(this, &LauncherCore::gameClosed, this, &LauncherCore::handleGameExit);
 
+    // Pre-connections made by connectToHost() show up as replies with a special scheme
+    connect(m_mgr, &QNetworkAccessManager::finished, this, [this](QNetworkReply *reply) {
+        if (!reply->url().scheme().startsWith("preconnect-"_L1)) {
+            return;
+        }
+
+        const QString key = QStringLiteral("%1://%2").arg(reply->url().scheme().mid(11), reply->url().host());
+        if (auto it = m_warmConnections.find(key); it != m_warmConnections.end()) {
+            if (reply->error() == QNetworkReply::NoError) {
+                it->connectTime = it->age.elapsed();
+                qDebug(ASTRA_HTTP) << "Pre-connected to" << key << "in" << it->connectTime << "ms";
+            } else {
+                qDebug(ASTRA_HTTP) << "Failed to pre-connect to" << key << reply->errorString();
+                m_warmConnections.erase(it);
+            }
+        }
+
+        reply->deleteLater();
+    });
+
+    m_prewarmTimer = new QTimer(this);
+    m_prewarmTimer->setInterval(prewarmLifetime);
+    connect(m_prewarmTimer, &QTimer::timeout, this, [this] {
+        if (!m_prewarmProfile || m_prewarmStarted.durationElapsed() > maximumPrewarmDuration) {
+            m_prewarmTimer->stop();
+            m_warmConnections.clear();
+            return;
+        }
+
+        prewarmConnections(m_prewarmProfile);
+    });
+
 #ifdef BUILD_SYNC
     m_syncManager = new SyncManager(this);
 #endif
@@ -70,6 +118,26 @@ LauncherCore::LauncherCore()
         setCurrentProfile(profile);
     }
 
+    m_backgroundUpdater = new BackgroundUpdater(*this, this);
+
+#ifdef BUILD_SYNC
+    // Uploads that didn't finish last time are picked back up here
+    m_uploadQueue = new UploadQueue(QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).absoluteFilePath(QStringLiteral("upload-queue.json")),
+                                    this);
+    m_uploadQueue->setHandler([this](const QString &accountUuid) {
+        return uploadCharacterData(accountUuid);
+    });
+#endif
+
+    connect(m_settings, &LauncherSettings::prestartWineServerChanged, this, [this] {
+        if (m_settings->prestartWineServer()) {
+            prestartWine(currentProfile());
+        } else {
+            m_runner->stopWineServer();
+        }
+    });
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, m_runner, &GameRunner::stopWineServer);
+
     m_loadingFinished = true;
     Q_EMIT loadingFinished();
 }
@@ -107,22 +175,58 @@ bool LauncherCore::autoLogin(Profile *profile)
 {
     Q_ASSERT(profile != nullptr);
 
-    QString otp;
-    if (profile->account()->useOTP()) {
-        if (!profile->account()->rememberOTP()) {
-            Q_EMIT loginError(i18n("This account does not have an OTP secret set, but requires it for login."));
-            return false;
+    const auto otp = storedOneTimePassword(*profile->account());
+    if (!otp) {
+        return false;
+    }
+
+    login(profile, profile->account()->name(), profile->account()->getPassword(), *otp);
+    return true;
+}
+
+QCoro::Task<bool> LauncherCore::updateProfile(Profile *profile)
+{
+    Q_ASSERT(profile != nullptr);
+
+    // Anything the background updater was in the middle of is finished first, so both aren't updating the same things
+    co_await m_backgroundUpdater->pause();
+    const auto resumeBackgroundUpdates = qScopeGuard([this] {
+        m_backgroundUpdater->resume();
+    });
+
+    if (!profile->isBenchmark()) {
+        const auto account = profile->account();
+        if (account == nullptr) {
+            Q_EMIT loginError(i18n("The profile %1 doesn't have an account.", profile->name()));
+            co_return false;
         }
 
-        otp = profile->account()->getOTP();
-        if (otp.isEmpty()) {
-            Q_EMIT loginError(i18n("Failed to generate OTP, review the stored secret."));
-            return false;
+        // Game patches are only given out after logging in, which is also when they're installed
+        if (!account->isSapphire()) {
+            if (!account->rememberPassword()) {
+                Q_EMIT loginError(i18n("The password for %1 has to be remembered to update the game without logging in manually.", account->name()));
+                co_return false;
+            }
+
+            const auto otp = storedOneTimePassword(*account);
+            if (!otp) {
+                co_return false;
+            }
+
+            LoginInformation info;
+            info.profile = profile;
+            info.username = account->name();
+            info.password = account->getPassword();
+            info.oneTimePassword = *otp;
+
+            if (!co_await m_squareEnixLogin->login(&info)) {
+                co_return false;
+            }
         }
     }
 
-    login(profile, profile->account()->name(), profile->account()->getPassword(), otp);
-    return true;
+    AssetUpdater assetUpdater(*profile, *this);
+    co_return co_await assetUpdater.update();
 }
 
 void LauncherCore::immediatelyLaunch(Profile *profile)
@@ -225,6 +329,50 @@ void LauncherCore::clearAvatarCache()
     }
 }
 
+void LauncherCore::prewarmConnections(Profile *profile)
+{
+    if (profile == nullptr || profile->isBenchmark() || profile->loggedIn() || m_isPatching) {
+        return;
+    }
+
+    if (profile != m_prewarmProfile) {
+        m_prewarmProfile = profile;
+        m_prewarmStarted.start();
+    }
+
+    const QString scheme = m_settings->preferredProtocol();
+
+    // The official servers use the same relaxed SSL configuration for every request
+    QNetworkRequest sslRequest;
+    Utility::setSSL(sslRequest);
+    const QSslConfiguration squareEnixConfiguration = sslRequest.sslConfiguration();
+
+    if (profile->account() != nullptr && !profile->account()->isSapphire()) {
+        warmConnection(scheme, QStringLiteral("frontier.%1").arg(m_settings->squareEnixServer()), squareEnixConfiguration);
+        warmConnection(scheme, QStringLiteral("ffxiv-login.%1").arg(m_settings->squareEnixLoginServer()), squareEnixConfiguration);
+        warmConnection(scheme, QStringLiteral("patch-gamever.%1").arg(m_settings->squareEnixServer()), squareEnixConfiguration);
+        // The boot patch server is always queried over plain HTTP
+        warmConnection(QStringLiteral("http"), QStringLiteral("patch-bootver.%1").arg(m_settings->squareEnixServer()), {});
+    }
+
+    if (profile->dalamudEnabled()) {
+        warmConnection(scheme, m_settings->dalamudDistribServer(), QSslConfiguration::defaultConfiguration());
+    }
+
+    if (!m_prewarmTimer->isActive()) {
+        m_prewarmTimer->start();
+    }
+}
+
+void LauncherCore::prestartWine(Profile *profile)
+{
+    if (profile == nullptr || profile->loggedIn() || !m_settings->prestartWineServer()) {
+        return;
+    }
+
+    m_runner->startWineServer(*profile);
+}
+
 void LauncherCore::refreshNews()
 {
     fetchNews();
@@ -442,16 +590,43 @@ SyncManager *LauncherCore::syncManager() const
 {
     return m_syncManager;
 }
+
+UploadQueue *LauncherCore::uploadQueue() const
+{
+    return m_uploadQueue;
+}
 #endif
 
 QCoro::Task<> LauncherCore::beginLogin(LoginInformation &info)
 {
+    finishPrewarming();
+
+    // There are many ways for this to stop early, and not all of them report the same error signal
+    bool launched = false;
+    const auto reportFailure = qScopeGuard([this, &launched] {
+        if (!launched) {
+            Q_EMIT loginFailed();
+        }
+    });
+
+    // Anything the background updater was in the middle of is finished first, since the login might need it
+    co_await m_backgroundUpdater->pause();
+    const auto resumeBackgroundUpdates = qScopeGuard([this] {
+        m_backgroundUpdater->resume();
+    });
+
     // Hmm, I don't think we're set up for this yet?
     if (!info.profile->isBenchmark()) {
         updateConfig(info.profile->account());
     }
 
 #ifdef BUILD_SYNC
+    // Whatever was left over from the last session has to be on the server before taking the lock, or it could be overwritten
+    if (m_settings->enableSync() && !co_await m_uploadQueue->drain(info.profile->account()->uuid())) {
+        Q_EMIT loginError(i18n("Character data from your last session hasn't been uploaded yet. Please check your connection to the sync server and try again."));
+        co_return;
+    }
+
     const auto characterSync = new CharacterSync(*info.profile->account(), *this, this);
     if (!co_await characterSync->sync()) {
         co_return;
@@ -480,7 +655,8 @@ QCoro::Task<> LauncherCore::beginLogin(LoginInformation &info)
             m_steamApi->setLauncherMode(false);
         }
 
-        m_runner->beginGameExecutable(*info.profile, auth);
+        co_await m_runner->beginGameExecutable(*info.profile, auth);
+        launched = true;
     }
 
     assetUpdater->deleteLater();
@@ -535,68 +711,84 @@ QCoro::Task<> LauncherCore::fetchNews()
     const auto document = QJsonDocument::fromJson(headlineReply->readAll());
     const auto bannerDocument = QJsonDocument::fromJson(bannerReply->readAll());
 
-    const auto headline = new Headline(this);
+    headlineReply->deleteLater();
+    bannerReply->deleteLater();
+
+    m_headline->setLoaded(true);
+
     if (document.isEmpty() || bannerDocument.isEmpty()) {
-        headline->failedToLoad = true;
-    } else {
-        const auto parseNews = [](QJsonObject object) -> News {
-            News news;
-            news.date = QDateTime::fromString(object["date"_L1].toString(), Qt::DateFormat::ISODate);
-            news.id = object["id"_L1].toString();
-            news.tag = object["tag"_L1].toString();
-            news.title = object["title"_L1].toString();
-
-            if (object["url"_L1].toString().isEmpty()) {
-                news.url = QUrl(QStringLiteral("https://na.finalfantasyxiv.com/lodestone/news/detail/%1").arg(news.id));
-            } else {
-                news.url = QUrl(object["url"_L1].toString());
-            }
+        // Keep showing whatever news we had before
+        m_headline->setFailedToLoad(true);
+        co_return;
+    }
 
-            return news;
-        };
+    const auto parseNews = [](QJsonObject object) -> News {
+        News news;
+        news.date = QDateTime::fromString(object["date"_L1].toString(), Qt::DateFormat::ISODate);
+        news.id = object["id"_L1].toString();
+        news.tag = object["tag"_L1].toString();
+        news.title = object["title"_L1].toString();
 
-        for (const auto bannerObject : bannerDocument.object()["banner"_L1].toArray()) {
-            // TODO: use new order_priority and fix_order params
-            headline->banners.push_back(
-                {.link = QUrl(bannerObject.toObject()["link"_L1].toString()), .bannerImage = QUrl(bannerObject.toObject()["lsb_banner"_L1].toString())});
+        if (object["url"_L1].toString().isEmpty()) {
+            news.url = QUrl(QStringLiteral("https://na.finalfantasyxiv.com/lodestone/news/detail/%1").arg(news.id));
+        } else {
+            news.url = QUrl(object["url"_L1].toString());
         }
 
-        for (const auto newsObject : document.object()["news"_L1].toArray()) {
-            headline->news.push_back(parseNews(newsObject.toObject()));
-        }
+        return news;
+    };
 
-        for (const auto pinnedObject : document.object()["pinned"_L1].toArray()) {
-            headline->pinned.push_back(parseNews(pinnedObject.toObject()));
+    const auto parseNewsList = [&parseNews](const QJsonArray &array) -> QList<News> {
+        QList<News> list;
+        list.reserve(array.size());
+        for (const auto object : array) {
+            list.push_back(parseNews(object.toObject()));
         }
+        return list;
+    };
 
-        for (const auto pinnedObject : document.object()["topics"_L1].toArray()) {
-            headline->topics.push_back(parseNews(pinnedObject.toObject()));
-        }
+    QList<Banner> banners;
+    for (const auto bannerObject : bannerDocument.object()["banner"_L1].toArray()) {
+        // TODO: use new order_priority and fix_order params
+        banners.push_back(
+            {.link = QUrl(bannerObject.toObject()["link"_L1].toString()), .bannerImage = QUrl(bannerObject.toObject()["lsb_banner"_L1].toString())});
     }
 
-    m_headline = headline;
-    Q_EMIT newsChanged();
+    m_headline->setFailedToLoad(false);
+    m_headline->banners()->setBanners(banners);
+    m_headline->news()->setNews(parseNewsList(document.object()["news"_L1].toArray()));
+    m_headline->pinned()->setNews(parseNewsList(document.object()["pinned"_L1].toArray()));
+    m_headline->topics()->setNews(parseNewsList(document.object()["topics"_L1].toArray()));
 }
 
 QCoro::Task<> LauncherCore::handleGameExit(const Profile *profile)
 {
-    qCDebug(ASTRA_LOG) << "Game has closed.";
+    qDebug(ASTRA_LOG) << "Game has closed.";
 
     uninhibitSleep();
 
+    // Any wineserver started ahead of time was for this session, and shouldn't outlive it
+    m_runner->stopWineServer();
+
 #ifdef BUILD_SYNC
-    // TODO: once we have Steam API support we can tell Steam to delay putting the Deck to sleep until our upload is complete
+    // The upload is only recorded here, and happens in the background. It's retried if it fails, even after restarting.
     if (m_settings->enableSync()) {
-        Q_EMIT showWindow();
-
-        qCDebug(ASTRA_LOG) << "Game closed! Uploading character data...";
-        const auto characterSync = new CharacterSync(*profile->account(), *this, this);
-        co_await characterSync->sync(false);
-
-        // Tell the user they can now quit.
-        Q_EMIT stageChanged(i18n("You may now safely close the game."));
-
-        co_return;
+        qDebug(ASTRA_LOG) << "Game closed! Queueing character data upload...";
+        const QString accountUuid = profile->account()->uuid();
+        m_uploadQueue->enqueue(accountUuid);
+
+        // Give this session's upload one try before quitting, if it's still around then it's picked up next time.
+        // Anything else left in the queue is waiting to be retried later, so it isn't waited for.
+        if (m_settings->closeWhenLaunched()) {
+            QTimer::singleShot(quitUploadTimeout, this, [] {
+                qWarning(ASTRA_LOG) << "Character data upload is taking too long, quitting anyway";
+                QCoreApplication::exit();
+            });
+
+            co_await m_uploadQueue->drain(accountUuid);
+            QCoreApplication::exit();
+            co_return;
+        }
     }
 #endif
     // Otherwise, quit when everything is finished.
@@ -607,6 +799,42 @@ QCoro::Task<> LauncherCore::handleGameExit(const Profile *profile)
     co_return;
 }
 
+#ifdef BUILD_SYNC
+QCoro::Task<bool> LauncherCore::uploadCharacterData(const QString &accountUuid)
+{
+    const auto account = m_accountManager->getByUuid(accountUuid);
+    if (!account) {
+        // The account was removed since, so there's nothing to upload anymore
+        co_return true;
+    }
+
+    qDebug(ASTRA_LOG) << "Uploading character data for" << account->name();
+
+    CharacterSync characterSync(*account, *this);
+    co_return co_await characterSync.sync(false);
+}
+#endif
+
+std::optional<QString> LauncherCore::storedOneTimePassword(Account &account)
+{
+    if (!account.useOTP()) {
+        return QString();
+    }
+
+    if (!account.rememberOTP()) {
+        Q_EMIT loginError(i18n("This account does not have an OTP secret set, but requires it for login."));
+        return std::nullopt;
+    }
+
+    const QString otp = account.getOTP();
+    if (otp.isEmpty()) {
+        Q_EMIT loginError(i18n("Failed to generate OTP, review the stored secret."));
+        return std::nullopt;
+    }
+
+    return otp;
+}
+
 void LauncherCore::updateConfig(const Account *account)
 {
     const auto configDir = account->getConfigDir().absoluteFilePath(QStringLiteral("FFXIV.cfg"));
@@ -642,6 +870,51 @@ void LauncherCore::updateConfig(const Account *account)
     file.close();
 }
 
+void LauncherCore::warmConnection(const QString &scheme, const QString &host, const QSslConfiguration &sslConfiguration)
+{
+    const QString key = QStringLiteral("%1://%2").arg(scheme, host);
+
+    // Don't reconnect if the existing connection is still alive
+    if (const auto it = m_warmConnections.constFind(key); it != m_warmConnections.cend() && it->age.durationElapsed() < prewarmLifetime) {
+        return;
+    }
+
+    qDebug(ASTRA_HTTP) << "Pre-connecting to" << key;
+
+    WarmConnection connection;
+    connection.age.start();
+    m_warmConnections.insert(key, connection);
+
+    if (scheme == "https"_L1) {
+        m_mgr->connectToHostEncrypted(host, 443, sslConfiguration);
+    } else {
+        m_mgr->connectToHost(host, 80);
+    }
+}
+
+void LauncherCore::finishPrewarming()
+{
+    m_prewarmTimer->stop();
+    m_prewarmProfile = nullptr;
+
+    // This is how long connecting took ahead of time, which is only an upper bound on what the login saves,
+    // since it can't tell whether the login actually reused these connections
+    qint64 connectTime = 0;
+    int warmHosts = 0;
+    for (const auto &connection : std::as_const(m_warmConnections)) {
+        if (connection.connectTime >= 0 && connection.age.durationElapsed() < prewarmLifetime) {
+            connectTime += connection.connectTime;
+            warmHosts++;
+        }
+    }
+
+    if (warmHosts > 0) {
+        qInfo(ASTRA_LOG) << "Logging in with" << warmHosts << "pre-warmed connections, which took" << connectTime << "ms to set up ahead of time";
+    }
+
+    m_warmConnections.clear();
+}
+
 void LauncherCore::inhibitSleep()
 {
 #ifdef HAS_DBUS
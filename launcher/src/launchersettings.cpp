@@ -188,6 +188,20 @@ void LauncherSettings::setEnableRenderDocCapture(const bool value)
     }
 }
 
+int LauncherSettings::resourceSamplingInterval() const
+{
+    return m_config->resourceSamplingInterval();
+}
+
+void LauncherSettings::setResourceSamplingInterval(const int value)
+{
+    if (m_config->resourceSamplingInterval() != value) {
+        m_config->setResourceSamplingInterval(value);
+        m_config->save();
+        Q_EMIT resourceSamplingIntervalChanged();
+    }
+}
+
 QString LauncherSettings::currentProfile() const
 {
     return KSharedConfig::openStateConfig()->group(QStringLiteral("General")).readEntry(QStringLiteral("CurrentProfile"));
@@ -214,6 +228,62 @@ void LauncherSettings::setEnableSync(const bool enabled)
     }
 }
 
+bool LauncherSettings::enableBackgroundUpdates() const
+{
+    return m_config->enableBackgroundUpdates();
+}
+
+void LauncherSettings::setEnableBackgroundUpdates(const bool enabled)
+{
+    if (m_config->enableBackgroundUpdates() != enabled) {
+        m_config->setEnableBackgroundUpdates(enabled);
+        m_config->save();
+        Q_EMIT enableBackgroundUpdatesChanged();
+    }
+}
+
+int LauncherSettings::backgroundUpdateInterval() const
+{
+    return m_config->backgroundUpdateInterval();
+}
+
+void LauncherSettings::setBackgroundUpdateInterval(const int value)
+{
+    if (m_config->backgroundUpdateInterval() != value) {
+        m_config->setBackgroundUpdateInterval(value);
+        m_config->save();
+        Q_EMIT backgroundUpdateIntervalChanged();
+    }
+}
+
+int LauncherSettings::backgroundUpdateSpeedLimit() const
+{
+    return m_config->backgroundUpdateSpeedLimit();
+}
+
+void LauncherSettings::setBackgroundUpdateSpeedLimit(const int value)
+{
+    if (m_config->backgroundUpdateSpeedLimit() != value) {
+        m_config->setBackgroundUpdateSpeedLimit(value);
+        m_config->save();
+        Q_EMIT backgroundUpdateSpeedLimitChanged();
+    }
+}
+
+bool LauncherSettings::prestartWineServer() const
+{
+    return m_config->prestartWineServer();
+}
+
+void LauncherSettings::setPrestartWineServer(const bool enabled)
+{
+    if (m_config->prestartWineServer() != enabled) {
+        m_config->setPrestartWineServer(enabled);
+        m_config->save();
+        Q_EMIT prestartWineServerChanged();
+    }
+}
+
 Config *LauncherSettings::config()
 {
     return m_config;
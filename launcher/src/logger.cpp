@@ -11,31 +11,149 @@
 #include <QMutexLocker>
 #include <QStandardPaths>
 #include <QtLogging>
-#include <iostream>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
 
+// How many messages can be waiting to be written, this has to be a power of two
+constexpr size_t queueSize = 4096;
+
+// Set on the writer thread, which can't wait on itself
+thread_local bool isWriterThread = false;
+
+/// A bounded queue that any thread can push to without taking a lock, but only one thread can pop from.
+/// This is Dmitry Vyukov's bounded MPMC queue, simplified for a single consumer.
+class MessageQueue
+{
+public:
+    MessageQueue()
+    {
+        for (size_t i = 0; i < queueSize; i++) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// \return False if the queue is full.
+    bool push(QByteArray &message)
+    {
+        size_t position = m_pushPosition.load(std::memory_order_relaxed);
+        Slot *slot = nullptr;
+        while (true) {
+            slot = &m_slots[position & (queueSize - 1)];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                // The slot is free, try to claim it before another thread does
+                if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = m_pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->message = std::move(message);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// \return False if the queue is empty. This must only be called from one thread.
+    bool pop(QByteArray &message)
+    {
+        Slot &slot = m_slots[m_popPosition & (queueSize - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != m_popPosition + 1) {
+            return false;
+        }
+
+        message = std::move(slot.message);
+        slot.sequence.store(m_popPosition + queueSize, std::memory_order_release);
+        m_popPosition++;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        QByteArray message;
+    };
+
+    std::array<Slot, queueSize> m_slots;
+    alignas(64) std::atomic<size_t> m_pushPosition = 0;
+    alignas(64) size_t m_popPosition = 0;
+};
+
+/// Messages are formatted on the thread that logged them, but written to the log file and the console on a separate thread.
+/// That way logging doesn't stall anything with syscalls, like the patcher's worker threads.
 class Logger
 {
 public:
+    ~Logger()
+    {
+        shutdown();
+    }
+
     void log(const QtMsgType type, const QMessageLogContext &context, const QString &message)
     {
-        const QString formattedMsg = qFormatLogMessage(type, context, message);
+        QByteArray formattedMsg = qFormatLogMessage(type, context, message).toUtf8();
+        formattedMsg += '\n';
 
-        if (file.isOpen()) {
-            QMutexLocker locker(&mutex);
-            QByteArray buf;
-            QTextStream str(&buf);
+        if (isWriterThread) {
+            write(formattedMsg);
+            return;
+        }
 
-            str << formattedMsg << QStringLiteral("\n");
-            str.flush();
-            file.write(buf.constData(), buf.size());
-            file.flush();
+        // This is counted before checking if it's running, so shutdown() can wait for it to land in the queue
+        m_pushing.fetch_add(1);
+        if (!m_running.load()) {
+            m_pushing.fetch_sub(1);
+            write(formattedMsg);
+            return;
+        }
+
+        // If the writer can't keep up, wait for it instead of losing anything
+        while (!m_queue.push(formattedMsg)) {
+            wakeWriter();
+            std::this_thread::yield();
         }
 
-        std::cout << formattedMsg.toStdString() << std::endl;
+        m_pushing.fetch_sub(1);
+        wakeWriter();
     }
 
-    void initialize()
+    /// Writes everything that's still queued, and stops the writer thread. Anything logged after this is written right away.
+    void shutdown()
     {
+        // Only a fatal message does this, right before aborting. Nothing else pops from the queue, so it's safe to finish it here.
+        if (isWriterThread) {
+            m_running.store(false);
+            writeQueued();
+            return;
+        }
+
+        if (!m_running.exchange(false)) {
+            return;
+        }
+
+        m_stopping.store(true, std::memory_order_release);
+        wakeWriter();
+        m_writer.join();
+
+        // Anything that was pushed while it was stopping. The queue is emptied while waiting, in case someone is stuck on a full one.
+        while (m_pushing.load() > 0) {
+            writeQueued();
+            std::this_thread::yield();
+        }
+        writeQueued();
+    }
+
+    void initialize(FILE *console)
+    {
+        m_console = console;
+
         const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
         const QDir logDirectory = dataDir.absoluteFilePath(QStringLiteral("log"));
         Utility::createPathIfNeeded(logDirectory);
@@ -78,18 +196,96 @@ public:
         }
 
         file.setFileName(logDirectory.absoluteFilePath(QStringLiteral("astra.0.log")));
-        file.open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+        file.open(QIODevice::WriteOnly);
+
+        m_running = true;
+        m_writer = std::thread(&Logger::writeMessages, this);
     }
 
 private:
-    QMutex mutex;
+    void wakeWriter()
+    {
+        m_pending.fetch_add(1, std::memory_order_release);
+        m_pending.notify_one();
+    }
+
+    /// Writes everything that's in the queue right now. This must only be called from one thread at a time.
+    void writeQueued()
+    {
+        QByteArray batch;
+        QByteArray message;
+        while (m_queue.pop(message)) {
+            batch += message;
+        }
+        write(batch);
+    }
+
+    void writeMessages()
+    {
+        isWriterThread = true;
+
+        while (true) {
+            // Sleep until something is logged
+            if (m_pending.exchange(0, std::memory_order_acquire) == 0) {
+                if (m_stopping.load(std::memory_order_acquire)) {
+                    break;
+                }
+
+                m_pending.wait(0, std::memory_order_acquire);
+                continue;
+            }
+
+            // Everything that's queued up so far is written at once
+            writeQueued();
+        }
+
+        writeQueued();
+    }
+
+    void write(const QByteArray &data)
+    {
+        if (data.isEmpty()) {
+            return;
+        }
+
+        // This is usually only called from the writer thread, except while starting up or shutting down.
+        // Writing can log something too, which is written right away on the writer thread, so this has to be recursive.
+        QMutexLocker locker(&mutex);
+
+        if (file.isOpen()) {
+            file.write(data);
+            file.flush();
+        }
+
+        std::fwrite(data.constData(), 1, data.size(), m_console);
+        std::fflush(m_console);
+    }
+
+    QRecursiveMutex mutex;
     QFile file;
+    FILE *m_console = stdout;
+
+    MessageQueue m_queue;
+    std::thread m_writer;
+    std::atomic_bool m_running = false;
+    std::atomic_bool m_stopping = false;
+    std::atomic<int> m_pushing = 0;
+    std::atomic<quint32> m_pending = 0;
 };
 
 Q_GLOBAL_STATIC(Logger, logger)
 
 void handler(const QtMsgType type, const QMessageLogContext &context, const QString &message)
 {
+    // Something can still log while the program is exiting, after the logger is gone
+    if (logger.isDestroyed()) {
+        std::fputs(qUtf8Printable(qFormatLogMessage(type, context, message) + QLatin1Char('\n')), stderr);
+        if (type == QtFatalMsg) {
+            abort();
+        }
+        return;
+    }
+
     switch (type) {
     case QtDebugMsg:
     case QtInfoMsg:
@@ -99,12 +295,14 @@ void handler(const QtMsgType type, const QMessageLogContext &context, const QStr
         break;
     case QtFatalMsg:
         logger()->log(QtCriticalMsg, context, message);
+        // Make sure everything gets written before aborting
+        logger()->shutdown();
         abort();
     }
 }
 
-void initializeLogging()
+void initializeLogging(FILE *console)
 {
-    logger()->initialize();
+    logger()->initialize(console);
     qInstallMessageHandler(handler);
 }
\ No newline at end of file
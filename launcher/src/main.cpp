@@ -15,6 +15,10 @@
 #endif
 
 #include "astra-version.h"
+#ifdef HAS_DBUS
+#include "dbusinterface.h"
+#endif
+#include "headlesslauncher.h"
 #include "launchercore.h"
 #include "logger.h"
 #include "physis_logger.h"
@@ -22,28 +26,8 @@
 
 using namespace Qt::StringLiterals;
 
-int main(int argc, char *argv[])
+static KAboutData aboutData()
 {
-#ifdef HAVE_WEBVIEW
-    QtWebView::initialize();
-#endif
-
-    KIconTheme::initTheme();
-
-    const QGuiApplication app(argc, argv);
-
-    const KDSingleApplication singleApplication;
-    if (!singleApplication.isPrimaryInstance()) {
-        return 0;
-    }
-
-    // Default to a sensible message pattern
-    if (qEnvironmentVariableIsEmpty("QT_MESSAGE_PATTERN")) {
-        qputenv("QT_MESSAGE_PATTERN", "[%{time yyyy-MM-dd h:mm:ss.zzz}] %{if-category}[%{category}] %{endif}[%{type}] %{message}");
-    }
-
-    KLocalizedString::setApplicationDomain("astra");
-
     KAboutData about(QStringLiteral("astra"),
                      i18n("Astra"),
                      QStringLiteral(ASTRA_VERSION_STRING),
@@ -86,6 +70,128 @@ int main(int argc, char *argv[])
     about.setProgramLogo(QStringLiteral("zone.xiv.astra"));
     about.setOrganizationDomain(QByteArrayLiteral("xiv.zone"));
 
+    return about;
+}
+
+/// \return True if any of the headless options were given, so none of the UI has to be loaded.
+static bool isHeadless(const int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        const QByteArrayView argument(argv[i]);
+        for (const auto option : {"--update", "--all", "--verify", "--launch"}) {
+            if (argument == option || argument.startsWith(QByteArray(option) + '=')) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static void addHeadlessOptions(QCommandLineParser &parser)
+{
+    parser.addOption(QCommandLineOption(QStringLiteral("update"),
+                                        i18n("Update a profile without launching it, by name or UUID. Can be given more than once."),
+                                        QStringLiteral("profile")));
+    parser.addOption(QCommandLineOption(QStringLiteral("all"), i18n("Update every profile.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("verify"), i18n("Check the game installation of the profiles being updated, or every profile.")));
+    parser.addOption(
+        QCommandLineOption(QStringLiteral("launch"), i18n("Launch a profile by name or UUID, and wait until the game exits."), QStringLiteral("profile")));
+}
+
+/// Updates, checks or launches profiles without any of the UI, see HeadlessLauncher.
+static int runHeadless(int argc, char *argv[])
+{
+    const QCoreApplication app(argc, argv);
+
+    // This is the same lock the UI takes, so two launchers never patch the same installation at once
+    const KDSingleApplication singleApplication;
+
+    KLocalizedString::setApplicationDomain("astra");
+
+    KAboutData about = aboutData();
+    KAboutData::setApplicationData(about);
+
+    // Only progress goes to stdout, so it can be read by scripts
+    initializeLogging(stderr);
+    setup_physis_logging();
+
+    QCommandLineParser parser;
+    about.setupCommandLine(&parser);
+
+    addHeadlessOptions(parser);
+
+    parser.process(app);
+    about.processCommandLine(&parser);
+
+    if (!singleApplication.isPrimaryInstance()) {
+#ifdef HAS_DBUS
+        // Two launchers patching the same game at once would step on each other, so hand it over to the one that's already running.
+        // Only whether it was accepted is known here, the results are reported by that instance over D-Bus.
+        if (const auto accepted = DBusInterface::forwardArguments(QCoreApplication::arguments())) {
+            if (!*accepted) {
+                qWarning() << "The instance that's already running refused to do this, see its log for why";
+                return HeadlessLauncher::Refused;
+            }
+
+            qInfo() << "Handed over to the instance that's already running";
+            return HeadlessLauncher::Success;
+        }
+#endif
+
+        // Like another headless run, which can't be handed anything
+        qWarning() << "Another instance of the launcher is already running, try again once it's finished";
+        return HeadlessLauncher::Refused;
+    }
+
+    LauncherCore core;
+
+    HeadlessLauncher headless(core);
+    headless.start(HeadlessLauncher::Options{
+        .update = parser.values(QStringLiteral("update")),
+        .all = parser.isSet(QStringLiteral("all")),
+        .verify = parser.isSet(QStringLiteral("verify")),
+        .launch = parser.value(QStringLiteral("launch")),
+    });
+
+    return QCoreApplication::exec();
+}
+
+int main(int argc, char *argv[])
+{
+    // Default to a sensible message pattern
+    if (qEnvironmentVariableIsEmpty("QT_MESSAGE_PATTERN")) {
+        qputenv("QT_MESSAGE_PATTERN", "[%{time yyyy-MM-dd h:mm:ss.zzz}] %{if-category}[%{category}] %{endif}[%{type}] %{message}");
+    }
+
+    if (isHeadless(argc, argv)) {
+        return runHeadless(argc, argv);
+    }
+
+#ifdef HAVE_WEBVIEW
+    QtWebView::initialize();
+#endif
+
+    KIconTheme::initTheme();
+
+    const QGuiApplication app(argc, argv);
+
+    const KDSingleApplication singleApplication;
+    if (!singleApplication.isPrimaryInstance()) {
+#ifdef HAS_DBUS
+        // Let the instance that's already running bring up its window, or do what was asked of it
+        if (DBusInterface::forwardArguments(QCoreApplication::arguments())) {
+            return 0;
+        }
+#endif
+        // A headless run doesn't have a window to bring up
+        qWarning() << "Another instance of the launcher is already running";
+        return 0;
+    }
+
+    KLocalizedString::setApplicationDomain("astra");
+
+    KAboutData about = aboutData();
     KAboutData::setApplicationData(about);
 
     initializeLogging();
@@ -98,6 +204,9 @@ int main(int argc, char *argv[])
     steamOption.setFlags(QCommandLineOption::HiddenFromHelp);
     parser.addOption(steamOption);
 
+    // Only so they show up in the help, since they're handled before getting here
+    addHeadlessOptions(parser);
+
     parser.parse(QCoreApplication::arguments());
     about.processCommandLine(&parser);
 
@@ -138,6 +247,11 @@ int main(int argc, char *argv[])
         core->initializeSteam();
     }
 
+#ifdef HAS_DBUS
+    DBusInterface dbusInterface(*core);
+    dbusInterface.registerOnSessionBus();
+#endif
+
     engine.rootContext()->setContextObject(new KLocalizedContext(&engine));
     QObject::connect(&engine, &QQmlApplicationEngine::quit, &app, &QCoreApplication::quit);
 
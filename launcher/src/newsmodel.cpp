@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "newsmodel.h"
+
+NewsModel::NewsModel(QObject *parent)
+    : KeyedListModel(parent)
+{
+}
+
+QVariant NewsModel::data(const QModelIndex &index, const int role) const
+{
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    const auto &news = m_items[index.row()];
+
+    switch (role) {
+    case DateRole:
+        return news.date;
+    case IdRole:
+        return news.id;
+    case TagRole:
+        return news.tag;
+    case TitleRole:
+        return news.title;
+    case UrlRole:
+        return news.url;
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> NewsModel::roleNames() const
+{
+    return {
+        {DateRole, "date"},
+        {IdRole, "id"},
+        {TagRole, "tag"},
+        {TitleRole, "title"},
+        {UrlRole, "url"},
+    };
+}
+
+void NewsModel::setNews(const QList<News> &news)
+{
+    if (replaceItems(news, &News::id)) {
+        Q_EMIT countChanged();
+    }
+}
+
+#include "moc_newsmodel.cpp"
@@ -100,14 +100,14 @@ QCoro::Task<bool> Patcher::patch(const physis_PatchList &patchList)
 
         const int ourIndex = patchIndex++;
 
-        const QString filename = QStringLiteral("%1.patch").arg(QLatin1String(patch.version));
         const QString tempFilename = QStringLiteral("%1.patch~").arg(QLatin1String(patch.version)); // tilde afterwards to hide it easily
 
         const QString repository = Utility::repositoryFromPatchUrl(QLatin1String(patch.url));
         const QDir repositoryDir = m_patchesDir.absoluteFilePath(repository);
         Utility::createPathIfNeeded(repositoryDir);
 
-        const QString patchPath = repositoryDir.absoluteFilePath(filename);
+        // This might have already been downloaded by the BackgroundUpdater
+        const QString patchPath = Patcher::patchPath(QLatin1String(patch.url), QLatin1String(patch.version));
         const QString tempPatchPath = repositoryDir.absoluteFilePath(tempFilename);
 
         QStringList convertedHashes;
@@ -274,12 +274,21 @@ void Patcher::processPatch(const QueuedPatch &patch)
     }
 }
 
-void Patcher::setupDirectories()
+QDir Patcher::patchesDirectory()
 {
-    QDir dataDir;
-    dataDir.setPath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return dataDir.absoluteFilePath(QStringLiteral("patch"));
+}
+
+QString Patcher::patchPath(const QString &url, const QString &version)
+{
+    const QDir repositoryDir = patchesDirectory().absoluteFilePath(Utility::repositoryFromPatchUrl(url));
+    return repositoryDir.absoluteFilePath(QStringLiteral("%1.patch").arg(version));
+}
 
-    m_patchesDir.setPath(dataDir.absoluteFilePath(QStringLiteral("patch")));
+void Patcher::setupDirectories()
+{
+    m_patchesDir = patchesDirectory();
     m_patchesDirStorageInfo = QStorageInfo(m_patchesDir);
 
     m_baseDirStorageInfo = QStorageInfo(m_baseDirectory);
@@ -305,6 +314,14 @@ void Patcher::updateDownloadProgress(const int index, const int received)
 
 void Patcher::updateMessage()
 {
+    qint64 received = 0;
+    qint64 total = 0;
+    for (const auto &patch : m_patchQueue) {
+        received += patch.downloaded ? patch.length : patch.bytesDownloaded;
+        total += patch.length;
+    }
+    Q_EMIT m_launcher.downloadProgress(received, total);
+
     // Find first not-downloaded patch
     for (const auto &patch : m_patchQueue) {
         if (!patch.downloaded) {
@@ -5,29 +5,279 @@
 #include "astra_log.h"
 #include "utility.h"
 
+#include <KCompressionDevice>
+#include <QDateTime>
+#include <QFile>
 #include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+using namespace Qt::StringLiterals;
+
+// Verbose Wine output can easily be hundreds of megabytes, but nobody is reading that much
+constexpr qint64 maximumSessionSize = 32 * 1024 * 1024;
+
+// The start of a log is never overwritten, since that's where everything is set up
+constexpr qint64 headSize = 1024 * 1024;
+
+// How many previous sessions are kept for each log
+constexpr int retainedSessions = 5;
+
+constexpr auto flushInterval = std::chrono::seconds(1);
+constexpr qsizetype flushThreshold = 256 * 1024;
+
+constexpr qint64 copyChunkSize = 1024 * 1024;
+
+/// Everything is written on one thread, so the writes for each log happen in order without any locking.
+static QThreadPool *writerPool()
+{
+    static QThreadPool *pool = [] {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(1);
+        pool->setExpiryTimeout(-1);
+        return pool;
+    }();
+    return pool;
+}
+
+static QByteArray truncationMarker(const qint64 dropped)
+{
+    return QStringLiteral("\n[Astra: %1 bytes of output were dropped here, to keep this log under %2 MiB]\n")
+        .arg(dropped)
+        .arg(maximumSessionSize / 1024 / 1024)
+        .toUtf8();
+}
+
+/// Compresses the log at @p path into an archive next to it, and removes the original.
+/// If it's over the size limit, only the beginning and the end of it are kept.
+static void archiveLog(const QString &path)
+{
+    const QFileInfo info(path);
+    if (!info.exists()) {
+        return;
+    }
+
+    if (info.size() == 0) {
+        QFile::remove(path);
+        return;
+    }
+
+    // Sessions can end within the same millisecond, like when the game fails to start, so the name is made unique if needed
+    const QString timestamp = info.lastModified().toString(QStringLiteral("yyyyMMdd-HHmmss-zzz"));
+    QString archiveBase = info.absoluteDir().absoluteFilePath(QStringLiteral("%1.%2.log").arg(info.completeBaseName(), timestamp));
+    for (int i = 1; QFile::exists(archiveBase + QStringLiteral(".zst")) || QFile::exists(archiveBase + QStringLiteral(".gz")); i++) {
+        archiveBase = info.absoluteDir().absoluteFilePath(QStringLiteral("%1.%2-%3.log").arg(info.completeBaseName(), timestamp).arg(i));
+    }
+
+    QFile input(path);
+    if (!input.open(QIODevice::ReadOnly)) {
+        qWarning(ASTRA_LOG) << "Failed to archive" << path << input.errorString();
+        return;
+    }
+
+    // Not every build of KArchive has zstd, but they all have gzip
+    QString archivePath = archiveBase + QStringLiteral(".zst");
+    auto output = std::make_unique<KCompressionDevice>(archivePath, KCompressionDevice::Zstd);
+    if (!output->open(QIODevice::WriteOnly)) {
+        archivePath = archiveBase + QStringLiteral(".gz");
+        output = std::make_unique<KCompressionDevice>(archivePath, KCompressionDevice::GZip);
+        if (!output->open(QIODevice::WriteOnly)) {
+            qWarning(ASTRA_LOG) << "Failed to archive" << path << output->errorString();
+            return;
+        }
+    }
+
+    const auto copy = [&input, &output](qint64 length) {
+        while (length > 0) {
+            const QByteArray data = input.read(std::min(length, copyChunkSize));
+            if (data.isEmpty()) {
+                return false;
+            }
+            if (output->write(data) != data.size()) {
+                return false;
+            }
+            length -= data.size();
+        }
+        return true;
+    };
+
+    bool success = true;
+    if (input.size() > maximumSessionSize) {
+        const qint64 tailSize = maximumSessionSize - headSize;
+        const QByteArray marker = truncationMarker(input.size() - maximumSessionSize);
+        success = copy(headSize) && output->write(marker) == marker.size() && input.seek(input.size() - tailSize) && copy(tailSize);
+    } else {
+        success = copy(input.size());
+    }
+
+    // Anything still buffered by the compressor is only written out here, which can fail too
+    output->close();
+
+    // The original is kept around if anything went wrong, like running out of space, so the session isn't lost
+    if (!success || output->error() != QFileDevice::NoError) {
+        qWarning(ASTRA_LOG) << "Failed to archive" << path << (output->error() != QFileDevice::NoError ? output->errorString() : input.errorString());
+        QFile::remove(archivePath);
+        return;
+    }
+
+    QFile::remove(path);
+}
+
+/// Removes all but the newest archived sessions of @p baseName.
+static void pruneArchives(const QDir &directory, const QString &baseName)
+{
+    const QFileInfoList archives =
+        directory.entryInfoList({QStringLiteral("%1.*.log.zst").arg(baseName), QStringLiteral("%1.*.log.gz").arg(baseName)}, QDir::Files, QDir::Time);
+    for (qsizetype i = retainedSessions; i < archives.size(); i++) {
+        QFile::remove(archives[i].absoluteFilePath());
+    }
+}
+
+/// The log being written for one session. This is only used from the writer thread.
+struct ProcessLogger::LogFile {
+    QFile file;
+    // How much of the file is in use, until it fills up
+    qint64 size = 0;
+    // Once it's full, the space after the head is reused from the beginning
+    bool wrapped = false;
+    qint64 ringPosition = headSize;
+    qint64 dropped = 0;
+
+    void write(QByteArrayView data)
+    {
+        if (!file.isOpen()) {
+            return;
+        }
+
+        while (!data.isEmpty()) {
+            if (size < maximumSessionSize) {
+                const qint64 length = std::min<qint64>(data.size(), maximumSessionSize - size);
+                file.seek(size);
+                file.write(data.first(length));
+                size += length;
+                data = data.sliced(length);
+                continue;
+            }
+
+            wrapped = true;
+
+            const qint64 length = std::min<qint64>(data.size(), maximumSessionSize - ringPosition);
+            file.seek(ringPosition);
+            file.write(data.first(length));
+            dropped += length;
+            data = data.sliced(length);
+
+            ringPosition += length;
+            if (ringPosition == maximumSessionSize) {
+                ringPosition = headSize;
+            }
+        }
+
+        file.flush();
+    }
+
+    /// Puts the wrapped part of the log back in order, so it reads from the oldest to the newest output.
+    void finish()
+    {
+        if (!file.isOpen()) {
+            return;
+        }
+
+        if (wrapped) {
+            file.seek(ringPosition);
+            const QByteArray oldest = file.read(maximumSessionSize - ringPosition);
+            file.seek(headSize);
+            const QByteArray newest = file.read(ringPosition - headSize);
+
+            file.seek(headSize);
+            file.write(truncationMarker(dropped));
+            file.write(oldest);
+            file.write(newest);
+            file.resize(file.pos());
+        }
+
+        file.close();
+    }
+};
 
 ProcessLogger::ProcessLogger(const QString &baseName, QProcess *process)
+    : m_file(std::make_shared<LogFile>())
 {
-    const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    const QDir logDirectory = dataDir.absoluteFilePath(QStringLiteral("log"));
+    const QDir logDirectory = ProcessLogger::logDirectory();
+    Utility::createPathIfNeeded(logDirectory);
 
-    m_file.setFileName(logDirectory.absoluteFilePath(QStringLiteral("%1.log").arg(baseName)));
-    m_file.open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+    const QString path = logDirectory.absoluteFilePath(QStringLiteral("%1.log").arg(baseName));
+
+    // The previous session is archived first, and since there's only one writer thread it's done before anything new is written
+    writerPool()->start([file = m_file, logDirectory, baseName, path] {
+        archiveLog(path);
+        pruneArchives(logDirectory, baseName);
+
+        file->file.setFileName(path);
+        if (!file->file.open(QIODevice::WriteOnly)) {
+            qWarning(ASTRA_LOG) << "Failed to open" << path << file->file.errorString();
+        }
+    });
 
     connect(process, &QProcess::readyReadStandardOutput, this, [this, process] {
-        m_file.write(process->readAllStandardOutput());
-        m_file.flush();
+        m_buffer += process->readAllStandardOutput();
+        if (m_buffer.size() >= flushThreshold) {
+            flush();
+        }
     });
 
     connect(process, &QProcess::readyReadStandardError, this, [this, process] {
-        m_file.write(process->readAllStandardError());
-        m_file.flush();
+        m_buffer += process->readAllStandardError();
+        if (m_buffer.size() >= flushThreshold) {
+            flush();
+        }
     });
 
+    m_flushTimer.setInterval(flushInterval);
+    connect(&m_flushTimer, &QTimer::timeout, this, &ProcessLogger::flush);
+    m_flushTimer.start();
+
     connect(process, &QProcess::finished, this, [this] {
-        deleteLater();
+        m_flushTimer.stop();
+        flush();
+
+        QtConcurrent::run(writerPool(), [file = m_file] {
+            file->finish();
+        }).then(this, [this] {
+            Q_EMIT finished();
+            deleteLater();
+        });
     });
 
-    qInfo(ASTRA_LOG) << "Client logs are being written to" << m_file.fileName().toUtf8().constData();
+    qInfo(ASTRA_LOG) << "Client logs are being written to" << path.toUtf8().constData();
 }
+
+QFuture<void> ProcessLogger::archiveLogs(const QStringList &nameFilters)
+{
+    return QtConcurrent::run(writerPool(), [nameFilters] {
+        const QDir directory = logDirectory();
+        for (const QFileInfo &info : directory.entryInfoList(nameFilters, QDir::Files)) {
+            archiveLog(info.absoluteFilePath());
+            pruneArchives(directory, info.completeBaseName());
+        }
+    });
+}
+
+QDir ProcessLogger::logDirectory()
+{
+    const QDir dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return dataDir.absoluteFilePath(QStringLiteral("log"));
+}
+
+void ProcessLogger::flush()
+{
+    if (m_buffer.isEmpty()) {
+        return;
+    }
+
+    writerPool()->start([file = m_file, data = std::exchange(m_buffer, {})] {
+        file->write(data);
+    });
+}
+
+#include "moc_processlogger.cpp"
@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "processtreetracker.h"
+#include "astra_log.h"
+
+#include <QDir>
+#include <QUuid>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+using namespace Qt::StringLiterals;
+
+static const QString sessionVariable = QStringLiteral("ASTRA_SESSION_ID");
+
+/// \return The value of @p field in /proc/<pid>/io, or -1 if it can't be read.
+static qint64 ioField(const QByteArray &io, const QByteArrayView field)
+{
+    const QList<QByteArray> lines = io.split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith(field) && line.size() > field.size() && line[field.size()] == ':') {
+            return line.sliced(field.size() + 1).trimmed().toLongLong();
+        }
+    }
+
+    return -1;
+}
+
+ProcessTreeTracker::ProcessTreeTracker(QObject *parent)
+    : QObject(parent)
+    , m_sessionId(QUuid::createUuid().toString(QUuid::WithoutBraces))
+{
+    connect(&m_timer, &QTimer::timeout, this, &ProcessTreeTracker::sample);
+}
+
+void ProcessTreeTracker::addToEnvironment(QProcessEnvironment &environment) const
+{
+    environment.insert(sessionVariable, m_sessionId);
+}
+
+void ProcessTreeTracker::startSampling(const QString &path, const std::chrono::milliseconds interval)
+{
+#if defined(Q_OS_LINUX)
+    m_timeline.setFileName(path);
+    if (!m_timeline.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning(ASTRA_LOG) << "Failed to open" << path << m_timeline.errorString();
+        return;
+    }
+
+    m_timeline.write("elapsed_ms,pid,name,cpu_ms,rss_kib,threads,read_bytes,write_bytes\n");
+    qInfo(ASTRA_LOG) << "Writing resource usage to" << path;
+
+    m_elapsed.start();
+    m_timer.setInterval(interval);
+    m_timer.start();
+#else
+    Q_UNUSED(path)
+    Q_UNUSED(interval)
+#endif
+}
+
+void ProcessTreeTracker::update()
+{
+#if defined(Q_OS_LINUX)
+    QHash<qint64, ProcessInfo> processes;
+    QHash<qint64, quint64> ignored;
+
+    const QStringList entries = QDir(QStringLiteral("/proc")).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &entry : entries) {
+        bool ok = false;
+        const qint64 pid = entry.toLongLong(&ok);
+        if (!ok) {
+            continue;
+        }
+
+        const auto info = readProcess(pid);
+        if (!info) {
+            continue;
+        }
+
+        // PIDs can be reused, so they're only the same process if they also started at the same time
+        if (const auto it = m_processes.constFind(pid); it != m_processes.cend() && it->startTime == info->startTime) {
+            processes.insert(pid, *info);
+            continue;
+        }
+
+        if (const auto it = m_ignored.constFind(pid); it != m_ignored.cend() && *it == info->startTime) {
+            ignored.insert(pid, info->startTime);
+            continue;
+        }
+
+        if (m_processes.contains(info->parentPid) || isInSession(pid)) {
+            qDebug(ASTRA_LOG) << "Found" << info->name << pid << "in the game session";
+            processes.insert(pid, *info);
+        } else {
+            ignored.insert(pid, info->startTime);
+        }
+    }
+
+    // Anything that wasn't seen this time has exited
+    m_processes = processes;
+    m_ignored = ignored;
+#endif
+}
+
+std::optional<qint64> ProcessTreeTracker::findProcess(const QString &name)
+{
+    update();
+
+    std::optional<ProcessInfo> newest;
+    for (const ProcessInfo &info : std::as_const(m_processes)) {
+        if (info.name.contains(name) && (!newest || info.startTime > newest->startTime)) {
+            newest = info;
+        }
+    }
+
+    if (newest) {
+        return newest->pid;
+    }
+
+    return std::nullopt;
+}
+
+QList<qint64> ProcessTreeTracker::processes() const
+{
+    return m_processes.keys();
+}
+
+void ProcessTreeTracker::stop()
+{
+    if (!m_timer.isActive()) {
+        return;
+    }
+
+    sample();
+    m_timer.stop();
+    m_timeline.close();
+
+#if defined(Q_OS_LINUX)
+    qInfo(ASTRA_LOG) << "Game session used at most" << m_peakResidentPages * sysconf(_SC_PAGESIZE) / 1024 / 1024 << "MiB of memory";
+#endif
+}
+
+std::optional<ProcessTreeTracker::ProcessInfo> ProcessTreeTracker::readProcess(const qint64 pid)
+{
+    QFile file(QStringLiteral("/proc/%1/stat").arg(pid));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    // The name is in parentheses and can have spaces (or parentheses) in it, so everything is split after the last one
+    const QByteArray stat = file.readAll();
+    const qsizetype nameStart = stat.indexOf('(');
+    const qsizetype nameEnd = stat.lastIndexOf(')');
+    if (nameStart == -1 || nameEnd < nameStart) {
+        return std::nullopt;
+    }
+
+    // This starts at the third field (the state), see proc_pid_stat(5)
+    const QList<QByteArray> fields = stat.sliced(nameEnd + 2).split(' ');
+    if (fields.size() < 22) {
+        return std::nullopt;
+    }
+
+    return ProcessInfo{
+        .pid = pid,
+        .parentPid = fields[1].toLongLong(),
+        .startTime = fields[19].toULongLong(),
+        .name = QString::fromUtf8(stat.sliced(nameStart + 1, nameEnd - nameStart - 1)),
+        .cpuTicks = fields[11].toULongLong() + fields[12].toULongLong(),
+        .residentPages = fields[21].toLongLong(),
+        .threads = fields[17].toLongLong(),
+    };
+}
+
+bool ProcessTreeTracker::isInSession(const qint64 pid) const
+{
+    // Only readable for our own processes, which is fine since those are the only ones we start
+    QFile file(QStringLiteral("/proc/%1/environ").arg(pid));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // Each variable ends with a null byte
+    const QByteArray environment = '\0' + file.readAll();
+    const QByteArray variable = '\0' + sessionVariable.toLatin1() + '=' + m_sessionId.toLatin1() + '\0';
+
+    return environment.contains(variable);
+}
+
+void ProcessTreeTracker::sample()
+{
+#if defined(Q_OS_LINUX)
+    update();
+
+    static const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+
+    const qint64 elapsed = m_elapsed.elapsed();
+    qint64 residentPages = 0;
+
+    for (const ProcessInfo &info : std::as_const(m_processes)) {
+        residentPages += info.residentPages;
+
+        // This isn't always readable, like for processes that changed their credentials
+        QByteArray io;
+        QFile ioFile(QStringLiteral("/proc/%1/io").arg(info.pid));
+        if (ioFile.open(QIODevice::ReadOnly)) {
+            io = ioFile.readAll();
+        }
+
+        QString name = info.name;
+        name.replace(','_L1, '_'_L1);
+
+        m_timeline.write(QStringLiteral("%1,%2,%3,%4,%5,%6,%7,%8\n")
+                             .arg(elapsed)
+                             .arg(info.pid)
+                             .arg(name)
+                             .arg(info.cpuTicks * 1000 / ticksPerSecond)
+                             .arg(info.residentPages * pageSize / 1024)
+                             .arg(info.threads)
+                             .arg(ioField(io, "read_bytes"))
+                             .arg(ioField(io, "write_bytes"))
+                             .toUtf8());
+    }
+
+    m_peakResidentPages = std::max(m_peakResidentPages, residentPages);
+    m_timeline.flush();
+#endif
+}
+
+#include "moc_processtreetracker.cpp"
@@ -2,24 +2,84 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "processwatcher.h"
+#include "astra_log.h"
 
 #include <KProcessList>
+#include <QSocketNotifier>
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <cstring>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "moc_processwatcher.cpp"
 
 ProcessWatcher::ProcessWatcher(const qint64 PID, QObject *parent)
     : QObject(parent)
 {
+    if (watchPidfd(PID)) {
+        return;
+    }
+
     m_timer = new QTimer(this);
     connect(m_timer, &QTimer::timeout, this, [this, PID] {
         const auto info = KProcessList::processInfo(PID);
         // If we can't find the PID, bail!
         if (!info.isValid()) {
-            m_timer->stop();
-            deleteLater();
-            Q_EMIT finished();
+            finish();
         }
     });
     m_timer->setInterval(std::chrono::seconds(5));
     m_timer->start();
-}
\ No newline at end of file
+}
+
+ProcessWatcher::~ProcessWatcher()
+{
+#if defined(Q_OS_LINUX)
+    if (m_pidfd != -1) {
+        close(m_pidfd);
+    }
+#endif
+}
+
+bool ProcessWatcher::watchPidfd(const qint64 PID)
+{
+#if defined(Q_OS_LINUX) && defined(SYS_pidfd_open)
+    m_pidfd = static_cast<int>(syscall(SYS_pidfd_open, static_cast<pid_t>(PID), 0));
+    if (m_pidfd == -1) {
+        // The process is already gone, but nobody is listening yet
+        if (errno == ESRCH) {
+            QMetaObject::invokeMethod(this, &ProcessWatcher::finish, Qt::QueuedConnection);
+            return true;
+        }
+
+        // Usually because the kernel is older than 5.3
+        qDebug(ASTRA_LOG) << "pidfd_open isn't available, falling back to polling:" << strerror(errno);
+        return false;
+    }
+
+    // A pidfd becomes readable once the process exits
+    m_notifier = new QSocketNotifier(m_pidfd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &ProcessWatcher::finish);
+
+    return true;
+#else
+    Q_UNUSED(PID)
+    return false;
+#endif
+}
+
+void ProcessWatcher::finish()
+{
+    if (m_timer) {
+        m_timer->stop();
+    }
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+    }
+
+    deleteLater();
+    Q_EMIT finished();
+}
@@ -40,6 +40,20 @@ Profile *ProfileManager::getProfileByUUID(const QString &uuid)
     return nullptr;
 }
 
+Profile *ProfileManager::getProfileByNameOrUUID(const QString &nameOrUuid)
+{
+    if (const auto profile = getProfileByUUID(nameOrUuid)) {
+        return profile;
+    }
+
+    for (const auto &m_profile : m_profiles) {
+        if (m_profile->name() == nameOrUuid)
+            return m_profile;
+    }
+
+    return nullptr;
+}
+
 Profile *ProfileManager::addProfile()
 {
     const auto newProfile = new Profile(QUuid::createUuid().toString(), this);
@@ -5,6 +5,7 @@
 
 #include <KLocalizedString>
 #include <QDesktopServices>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QNetworkReply>
 #include <QRegularExpressionMatch>
@@ -27,6 +28,26 @@ const QByteArray macosPatchUserAgent = QByteArrayLiteral("FFXIV-MAC PATCH CLIEN"
 
 using namespace Qt::StringLiterals;
 
+/// Logs how long a login stage took, once it goes out of scope.
+class StageTimer
+{
+public:
+    explicit StageTimer(const char *name)
+        : m_name(name)
+    {
+        m_timer.start();
+    }
+
+    ~StageTimer()
+    {
+        qInfo(ASTRA_LOG) << "Login stage" << m_name << "took" << m_timer.elapsed() << "ms";
+    }
+
+private:
+    const char *m_name;
+    QElapsedTimer m_timer;
+};
+
 SquareEnixLogin::SquareEnixLogin(LauncherCore &window, QObject *parent)
     : QObject(parent)
     , m_launcher(window)
@@ -37,46 +58,79 @@ QCoro::Task<std::optional<LoginAuth>> SquareEnixLogin::login(LoginInformation *i
 {
     Q_ASSERT(info != nullptr);
     m_info = info;
+    m_gameHasPatched = false;
+    m_hasReportedError = false;
+    m_speculativeReplies.clear();
 
-    // First, let's check for boot updates. While not technically required for us, it's needed for later hash checking.
-    // It's also a really good idea anyway, in case the official launcher is needed.
-    while (m_lastRunHasPatched) {
-        // There seems to be a limitation in their boot patching system.
-        // Their server can only give one patch a time, so the boot process must keep trying to patch until
-        // there is no patches left.
-        if (!co_await checkBootUpdates()) {
-            co_return std::nullopt;
-        }
-    }
+    const StageTimer timer("total");
+
+    // A lot of these stages don't depend on each other, so their requests are started at the same time:
+    // - The boot patch list is only needed for the hash check when registering the session.
+    // - The login status check and the _STORED_ page are independent of everything else.
+    // They're still awaited (and their stages shown) in the same order as before, and anything speculative is aborted if an earlier stage fails.
+    const auto bootPatchListReply = requestBootPatchList();
+    trackSpeculativeReply(bootPatchListReply);
+    auto loginStatusTask = checkLoginStatus();
+    auto storedTask = getStoredValue();
 
     // Then check if we can even login.
-    if (!co_await checkLoginStatus()) {
+    Q_EMIT m_launcher.stageChanged(i18n("Checking login..."));
+    if (const auto loginError = co_await loginStatusTask; loginError.has_value()) {
+        reportError(*loginError);
+        abortSpeculativeRequests();
+        co_await storedTask;
+        co_return std::nullopt;
+    }
+
+    Q_EMIT m_launcher.stageChanged(i18n("Logging in..."));
+    const auto storedInfo = co_await storedTask;
+    if (storedInfo == std::nullopt) {
+        abortSpeculativeRequests();
         co_return std::nullopt;
     }
 
     // Login with through the oauth API. This gives us some information like a temporary SID, region and expansion information
-    if (!co_await loginOAuth()) {
+    if (!co_await loginOAuth(*storedInfo)) {
+        abortSpeculativeRequests();
         co_return std::nullopt;
     }
 
-    // Register the session with the server. This method also updates the game as necessary.
-    if (!co_await registerSession()) {
+    // Only now that logging in worked are the boot components actually patched, so nothing is touched on disk if it was going to fail anyway.
+    // They must be up to date before registering the session, since their hashes are sent.
+    if (!co_await updateBootComponents(bootPatchListReply)) {
         co_return std::nullopt;
     }
 
     // Finally, double check the *world* status to make sure we don't try to log in during maintenance.
+    // This is started alongside the session registration, but if the game had to be patched the result is thrown away and checked again.
     // Doing it late here ensures we handle cases where the patch is available during maintenance (like during expansion launches)
     // but stops before trying to log in when you're not supposed to.
-    if (!co_await checkGateStatus()) {
+    auto gateTask = checkGateStatus();
+
+    // Register the session with the server. This method also updates the game as necessary.
+    if (!co_await registerSession()) {
+        abortSpeculativeRequests();
+        co_await gateTask;
+        co_return std::nullopt;
+    }
+
+    auto gateError = co_await gateTask;
+    if (m_gameHasPatched) {
+        gateError = co_await checkGateStatus();
+    }
+
+    if (gateError.has_value()) {
+        reportError(*gateError);
         co_return std::nullopt;
     }
 
     co_return m_auth;
 }
 
-QCoro::Task<bool> SquareEnixLogin::checkGateStatus() const
+QCoro::Task<std::optional<QString>> SquareEnixLogin::checkGateStatus()
 {
-    Q_EMIT m_launcher.stageChanged(i18n("Checking gate..."));
+    const StageTimer timer("gate status");
+
     qInfo(ASTRA_LOG) << "Checking if the gate is open...";
 
     QUrl url;
@@ -94,30 +148,30 @@ QCoro::Task<bool> SquareEnixLogin::checkGateStatus() const
 
     const auto reply = m_launcher.mgr()->get(request);
     m_launcher.setupIgnoreSSL(reply);
+    trackSpeculativeReply(reply);
     co_await reply;
 
     const QJsonDocument document = QJsonDocument::fromJson(reply->readAll());
     if (document.isEmpty()) {
-        Q_EMIT m_launcher.loginError(i18n("An error occured when checking login gate status:\n\n%1", reply->errorString()));
-        co_return false;
+        co_return i18n("An error occured when checking login gate status:\n\n%1", reply->errorString());
     }
 
     const bool isGateOpen = !document.isEmpty() && document.object()["status"_L1].toInt() != 0;
 
     if (isGateOpen) {
         qInfo(ASTRA_LOG) << "Gate is open!";
-        co_return true;
+        co_return std::nullopt;
     }
 
     qInfo(ASTRA_LOG) << "Gate is closed!";
-    Q_EMIT m_launcher.loginError(i18n("The login gate is closed, the game may be under maintenance."));
 
-    co_return false;
+    co_return i18n("The login gate is closed, the game may be under maintenance.");
 }
 
-QCoro::Task<bool> SquareEnixLogin::checkLoginStatus() const
+QCoro::Task<std::optional<QString>> SquareEnixLogin::checkLoginStatus()
 {
-    Q_EMIT m_launcher.stageChanged(i18n("Checking login..."));
+    const StageTimer timer("login status");
+
     qInfo(ASTRA_LOG) << "Checking if login is open...";
 
     QUrl url;
@@ -142,43 +196,50 @@ QCoro::Task<bool> SquareEnixLogin::checkLoginStatus() const
 
     if (isGateOpen) {
         qInfo(ASTRA_LOG) << "Login is open!";
-        co_return true;
+        co_return std::nullopt;
     } else {
         qInfo(ASTRA_LOG) << "Lgoin is closed!";
-        Q_EMIT m_launcher.loginError(i18n("The login gate is closed, the game may be under maintenance.\n\n%1", reply->errorString()));
-        co_return false;
+        co_return i18n("The login gate is closed, the game may be under maintenance.\n\n%1", reply->errorString());
     }
 }
 
-QCoro::Task<bool> SquareEnixLogin::checkBootUpdates()
+QNetworkReply *SquareEnixLogin::requestBootPatchList()
 {
-    m_lastRunHasPatched = false;
-
-    Q_EMIT m_launcher.stageChanged(i18n("Checking for launcher updates..."));
     qInfo(ASTRA_LOG) << "Checking for updates to boot components...";
 
-    QString formattedDate = QDateTime::currentDateTimeUtc().toString(QStringLiteral("yyyy-MM-dd-HH-mm"));
-    formattedDate[15] = '0'_L1;
+    const auto request = bootPatchListRequest(m_launcher, *m_info->profile);
+    Utility::printRequest(QStringLiteral("GET"), request);
 
-    const QUrlQuery query{{QStringLiteral("time"), formattedDate}};
+    return m_launcher.mgr()->get(request);
+}
 
-    QUrl url;
-    url.setScheme(QStringLiteral("http"));
-    url.setHost(QStringLiteral("patch-bootver.%1").arg(m_launcher.settings()->squareEnixServer()));
-    url.setPath(QStringLiteral("/http/%1/%2/%3/").arg(platform, bootUpdateChannel, m_info->profile->bootVersion()));
-    url.setQuery(query);
+QCoro::Task<bool> SquareEnixLogin::updateBootComponents(QNetworkReply *reply)
+{
+    const StageTimer timer("boot update");
 
-    auto request = QNetworkRequest(url);
-    if (m_info->profile->account()->license() == Account::GameLicense::macOS) {
-        request.setHeader(QNetworkRequest::KnownHeaders::UserAgentHeader, macosPatchUserAgent);
-    } else {
-        request.setHeader(QNetworkRequest::KnownHeaders::UserAgentHeader, patchUserAgent);
+    Q_EMIT m_launcher.stageChanged(i18n("Checking for launcher updates..."));
+
+    // First, let's check for boot updates. While not technically required for us, it's needed for later hash checking.
+    // It's also a really good idea anyway, in case the official launcher is needed.
+    // This is reset on every login, since the boot components may have been updated since the last one.
+    m_lastRunHasPatched = true;
+    while (m_lastRunHasPatched) {
+        // There seems to be a limitation in their boot patching system.
+        // Their server can only give one patch a time, so the boot process must keep trying to patch until
+        // there is no patches left.
+        if (!co_await checkBootUpdates(reply != nullptr ? reply : requestBootPatchList())) {
+            co_return false;
+        }
+        reply = nullptr;
     }
 
-    request.setRawHeader(QByteArrayLiteral("Host"), QStringLiteral("patch-bootver.%1").arg(m_launcher.settings()->squareEnixServer()).toUtf8());
-    Utility::printRequest(QStringLiteral("GET"), request);
+    co_return true;
+}
+
+QCoro::Task<bool> SquareEnixLogin::checkBootUpdates(QNetworkReply *reply)
+{
+    m_lastRunHasPatched = false;
 
-    const auto reply = m_launcher.mgr()->get(request);
     co_await reply;
 
     if (reply->error() == QNetworkReply::NoError) {
@@ -200,18 +261,43 @@ QCoro::Task<bool> SquareEnixLogin::checkBootUpdates()
         }
     } else {
         qWarning(ASTRA_LOG) << "Unknown error when verifying boot files:" << reply->errorString();
-        Q_EMIT m_launcher.loginError(i18n("Unknown error when verifying boot files.\n\n%1", reply->errorString()));
+        reportError(i18n("Unknown error when verifying boot files.\n\n%1", reply->errorString()));
         co_return false;
     }
 
     co_return true;
 }
 
+QNetworkRequest SquareEnixLogin::bootPatchListRequest(LauncherCore &launcher, const Profile &profile)
+{
+    QString formattedDate = QDateTime::currentDateTimeUtc().toString(QStringLiteral("yyyy-MM-dd-HH-mm"));
+    formattedDate[15] = '0'_L1;
+
+    const QUrlQuery query{{QStringLiteral("time"), formattedDate}};
+
+    QUrl url;
+    url.setScheme(QStringLiteral("http"));
+    url.setHost(QStringLiteral("patch-bootver.%1").arg(launcher.settings()->squareEnixServer()));
+    url.setPath(QStringLiteral("/http/%1/%2/%3/").arg(platform, bootUpdateChannel, profile.bootVersion()));
+    url.setQuery(query);
+
+    auto request = QNetworkRequest(url);
+    if (profile.account()->license() == Account::GameLicense::macOS) {
+        request.setHeader(QNetworkRequest::KnownHeaders::UserAgentHeader, macosPatchUserAgent);
+    } else {
+        request.setHeader(QNetworkRequest::KnownHeaders::UserAgentHeader, patchUserAgent);
+    }
+
+    request.setRawHeader(QByteArrayLiteral("Host"), QStringLiteral("patch-bootver.%1").arg(launcher.settings()->squareEnixServer()).toUtf8());
+
+    return request;
+}
+
 QCoro::Task<std::optional<SquareEnixLogin::StoredInfo>> SquareEnixLogin::getStoredValue()
 {
-    qInfo(ASTRA_LOG) << "Getting the STORED value...";
+    const StageTimer timer("stored value");
 
-    Q_EMIT m_launcher.stageChanged(i18n("Logging in..."));
+    qInfo(ASTRA_LOG) << "Getting the STORED value...";
 
     QUrlQuery query;
     // en is always used to the top url
@@ -243,8 +329,14 @@ QCoro::Task<std::optional<SquareEnixLogin::StoredInfo>> SquareEnixLogin::getStor
     Utility::printRequest(QStringLiteral("GET"), request);
 
     const auto reply = m_launcher.mgr()->get(request);
+    trackSpeculativeReply(reply);
     co_await reply;
 
+    // An earlier stage already failed, so don't report anything
+    if (reply->error() == QNetworkReply::OperationCanceledError) {
+        co_return std::nullopt;
+    }
+
     const QString str = QString::fromUtf8(reply->readAll());
 
     // fetches Steam username
@@ -255,7 +347,7 @@ QCoro::Task<std::optional<SquareEnixLogin::StoredInfo>> SquareEnixLogin::getStor
         if (match.hasMatch()) {
             m_username = match.captured(1);
         } else {
-            Q_EMIT m_launcher.loginError(i18n("Could not get Steam username, have you attached your account?"));
+            reportError(i18n("Could not get Steam username, have you attached your account?"));
         }
     } else {
         m_username = m_info->username;
@@ -266,20 +358,17 @@ QCoro::Task<std::optional<SquareEnixLogin::StoredInfo>> SquareEnixLogin::getStor
     if (match.hasMatch()) {
         co_return StoredInfo{match.captured(1), url};
     } else {
-        Q_EMIT m_launcher.loginError(
+        reportError(
             i18n("Square Enix servers refused to confirm session information. The game may be under maintenance, try the official launcher."));
         co_return {};
     }
 }
 
-QCoro::Task<bool> SquareEnixLogin::loginOAuth()
+QCoro::Task<bool> SquareEnixLogin::loginOAuth(const StoredInfo &storedInfo)
 {
-    const auto storedResult = co_await getStoredValue();
-    if (storedResult == std::nullopt) {
-        co_return false;
-    }
+    const StageTimer timer("oauth");
 
-    const auto [stored, referer] = *storedResult;
+    const auto &[stored, referer] = storedInfo;
 
     qInfo(ASTRA_LOG) << "Logging in...";
 
@@ -317,12 +406,12 @@ QCoro::Task<bool> SquareEnixLogin::loginOAuth()
         const bool playable = parts[9] == "1"_L1;
 
         if (!playable) {
-            Q_EMIT m_launcher.loginError(i18n("Your account is unplayable. Check that you have the correct license, and a valid subscription."));
+            reportError(i18n("Your account is unplayable. Check that you have the correct license, and a valid subscription."));
             co_return false;
         }
 
         if (!terms) {
-            Q_EMIT m_launcher.loginError(i18n("Your account is unplayable. You need to accept the terms of service from the official launcher first."));
+            reportError(i18n("Your account is unplayable. You need to accept the terms of service from the official launcher first."));
             co_return false;
         }
 
@@ -337,9 +426,9 @@ QCoro::Task<bool> SquareEnixLogin::loginOAuth()
 
         if (errorMatch.hasCaptured(1)) {
             // there's a stray quote at the end of the error string, so let's remove that
-            Q_EMIT m_launcher.loginError(errorMatch.captured(1).chopped(1));
+            reportError(errorMatch.captured(1).chopped(1));
         } else {
-            Q_EMIT m_launcher.loginError(i18n("Unknown error"));
+            reportError(i18n("Unknown error"));
         }
 
         co_return false;
@@ -348,6 +437,8 @@ QCoro::Task<bool> SquareEnixLogin::loginOAuth()
 
 QCoro::Task<bool> SquareEnixLogin::registerSession()
 {
+    const StageTimer timer("register session");
+
     qInfo(ASTRA_LOG) << "Registering the session...";
 
     QUrl url;
@@ -400,26 +491,27 @@ QCoro::Task<bool> SquareEnixLogin::registerSession()
 
                 // re-read game version if it has updated
                 m_info->profile->readGameVersion();
+                m_gameHasPatched = true;
             }
 
             m_auth.SID = patchUniqueId;
 
             co_return true;
         } else {
-            Q_EMIT m_launcher.loginError(i18n("Fatal error, request was successful but X-Patch-Unique-Id was not recieved."));
+            reportError(i18n("Fatal error, request was successful but X-Patch-Unique-Id was not recieved."));
         }
     } else {
         if (reply->error() == QNetworkReply::SslHandshakeFailedError) {
-            Q_EMIT m_launcher.loginError(
+            reportError(
                 i18n("SSL handshake error detected. If you are using OpenSUSE or Fedora, try running `update-crypto-policies --set LEGACY`."));
         } else if (reply->error() == QNetworkReply::ContentConflictError) {
-            Q_EMIT m_launcher.loginError(i18n("The boot files are outdated, please login in again to update them."));
+            reportError(i18n("The boot files are outdated, please login in again to update them."));
         } else if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 405) {
-            Q_EMIT m_launcher.loginError(i18n("The game failed the anti-tamper check. Restore the game to the original state and try updating again."));
+            reportError(i18n("The game failed the anti-tamper check. Restore the game to the original state and try updating again."));
         } else if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 410) {
-            Q_EMIT m_launcher.loginError(i18n("This game version is no longer supported."));
+            reportError(i18n("This game version is no longer supported."));
         } else {
-            Q_EMIT m_launcher.loginError(i18n("Unknown error when registering the session."));
+            reportError(i18n("Unknown error when registering the session."));
         }
     }
 
@@ -455,6 +547,34 @@ QCoro::Task<QString> SquareEnixLogin::getBootHash() const
     co_return result;
 }
 
+void SquareEnixLogin::reportError(const QString &message)
+{
+    // Stages run at the same time can fail together, but only the first reason is shown
+    if (m_hasReportedError) {
+        qWarning(ASTRA_LOG) << "Not showing another login error:" << message;
+        return;
+    }
+
+    m_hasReportedError = true;
+    Q_EMIT m_launcher.loginError(message);
+}
+
+void SquareEnixLogin::trackSpeculativeReply(QNetworkReply *reply)
+{
+    m_speculativeReplies.push_back(reply);
+}
+
+void SquareEnixLogin::abortSpeculativeRequests()
+{
+    for (const auto &reply : m_speculativeReplies) {
+        if (reply && reply->isRunning()) {
+            qInfo(ASTRA_LOG) << "Aborting speculative request to" << reply->url().toDisplayString();
+            reply->abort();
+        }
+    }
+    m_speculativeReplies.clear();
+}
+
 QString SquareEnixLogin::getFileHash(const QString &file)
 {
     auto f = QFile(file);
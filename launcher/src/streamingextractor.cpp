@@ -0,0 +1,920 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "streamingextractor.h"
+#include "astra_log.h"
+#include "utility.h"
+
+#include <KLocalizedString>
+#include <QFileInfo>
+#include <QThread>
+#include <QtEndian>
+#include <filesystem>
+#include <lzma.h>
+#include <zlib.h>
+
+using namespace Qt::StringLiterals;
+
+// How much is decompressed at once, before it's written out
+constexpr qsizetype decompressBufferSize = 256 * 1024;
+
+// Metadata entries (like long file names) are tiny, anything bigger than this is a broken archive
+constexpr qint64 maximumMetadataSize = 1024 * 1024;
+
+// liblzma falls back to a single thread if decoding in parallel would need more memory than this
+constexpr uint64_t xzThreadingMemoryLimit = 512 * 1024 * 1024;
+
+constexpr qsizetype tarBlockSize = 512;
+
+constexpr quint32 zipLocalHeaderSignature = 0x04034b50;
+constexpr quint32 zipDataDescriptorSignature = 0x08074b50;
+constexpr quint32 zipCentralDirectorySignature = 0x02014b50;
+constexpr quint32 zipEndOfCentralDirectorySignature = 0x06054b50;
+constexpr quint32 zip64EndOfCentralDirectorySignature = 0x06064b50;
+constexpr quint32 zip64EndOfCentralDirectoryLocatorSignature = 0x07064b50;
+
+constexpr qsizetype zipLocalHeaderSize = 30;
+constexpr qsizetype zipCentralDirectoryHeaderSize = 46;
+
+constexpr quint16 zipEncryptedFlag = 1 << 0;
+constexpr quint16 zipDataDescriptorFlag = 1 << 3;
+
+constexpr quint16 zipStoredMethod = 0;
+constexpr quint16 zipDeflateMethod = 8;
+
+constexpr quint16 zip64ExtraField = 0x0001;
+constexpr quint8 zipUnixHost = 3;
+
+struct StreamingExtractor::Decoder {
+    ~Decoder()
+    {
+        lzma_end(&xz);
+        if (zlibInitialized) {
+            inflateEnd(&zlib);
+        }
+    }
+
+    lzma_stream xz = LZMA_STREAM_INIT;
+    z_stream zlib{};
+    bool zlibInitialized = false;
+    bool ended = false;
+};
+
+static quint16 readUInt16(const char *data)
+{
+    return qFromLittleEndian<quint16>(data);
+}
+
+static quint32 readUInt32(const char *data)
+{
+    return qFromLittleEndian<quint32>(data);
+}
+
+static quint64 readUInt64(const char *data)
+{
+    return qFromLittleEndian<quint64>(data);
+}
+
+static qint64 parseTarNumber(const char *field, const int length)
+{
+    // GNU tar stores numbers too big for octal as base-256, marked by the high bit
+    if (static_cast<unsigned char>(field[0]) & 0x80) {
+        qint64 value = static_cast<unsigned char>(field[0]) & 0x7F;
+        for (int i = 1; i < length; i++) {
+            value = (value << 8) | static_cast<unsigned char>(field[i]);
+        }
+        return value;
+    }
+
+    int i = 0;
+    while (i < length && field[i] == ' ') {
+        i++;
+    }
+
+    qint64 value = 0;
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; i++) {
+        value = value * 8 + (field[i] - '0');
+    }
+
+    return value;
+}
+
+static QString parseTarString(const char *field, const int length)
+{
+    return QString::fromUtf8(field, static_cast<qsizetype>(qstrnlen(field, length)));
+}
+
+static bool isTarChecksumValid(const char *block)
+{
+    const qint64 expected = parseTarNumber(block + 148, 8);
+
+    qint64 sum = 0;
+    for (qsizetype i = 0; i < tarBlockSize; i++) {
+        // the checksum field itself is counted as if it were spaces
+        sum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(block[i]);
+    }
+
+    return sum == expected;
+}
+
+static bool initializeXzDecoder(lzma_stream &stream)
+{
+#if LZMA_VERSION >= 50040002
+    // Archives made with multiple blocks (like xz -T0 does) can be decoded in parallel, otherwise it's the same as the single-threaded decoder
+    lzma_mt options{};
+    options.flags = LZMA_CONCATENATED;
+    options.threads = static_cast<uint32_t>(QThread::idealThreadCount());
+    options.memlimit_threading = xzThreadingMemoryLimit;
+    options.memlimit_stop = UINT64_MAX;
+
+    return lzma_stream_decoder_mt(&stream, &options) == LZMA_OK;
+#else
+    return lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK;
+#endif
+}
+
+StreamingExtractor::StreamingExtractor(const QString &directory, const QString &root)
+    : m_directory(directory)
+    , m_root(root.isEmpty() ? QString() : QDir::cleanPath(root))
+{
+}
+
+StreamingExtractor::~StreamingExtractor() = default;
+
+bool StreamingExtractor::write(const QByteArrayView data)
+{
+    if (!m_errorString.isEmpty()) {
+        return false;
+    }
+
+    if (m_format == Format::Unknown) {
+        m_buffer.append(data);
+
+        // Wait until there's enough to tell what kind of archive this is
+        if (m_buffer.size() < 6) {
+            return true;
+        }
+
+        m_decoder = std::make_unique<Decoder>();
+
+        if (m_buffer.startsWith(QByteArrayView("\xFD" "7zXZ\0", 6))) {
+            m_format = Format::TarXz;
+            if (!initializeXzDecoder(m_decoder->xz)) {
+                return fail(i18n("Failed to start decompressing the archive."));
+            }
+        } else if (m_buffer.startsWith("\x1F\x8B")) {
+            m_format = Format::TarGz;
+            // 16 tells zlib to expect a gzip header
+            if (inflateInit2(&m_decoder->zlib, MAX_WBITS + 16) != Z_OK) {
+                return fail(i18n("Failed to start decompressing the archive."));
+            }
+            m_decoder->zlibInitialized = true;
+        } else if (m_buffer.startsWith("PK\x03\x04")) {
+            m_format = Format::Zip;
+            // zip entries are raw deflate streams, without any header
+            if (inflateInit2(&m_decoder->zlib, -MAX_WBITS) != Z_OK) {
+                return fail(i18n("Failed to start decompressing the archive."));
+            }
+            m_decoder->zlibInitialized = true;
+        } else {
+            return fail(i18n("The archive is in an unknown format."));
+        }
+
+        if (m_format == Format::Zip) {
+            return parseZip();
+        }
+
+        const QByteArray compressed = std::exchange(m_buffer, {});
+        return decompress(compressed, false);
+    }
+
+    if (m_format == Format::Zip) {
+        m_buffer.append(data);
+        return parseZip();
+    }
+
+    return decompress(data, false);
+}
+
+bool StreamingExtractor::finish()
+{
+    if (!m_errorString.isEmpty()) {
+        return false;
+    }
+
+    switch (m_format) {
+    case Format::Unknown:
+        return fail(i18n("The archive is empty or in an unknown format."));
+    case Format::TarXz:
+    case Format::TarGz:
+        if (!decompress({}, true)) {
+            return false;
+        }
+
+        if (!m_decoder->ended || m_remaining > 0 || (!m_tarEnded && !m_buffer.isEmpty())) {
+            return fail(i18n("The archive is incomplete."));
+        }
+        break;
+    case Format::Zip:
+        if (m_zipState != ZipState::End) {
+            return fail(i18n("The archive is incomplete."));
+        }
+        break;
+    }
+
+    qDebug(ASTRA_LOG) << "Extracted" << m_changedFiles << "changed files and skipped" << m_unchangedFiles << "unchanged files in" << m_directory;
+
+    return true;
+}
+
+QString StreamingExtractor::errorString() const
+{
+    return m_errorString;
+}
+
+bool StreamingExtractor::decompress(const QByteArrayView data, const bool finishing)
+{
+    QByteArray output(decompressBufferSize, Qt::Uninitialized);
+
+    if (m_format == Format::TarXz) {
+        auto &stream = m_decoder->xz;
+        stream.next_in = reinterpret_cast<const uint8_t *>(data.data());
+        stream.avail_in = data.size();
+
+        while (!m_decoder->ended) {
+            stream.next_out = reinterpret_cast<uint8_t *>(output.data());
+            stream.avail_out = output.size();
+
+            const lzma_ret ret = lzma_code(&stream, finishing ? LZMA_FINISH : LZMA_RUN);
+            if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+                return fail(i18n("Failed to decompress the archive (error %1).", static_cast<int>(ret)));
+            }
+
+            const qsizetype produced = output.size() - static_cast<qsizetype>(stream.avail_out);
+            m_buffer.append(output.constData(), produced);
+            if (!parseTar()) {
+                return false;
+            }
+
+            if (ret == LZMA_STREAM_END) {
+                m_decoder->ended = true;
+            } else if (stream.avail_in == 0 && stream.avail_out != 0) {
+                break;
+            }
+        }
+    } else {
+        auto &stream = m_decoder->zlib;
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+
+        while (!m_decoder->ended) {
+            stream.next_out = reinterpret_cast<Bytef *>(output.data());
+            stream.avail_out = static_cast<uInt>(output.size());
+
+            const int ret = inflate(&stream, finishing ? Z_FINISH : Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                return fail(i18n("Failed to decompress the archive (error %1).", ret));
+            }
+
+            const qsizetype produced = output.size() - static_cast<qsizetype>(stream.avail_out);
+            m_buffer.append(output.constData(), produced);
+            if (!parseTar()) {
+                return false;
+            }
+
+            if (ret == Z_STREAM_END) {
+                m_decoder->ended = true;
+            } else if (stream.avail_in == 0 && stream.avail_out != 0) {
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool StreamingExtractor::parseTar()
+{
+    qsizetype offset = 0;
+
+    while (offset < m_buffer.size()) {
+        const qsizetype available = m_buffer.size() - offset;
+
+        // Whatever comes after the end of the archive is padding
+        if (m_tarEnded) {
+            offset = m_buffer.size();
+            break;
+        }
+
+        if (m_remaining > 0) {
+            const auto length = static_cast<qsizetype>(qMin<qint64>(m_remaining, available));
+            const QByteArrayView chunk(m_buffer.constData() + offset, length);
+
+            switch (m_tarEntryKind) {
+            case TarEntryKind::File:
+                if (!writeFile(chunk)) {
+                    return false;
+                }
+                break;
+            case TarEntryKind::Skip:
+                break;
+            default:
+                m_tarMetadata.append(chunk);
+                break;
+            }
+
+            offset += length;
+            m_remaining -= length;
+
+            if (m_remaining == 0 && !finishTarEntry()) {
+                return false;
+            }
+            continue;
+        }
+
+        if (m_padding > 0) {
+            const auto length = static_cast<qsizetype>(qMin<qint64>(m_padding, available));
+            offset += length;
+            m_padding -= length;
+            continue;
+        }
+
+        if (available < tarBlockSize) {
+            break;
+        }
+
+        if (!readTarHeader(m_buffer.constData() + offset)) {
+            return false;
+        }
+        offset += tarBlockSize;
+    }
+
+    m_buffer.remove(0, offset);
+
+    return true;
+}
+
+bool StreamingExtractor::readTarHeader(const char *block)
+{
+    // The archive ends with empty blocks
+    if (std::all_of(block, block + tarBlockSize, [](const char c) {
+            return c == '\0';
+        })) {
+        m_tarEnded = true;
+        return true;
+    }
+
+    if (!isTarChecksumValid(block)) {
+        return fail(i18n("The archive is corrupted."));
+    }
+
+    QString name = parseTarString(block, 100);
+
+    // POSIX tar splits long paths into a prefix, but GNU tar uses that space for something else
+    if (QByteArrayView(block + 257, 6) == QByteArrayView("ustar\0", 6)) {
+        const QString prefix = parseTarString(block + 345, 155);
+        if (!prefix.isEmpty()) {
+            name = prefix + '/'_L1 + name;
+        }
+    }
+
+    if (!m_tarLongName.isEmpty()) {
+        name = std::exchange(m_tarLongName, {});
+    }
+
+    QString linkName = parseTarString(block + 157, 100);
+    if (!m_tarLongLink.isEmpty()) {
+        linkName = std::exchange(m_tarLongLink, {});
+    }
+
+    const auto mode = static_cast<quint32>(parseTarNumber(block + 100, 8));
+    const qint64 size = parseTarNumber(block + 124, 12);
+    const char type = block[156];
+
+    m_remaining = size;
+    m_padding = (tarBlockSize - size % tarBlockSize) % tarBlockSize;
+    m_tarEntryKind = TarEntryKind::Skip;
+
+    switch (type) {
+    case 'L':
+        m_tarEntryKind = TarEntryKind::LongName;
+        break;
+    case 'K':
+        m_tarEntryKind = TarEntryKind::LongLink;
+        break;
+    case 'x':
+        m_tarEntryKind = TarEntryKind::Pax;
+        break;
+    case '5':
+        if (const QString path = outputPath(name); !path.isEmpty() && !makeDirectory(path)) {
+            return false;
+        }
+        break;
+    case '1':
+    case '2':
+        if (const QString path = outputPath(name); !path.isEmpty() && !makeLink(path, type == '1' ? outputPath(linkName) : linkName, type == '2')) {
+            return false;
+        }
+        break;
+    case '0':
+    case '7':
+    case '\0':
+        if (const QString path = outputPath(name); !path.isEmpty()) {
+            if (!beginFile(path, Utility::permissionsFromMode(mode), size)) {
+                return false;
+            }
+            m_tarEntryKind = TarEntryKind::File;
+        }
+        break;
+    default:
+        // Global headers, devices and such aren't needed
+        break;
+    }
+
+    if (m_tarEntryKind != TarEntryKind::File && m_tarEntryKind != TarEntryKind::Skip && size > maximumMetadataSize) {
+        return fail(i18n("The archive is corrupted."));
+    }
+
+    if (m_remaining == 0) {
+        return finishTarEntry();
+    }
+
+    return true;
+}
+
+bool StreamingExtractor::finishTarEntry()
+{
+    switch (m_tarEntryKind) {
+    case TarEntryKind::File:
+        return endFile();
+    case TarEntryKind::Skip:
+        break;
+    case TarEntryKind::LongName:
+        m_tarLongName = parseTarString(m_tarMetadata.constData(), static_cast<int>(m_tarMetadata.size()));
+        break;
+    case TarEntryKind::LongLink:
+        m_tarLongLink = parseTarString(m_tarMetadata.constData(), static_cast<int>(m_tarMetadata.size()));
+        break;
+    case TarEntryKind::Pax: {
+        // Each record is "<length> <key>=<value>\n", where the length includes itself
+        qsizetype position = 0;
+        while (position < m_tarMetadata.size()) {
+            const qsizetype space = m_tarMetadata.indexOf(' ', position);
+            if (space < 0) {
+                break;
+            }
+
+            bool ok = false;
+            const qsizetype length = m_tarMetadata.sliced(position, space - position).toLongLong(&ok);
+            if (!ok || space + 1 >= position + length || position + length > m_tarMetadata.size()) {
+                break;
+            }
+
+            const QByteArray record = m_tarMetadata.sliced(space + 1, position + length - space - 2);
+            const qsizetype equals = record.indexOf('=');
+            if (equals > 0) {
+                const QByteArray key = record.first(equals);
+                if (key == "path") {
+                    m_tarLongName = QString::fromUtf8(record.sliced(equals + 1));
+                } else if (key == "linkpath") {
+                    m_tarLongLink = QString::fromUtf8(record.sliced(equals + 1));
+                }
+            }
+
+            position += length;
+        }
+    } break;
+    }
+
+    m_tarMetadata.clear();
+
+    return true;
+}
+
+bool StreamingExtractor::parseZip()
+{
+    qsizetype offset = 0;
+
+    while (true) {
+        // Whatever comes after the central directory is its trailer and the archive comment
+        if (m_zipState == ZipState::End) {
+            offset = m_buffer.size();
+            break;
+        }
+
+        if (m_zipState == ZipState::Data) {
+            if (!readZipData(offset)) {
+                return false;
+            }
+
+            if (m_zipState == ZipState::Data) {
+                break;
+            }
+            continue;
+        }
+
+        const qsizetype available = m_buffer.size() - offset;
+        const char *data = m_buffer.constData() + offset;
+
+        if (available < 4) {
+            break;
+        }
+
+        const quint32 signature = readUInt32(data);
+
+        if (m_zipState == ZipState::DataDescriptor) {
+            // The signature is optional, and the sizes are bigger for zip64 entries
+            const qsizetype signatureSize = signature == zipDataDescriptorSignature ? 4 : 0;
+            const qsizetype size = signatureSize + 4 + (m_zipEntryIs64 ? 16 : 8);
+            if (available < size) {
+                break;
+            }
+
+            m_zipExpectedCrc = readUInt32(data + signatureSize);
+            offset += size;
+            m_zipState = ZipState::Header;
+
+            if (!finishZipEntry()) {
+                return false;
+            }
+            continue;
+        }
+
+        qsizetype read = 0;
+        switch (signature) {
+        case zipLocalHeaderSignature:
+            read = readZipLocalHeader(data, available);
+            break;
+        case zipCentralDirectorySignature:
+            // This is only at the very end, once all of the entries have been extracted
+            read = readZipCentralDirectoryHeader(data, available);
+            break;
+        case zipEndOfCentralDirectorySignature:
+        case zip64EndOfCentralDirectorySignature:
+        case zip64EndOfCentralDirectoryLocatorSignature:
+            m_zipState = ZipState::End;
+            continue;
+        default:
+            return fail(i18n("The archive is corrupted."));
+        }
+
+        if (read < 0) {
+            return false;
+        }
+
+        if (read == 0) {
+            break;
+        }
+
+        offset += read;
+    }
+
+    m_buffer.remove(0, offset);
+
+    return true;
+}
+
+qsizetype StreamingExtractor::readZipLocalHeader(const char *header, const qsizetype available)
+{
+    if (available < zipLocalHeaderSize) {
+        return 0;
+    }
+
+    const quint16 nameLength = readUInt16(header + 26);
+    const quint16 extraLength = readUInt16(header + 28);
+    const qsizetype size = zipLocalHeaderSize + nameLength + extraLength;
+    if (available < size) {
+        return 0;
+    }
+
+    m_zipFlags = readUInt16(header + 6);
+    m_zipMethod = readUInt16(header + 8);
+    m_zipExpectedCrc = readUInt32(header + 14);
+    qint64 compressedSize = readUInt32(header + 18);
+    qint64 uncompressedSize = readUInt32(header + 22);
+    m_zipEntryName = QString::fromUtf8(header + zipLocalHeaderSize, nameLength);
+
+    // zip64 moves the sizes into an extra field
+    m_zipEntryIs64 = false;
+    const char *extra = header + zipLocalHeaderSize + nameLength;
+    for (qsizetype i = 0; i + 4 <= extraLength;) {
+        const quint16 id = readUInt16(extra + i);
+        const quint16 length = readUInt16(extra + i + 2);
+        if (id == zip64ExtraField && length >= 16 && i + 4 + 16 <= extraLength) {
+            uncompressedSize = static_cast<qint64>(readUInt64(extra + i + 4));
+            compressedSize = static_cast<qint64>(readUInt64(extra + i + 12));
+            m_zipEntryIs64 = true;
+        }
+        i += 4 + length;
+    }
+
+    if (m_zipFlags & zipEncryptedFlag) {
+        fail(i18n("%1 is encrypted, which isn't supported.", m_zipEntryName));
+        return -1;
+    }
+
+    if (m_zipMethod != zipStoredMethod && m_zipMethod != zipDeflateMethod) {
+        fail(i18n("%1 uses an unsupported compression method.", m_zipEntryName));
+        return -1;
+    }
+
+    // Without the size up front, there's no way to tell where an uncompressed entry ends
+    if (m_zipMethod == zipStoredMethod && (m_zipFlags & zipDataDescriptorFlag)) {
+        fail(i18n("%1 can't be extracted while downloading.", m_zipEntryName));
+        return -1;
+    }
+
+    m_remaining = m_zipMethod == zipStoredMethod ? compressedSize : 0;
+    m_zipCrc = crc32(0, nullptr, 0);
+
+    if (const QString path = outputPath(m_zipEntryName); !path.isEmpty()) {
+        if (m_zipEntryName.endsWith('/'_L1)) {
+            if (!makeDirectory(path)) {
+                return -1;
+            }
+        } else if (!beginFile(path, {}, (m_zipFlags & zipDataDescriptorFlag) ? -1 : uncompressedSize)) {
+            return -1;
+        }
+    }
+
+    m_zipState = ZipState::Data;
+
+    return size;
+}
+
+bool StreamingExtractor::readZipData(qsizetype &offset)
+{
+    const qsizetype available = m_buffer.size() - offset;
+    const char *data = m_buffer.constData() + offset;
+
+    if (m_zipMethod == zipStoredMethod) {
+        const auto length = static_cast<qsizetype>(qMin<qint64>(m_remaining, available));
+        if (!writeZipData(QByteArrayView(data, length))) {
+            return false;
+        }
+
+        offset += length;
+        m_remaining -= length;
+
+        if (m_remaining == 0) {
+            m_zipState = ZipState::Header;
+            return finishZipEntry();
+        }
+
+        return true;
+    }
+
+    auto &stream = m_decoder->zlib;
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = static_cast<uInt>(available);
+
+    QByteArray output(decompressBufferSize, Qt::Uninitialized);
+    while (true) {
+        stream.next_out = reinterpret_cast<Bytef *>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+
+        const int ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            return fail(i18n("%1 is corrupted.", m_zipEntryName));
+        }
+
+        const qsizetype produced = output.size() - static_cast<qsizetype>(stream.avail_out);
+        if (!writeZipData(QByteArrayView(output.constData(), produced))) {
+            return false;
+        }
+
+        if (ret == Z_STREAM_END) {
+            offset += available - static_cast<qsizetype>(stream.avail_in);
+            inflateReset(&stream);
+
+            // The CRC is in the data descriptor, which comes right after the data
+            if (m_zipFlags & zipDataDescriptorFlag) {
+                m_zipState = ZipState::DataDescriptor;
+                return true;
+            }
+
+            m_zipState = ZipState::Header;
+            return finishZipEntry();
+        }
+
+        if (stream.avail_in == 0 && stream.avail_out != 0) {
+            offset += available;
+            return true;
+        }
+    }
+}
+
+bool StreamingExtractor::writeZipData(const QByteArrayView data)
+{
+    m_zipCrc = crc32(m_zipCrc, reinterpret_cast<const Bytef *>(data.data()), static_cast<uInt>(data.size()));
+
+    if (m_writer.isOpen()) {
+        return writeFile(data);
+    }
+
+    return true;
+}
+
+bool StreamingExtractor::finishZipEntry()
+{
+    if (m_zipCrc != m_zipExpectedCrc) {
+        return fail(i18n("%1 failed the integrity check.", m_zipEntryName));
+    }
+
+    m_zipExtractedEntries.insert(m_zipEntryName);
+
+    if (m_writer.isOpen()) {
+        return endFile();
+    }
+
+    return true;
+}
+
+qsizetype StreamingExtractor::readZipCentralDirectoryHeader(const char *header, const qsizetype available)
+{
+    if (available < zipCentralDirectoryHeaderSize) {
+        return 0;
+    }
+
+    const quint16 nameLength = readUInt16(header + 28);
+    const quint16 extraLength = readUInt16(header + 30);
+    const quint16 commentLength = readUInt16(header + 32);
+    const qsizetype size = zipCentralDirectoryHeaderSize + nameLength + extraLength + commentLength;
+    if (available < size) {
+        return 0;
+    }
+
+    const QString name = QString::fromUtf8(header + zipCentralDirectoryHeaderSize, nameLength);
+    const QString path = outputPath(name);
+    if (path.isEmpty()) {
+        return size;
+    }
+
+    // The central directory is the real list of files, so make sure none of them were missed
+    if (!m_zipExtractedEntries.contains(name)) {
+        fail(i18n("%1 is missing from the archive.", name));
+        return -1;
+    }
+
+    // Permissions are only stored here, and only by archivers on Unix-like systems
+    const quint16 madeBy = readUInt16(header + 4);
+    const quint32 mode = readUInt32(header + 38) >> 16;
+    if ((madeBy >> 8) == zipUnixHost && (mode & 0777) != 0 && !name.endsWith('/'_L1)) {
+        QFile::setPermissions(path, Utility::permissionsFromMode(mode));
+    }
+
+    return size;
+}
+
+QString StreamingExtractor::outputPath(const QString &name) const
+{
+    QString path = QDir::cleanPath(name);
+
+    if (!m_root.isEmpty()) {
+        if (path == m_root) {
+            return m_directory.absolutePath();
+        }
+
+        if (!path.startsWith(m_root + '/'_L1)) {
+            return {};
+        }
+
+        path = path.sliced(m_root.size() + 1);
+    }
+
+    // Don't let entries escape from the directory, we can't trust what was downloaded
+    if (QDir::isAbsolutePath(path) || path == ".."_L1 || path.startsWith("../"_L1)) {
+        qWarning(ASTRA_LOG) << "Skipping unsafe archive entry" << name;
+        return {};
+    }
+
+    if (path == "."_L1) {
+        return m_directory.absolutePath();
+    }
+
+    return m_directory.absoluteFilePath(path);
+}
+
+bool StreamingExtractor::isInsideDirectory(const QString &path)
+{
+    if (m_canonicalDirectory.isEmpty()) {
+        if (!QDir().mkpath(m_directory.absolutePath())) {
+            return false;
+        }
+        m_canonicalDirectory = QFileInfo(m_directory.absolutePath()).canonicalFilePath();
+    }
+
+    // Whatever doesn't exist yet can't be a link, so the closest thing that does decides where it ends up
+    QFileInfo info(path);
+    while (!info.exists() && !info.isSymLink()) {
+        info = QFileInfo(info.absolutePath());
+    }
+
+    // This is empty for a link that doesn't go anywhere
+    const QString canonicalPath = info.canonicalFilePath();
+    return !canonicalPath.isEmpty() && (canonicalPath == m_canonicalDirectory || canonicalPath.startsWith(m_canonicalDirectory + '/'_L1));
+}
+
+bool StreamingExtractor::makeDirectory(const QString &path)
+{
+    // Links that were extracted earlier could lead anywhere, so where they go is checked on disk
+    if (!isInsideDirectory(path)) {
+        return fail(i18n("%1 is outside of %2.", path, m_directory.absolutePath()));
+    }
+
+    if (!QDir().mkpath(path)) {
+        return fail(i18n("Failed to create %1.", path));
+    }
+
+    return true;
+}
+
+bool StreamingExtractor::makeLink(const QString &path, const QString &target, const bool symbolic)
+{
+    if (!makeDirectory(QFileInfo(path).absolutePath())) {
+        return false;
+    }
+
+    if (symbolic) {
+        // A link pointing outside of the directory would let later entries be written anywhere.
+        // Going up with ".." could also pass through another link, which can't be checked from the text alone, so those aren't allowed at all.
+        if (QDir::isAbsolutePath(target) || target.split('/'_L1).contains(".."_L1)) {
+            qWarning(ASTRA_LOG) << "Skipping unsafe archive link" << path << "to" << target;
+            return true;
+        }
+    } else if (target.isEmpty()) {
+        return fail(i18n("The archive is corrupted."));
+    } else if (!isInsideDirectory(target)) {
+        return fail(i18n("%1 is outside of %2.", target, m_directory.absolutePath()));
+    }
+
+    QFile::remove(path);
+
+    std::error_code error;
+    if (symbolic) {
+        std::filesystem::create_symlink(target.toStdString(), path.toStdString(), error);
+    } else {
+        std::filesystem::create_hard_link(target.toStdString(), path.toStdString(), error);
+    }
+
+    if (error) {
+        return fail(i18n("Failed to create %1: %2", path, QString::fromStdString(error.message())));
+    }
+
+    return true;
+}
+
+bool StreamingExtractor::beginFile(const QString &path, const QFileDevice::Permissions permissions, const qint64 size)
+{
+    if (!makeDirectory(QFileInfo(path).absolutePath())) {
+        return false;
+    }
+
+    // The file itself could be a link from earlier too
+    if (!isInsideDirectory(path)) {
+        return fail(i18n("%1 is outside of %2.", path, m_directory.absolutePath()));
+    }
+
+    if (!m_writer.open(path, size)) {
+        return fail(m_writer.errorString());
+    }
+
+    m_filePath = path;
+    m_filePermissions = permissions;
+
+    return true;
+}
+
+bool StreamingExtractor::writeFile(const QByteArrayView data)
+{
+    if (!m_writer.write(data)) {
+        return fail(m_writer.errorString());
+    }
+
+    return true;
+}
+
+bool StreamingExtractor::endFile()
+{
+    if (!m_writer.commit()) {
+        return fail(m_writer.errorString());
+    }
+
+    if (m_writer.wasChanged()) {
+        m_changedFiles++;
+    } else {
+        m_unchangedFiles++;
+    }
+
+    if (m_filePermissions.toInt() != 0 && QFile::permissions(m_filePath) != m_filePermissions) {
+        QFile::setPermissions(m_filePath, m_filePermissions);
+    }
+
+    return true;
+}
+
+bool StreamingExtractor::fail(const QString &message)
+{
+    m_errorString = message;
+    return false;
+}
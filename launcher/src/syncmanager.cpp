@@ -15,8 +15,11 @@
 #include <KConfigGroup>
 #include <KLocalizedString>
 #include <KSharedConfig>
+#include <QBuffer>
 #include <QCoreApplication>
 #include <QCoro>
+#include <QJsonArray>
+#include <QTemporaryDir>
 
 const auto roomType = QStringLiteral("zone.xiv.astra-sync");
 const auto syncEventType = QStringLiteral("zone.xiv.astra.sync");
@@ -27,19 +30,39 @@ const auto latestKey = QStringLiteral("latest");
 const auto noneKey = QStringLiteral("none");
 const auto filesKey = QStringLiteral("files");
 const auto contentUriKey = QStringLiteral("content-uri");
+const auto manifestKey = QStringLiteral("manifest");
+const auto chunksKey = QStringLiteral("chunks");
 
 using namespace Quotient;
 
+/// \return Whether @p name is a file directly inside of a character folder.
+/// The names come from the server, so anything that could point somewhere else is rejected.
+static bool isCharacterFileName(const QString &name)
+{
+    return !name.isEmpty() && name != QLatin1String(".") && !name.contains(QLatin1String("..")) && !name.contains(QLatin1Char('/'))
+        && !name.contains(QLatin1Char('\\'));
+}
+
 SyncManager::SyncManager(QObject *parent)
     : QObject(parent)
 {
     invokeLogin();
     connect(&m_accountRegistry, &AccountRegistry::rowsInserted, this, [this]() {
-        connection()->setCacheState(false);
-        connection()->setLazyLoading(false);
+        // The sync token and room state are kept between launches, so we only need to catch up instead of doing a full sync every time.
+        // Members of unrelated rooms aren't needed at all, so they're loaded lazily.
+        connection()->setCacheState(true);
+        connection()->setLazyLoading(true);
         Connection::setDirectChatEncryptionDefault(false);
         Connection::setEncryptionDefault(false);
 
+        connection()->loadState();
+        connect(connection(), &Connection::syncDone, connection(), &Connection::saveState);
+
+        // If the sync room was cached, it can be used before the first sync even finishes
+        if (!m_currentRoom) {
+            findKnownRoom();
+        }
+
         Q_EMIT connectedChanged();
         Q_EMIT userIdChanged();
         Q_EMIT connectionChanged();
@@ -134,28 +157,35 @@ QCoro::Task<void> SyncManager::findRoom()
     // If we have no room id set, we need to find the correct room type
     const bool needsFirstTimeRoom = roomId.isEmpty();
 
-    if (!needsFirstTimeRoom) {
-        auto room = m_accountRegistry.accounts().first()->room(roomId);
-        if (room) {
-            qCDebug(ASTRA_LOG) << "Found pre-existing room!";
-
-            m_currentRoom = room;
-            Q_EMIT isReadyChanged();
-
-            co_return;
-        }
+    if (findKnownRoom()) {
+        co_return;
     }
 
     // Try to find our room
-    auto rooms = m_accountRegistry.accounts().first()->rooms(Quotient::JoinState::Join);
-    for (auto room : rooms) {
-        if (!room->currentState().contains<RoomCreateEvent>()) {
-            co_await qCoro(room, &Room::baseStateLoaded);
-            qCDebug(ASTRA_LOG) << "Loaded base state...";
+    if (needsFirstTimeRoom) {
+        auto rooms = m_accountRegistry.accounts().first()->rooms(Quotient::JoinState::Join);
+
+        // Wait for every room that's still missing its state at once, instead of one after another
+        std::vector<QCoro::Task<>> pendingRooms;
+        for (auto room : rooms) {
+            if (!room->currentState().contains<RoomCreateEvent>()) {
+                pendingRooms.push_back(qCoro(room, &Room::baseStateLoaded));
+            }
         }
 
-        if (needsFirstTimeRoom) {
-            const QJsonObject createEvent = room->currentState().eventsOfType(QStringLiteral("m.room.create")).first()->fullJson();
+        for (auto &pendingRoom : pendingRooms) {
+            co_await std::move(pendingRoom);
+        }
+
+        qCDebug(ASTRA_LOG) << "Loaded base state for" << pendingRooms.size() << "rooms";
+
+        for (auto room : rooms) {
+            const auto createEvents = room->currentState().eventsOfType(QStringLiteral("m.room.create"));
+            if (createEvents.isEmpty()) {
+                continue;
+            }
+
+            const QJsonObject createEvent = createEvents.first()->fullJson();
             auto contentJson = createEvent[QStringLiteral("content")].toObject();
             if (contentJson.contains(QStringLiteral("type"))) {
                 if (contentJson[QStringLiteral("type")] == roomType) {
@@ -163,6 +193,7 @@ QCoro::Task<void> SyncManager::findRoom()
                     m_currentRoom = room;
                     setRoomId(room->id());
                     Q_EMIT isReadyChanged();
+                    break;
                 }
             }
         }
@@ -195,6 +226,26 @@ QCoro::Task<void> SyncManager::findRoom()
     co_return;
 }
 
+bool SyncManager::findKnownRoom()
+{
+    const QString roomId = this->roomId();
+    if (roomId.isEmpty()) {
+        return false;
+    }
+
+    auto room = m_accountRegistry.accounts().first()->room(roomId);
+    if (!room) {
+        return false;
+    }
+
+    qCDebug(ASTRA_LOG) << "Found pre-existing room!";
+
+    m_currentRoom = room;
+    Q_EMIT isReadyChanged();
+
+    return true;
+}
+
 void SyncManager::invokeLogin()
 {
     // Simplified from libQuotient, but this can be simplified even more
@@ -248,37 +299,109 @@ QCoro::Task<std::optional<SyncManager::PreviousCharacterData>> SyncManager::getU
 
         auto filesVariantMap = syncEvent[filesKey].toVariant().toMap();
         QMap<QString, QString> fileHashes;
+        // Anything that would be read or written outside of the character folder is dropped here, so nothing else has to check
         for (const auto &[file, hashVariant] : filesVariantMap.asKeyValueRange()) {
+            if (!isCharacterFileName(file)) {
+                qCWarning(ASTRA_LOG) << "Ignoring" << file << "in the previous sync of" << id << "since it's outside of the character folder";
+                continue;
+            }
             fileHashes[file] = hashVariant.toString();
         }
 
-        co_return PreviousCharacterData{.mxcUri = syncEvent[contentUriKey].toString(), .hostname = syncEvent[hostnameKey].toString(), .fileHashes = fileHashes};
+        QMap<QString, QStringList> fileChunks;
+        const auto manifest = syncEvent[manifestKey].toObject();
+        for (const auto &[file, chunksValue] : manifest.toVariantMap().asKeyValueRange()) {
+            if (!isCharacterFileName(file)) {
+                continue;
+            }
+            fileChunks[file] = chunksValue.toStringList();
+        }
+
+        QMap<QString, QString> chunkUris;
+        for (const auto &[hash, uriValue] : syncEvent[chunksKey].toObject().toVariantMap().asKeyValueRange()) {
+            chunkUris[hash] = uriValue.toString();
+        }
+
+        co_return PreviousCharacterData{.mxcUri = syncEvent[contentUriKey].toString(),
+                                        .hostname = syncEvent[hostnameKey].toString(),
+                                        .fileHashes = fileHashes,
+                                        .fileChunks = fileChunks,
+                                        .chunkUris = chunkUris};
     }
 }
 
-QCoro::Task<bool> SyncManager::uploadCharacterArchive(const QString &id, const QString &path, const QMap<QString, QString> &fileHashes)
+QCoro::Task<std::optional<QString>> SyncManager::uploadChunk(const QByteArray &data)
 {
-    Q_ASSERT(m_currentRoom);
+    const auto buffer = new QBuffer();
+    buffer->setData(data);
+    buffer->open(QIODevice::ReadOnly);
 
-    auto uploadFileJob = connection()->uploadFile(path);
-    co_await qCoro(uploadFileJob.get(), &BaseJob::finished);
+    auto uploadJob = connection()->uploadContent(buffer, {}, QStringLiteral("application/octet-stream"));
+    buffer->setParent(uploadJob.get());
+    co_await qCoro(uploadJob.get(), &BaseJob::finished);
 
-    // TODO: error handling
+    if (!uploadJob->status().good()) {
+        qCWarning(ASTRA_LOG) << "Failed to upload chunk:" << uploadJob->errorString();
+        co_return std::nullopt;
+    }
 
-    const QUrl contentUri = uploadFileJob->contentUri();
+    co_return uploadJob->contentUri().toString();
+}
+
+QCoro::Task<std::optional<QByteArray>> SyncManager::downloadChunk(const QString &mxcUri)
+{
+    const QTemporaryDir tempDir;
+    const QString path = tempDir.filePath(QStringLiteral("chunk"));
+
+    auto job = connection()->downloadFile(QUrl::fromUserInput(mxcUri), path);
+    co_await qCoro(job, &BaseJob::finished);
+
+    if (!job->status().good()) {
+        qCWarning(ASTRA_LOG) << "Failed to download chunk" << mxcUri << job->errorString();
+        co_return std::nullopt;
+    }
 
-    QVariantMap fileHashesVariant;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        co_return std::nullopt;
+    }
+
+    co_return file.readAll();
+}
+
+QCoro::Task<bool> SyncManager::setCharacterManifest(const QString &id,
+                                                    const QMap<QString, QString> &fileHashes,
+                                                    const QMap<QString, QStringList> &fileChunks,
+                                                    const QMap<QString, QString> &chunkUris)
+{
+    Q_ASSERT(m_currentRoom);
+
+    QJsonObject filesObject;
     for (const auto &[file, hash] : fileHashes.asKeyValueRange()) {
-        fileHashesVariant[file] = QVariant::fromValue(hash);
+        filesObject[file] = hash;
+    }
+
+    QJsonObject manifestObject;
+    for (const auto &[file, chunks] : fileChunks.asKeyValueRange()) {
+        manifestObject[file] = QJsonArray::fromStringList(chunks);
+    }
+
+    QJsonObject chunksObject;
+    for (const auto &[hash, uri] : chunkUris.asKeyValueRange()) {
+        chunksObject[hash] = uri;
     }
 
     auto syncSetState = m_currentRoom->setState(
         syncEventType,
         id,
-        QJsonObject{
-            {{contentUriKey, contentUri.toString()}, {hostnameKey, QSysInfo::machineHostName()}, {filesKey, QJsonObject::fromVariantMap(fileHashesVariant)}}});
+        QJsonObject{{hostnameKey, QSysInfo::machineHostName()}, {filesKey, filesObject}, {manifestKey, manifestObject}, {chunksKey, chunksObject}});
     co_await qCoro(syncSetState, &BaseJob::finished);
 
+    if (!syncSetState->status().good()) {
+        qCWarning(ASTRA_LOG) << "Failed to record character data for" << id << syncSetState->errorString();
+        co_return false;
+    }
+
     co_return true;
 }
 
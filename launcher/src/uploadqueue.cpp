@@ -0,0 +1,221 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "uploadqueue.h"
+#include "astra_log.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <qcorosignal.h>
+
+using namespace Qt::StringLiterals;
+using namespace std::chrono_literals;
+
+constexpr auto initialRetryDelay = 15s;
+constexpr auto maximumRetryDelay = 30min;
+
+UploadQueue::UploadQueue(const QString &path, QObject *parent)
+    : QObject(parent)
+    , m_path(path)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, [this] {
+        process();
+    });
+
+    load();
+}
+
+void UploadQueue::setHandler(Handler handler)
+{
+    m_handler = std::move(handler);
+    schedule();
+}
+
+void UploadQueue::enqueue(const QString &id)
+{
+    if (Entry *entry = find(id)) {
+        entry->attempts = 0;
+        entry->nextAttempt = QDateTime::currentDateTimeUtc();
+        entry->requeued = m_inProgress.contains(id);
+    } else {
+        m_entries.push_back(Entry{.id = id, .nextAttempt = QDateTime::currentDateTimeUtc()});
+    }
+
+    save();
+    schedule();
+}
+
+QCoro::Task<bool> UploadQueue::drain(const QString &id)
+{
+    while (m_inProgress.contains(id)) {
+        co_await qCoro(this, &UploadQueue::attemptFinished);
+    }
+
+    if (!isPending(id)) {
+        co_return true;
+    }
+
+    if (!m_handler) {
+        co_return false;
+    }
+
+    co_return co_await attempt(id);
+}
+
+bool UploadQueue::isPending(const QString &id) const
+{
+    return std::ranges::any_of(m_entries, [&id](const Entry &entry) {
+        return entry.id == id;
+    });
+}
+
+bool UploadQueue::isEmpty() const
+{
+    return m_entries.isEmpty();
+}
+
+std::chrono::milliseconds UploadQueue::retryDelay(const int attempts)
+{
+    if (attempts <= 0) {
+        return 0ms;
+    }
+
+    // Doubles every time, until it's far enough apart that it doesn't matter anymore
+    const int doublings = qMin(attempts - 1, 16);
+    return qMin<std::chrono::milliseconds>(initialRetryDelay * (1 << doublings), maximumRetryDelay);
+}
+
+QCoro::Task<> UploadQueue::process()
+{
+    if (m_processing || !m_handler) {
+        co_return;
+    }
+    m_processing = true;
+
+    while (true) {
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        const auto due = std::ranges::find_if(m_entries, [this, &now](const Entry &entry) {
+            return !m_inProgress.contains(entry.id) && entry.nextAttempt <= now;
+        });
+        if (due == m_entries.end()) {
+            break;
+        }
+
+        co_await attempt(due->id);
+    }
+
+    m_processing = false;
+    schedule();
+
+    Q_EMIT idle();
+}
+
+QCoro::Task<bool> UploadQueue::attempt(const QString id)
+{
+    m_inProgress.insert(id);
+    if (Entry *entry = find(id)) {
+        entry->requeued = false;
+    }
+
+    const bool succeeded = co_await m_handler(id);
+
+    m_inProgress.remove(id);
+
+    if (Entry *entry = find(id)) {
+        if (succeeded && !entry->requeued) {
+            m_entries.removeIf([&id](const Entry &other) {
+                return other.id == id;
+            });
+        } else if (!succeeded) {
+            entry->attempts++;
+            entry->nextAttempt = QDateTime::currentDateTimeUtc().addMSecs(retryDelay(entry->attempts).count());
+            qWarning(ASTRA_LOG) << "Upload for" << id << "failed, trying again in" << retryDelay(entry->attempts).count() / 1000 << "seconds";
+        }
+        save();
+    }
+
+    Q_EMIT attemptFinished(id, succeeded);
+
+    co_return succeeded && !isPending(id);
+}
+
+void UploadQueue::schedule()
+{
+    if (!m_handler || m_processing) {
+        return;
+    }
+
+    std::optional<QDateTime> nextAttempt;
+    for (const auto &entry : std::as_const(m_entries)) {
+        if (!m_inProgress.contains(entry.id) && (!nextAttempt || entry.nextAttempt < *nextAttempt)) {
+            nextAttempt = entry.nextAttempt;
+        }
+    }
+
+    if (!nextAttempt) {
+        m_timer.stop();
+        return;
+    }
+
+    m_timer.start(qMax<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(*nextAttempt)));
+}
+
+UploadQueue::Entry *UploadQueue::find(const QString &id)
+{
+    for (auto &entry : m_entries) {
+        if (entry.id == id) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void UploadQueue::load()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    // Anything left over is tried again right away, since whatever was wrong last time might be fixed by now
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    for (const auto value : QJsonDocument::fromJson(file.readAll()).array()) {
+        const QJsonObject object = value.toObject();
+        const QString id = object["id"_L1].toString();
+        if (!id.isEmpty() && !find(id)) {
+            m_entries.push_back(Entry{.id = id, .attempts = object["attempts"_L1].toInt(), .nextAttempt = now});
+        }
+    }
+
+    if (!m_entries.isEmpty()) {
+        qInfo(ASTRA_LOG) << "Found" << m_entries.size() << "uploads left over from last time";
+    }
+}
+
+void UploadQueue::save() const
+{
+    QJsonArray entries;
+    for (const auto &entry : m_entries) {
+        entries.push_back(QJsonObject{{"id"_L1, entry.id}, {"attempts"_L1, entry.attempts}});
+    }
+
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning(ASTRA_LOG) << "Failed to write upload queue" << file.errorString();
+        return;
+    }
+
+    file.write(QJsonDocument(entries).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning(ASTRA_LOG) << "Failed to write upload queue" << file.errorString();
+    }
+}
+
+#include "moc_uploadqueue.cpp"
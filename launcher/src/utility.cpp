@@ -3,9 +3,17 @@
 
 #include "utility.h"
 #include "astra_http_log.h"
+#include "astra_log.h"
 
 #include <QSslConfiguration>
 
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using namespace Qt::StringLiterals;
 
 QString Utility::toWindowsPath(const QDir &dir)
@@ -60,3 +68,56 @@ QString Utility::repositoryFromPatchUrl(const QString &url)
     auto url_parts = url.split('/'_L1);
     return url_parts[url_parts.size() - 3];
 }
+
+QFileDevice::Permissions Utility::permissionsFromMode(const quint32 mode)
+{
+    QFileDevice::Permissions permissions;
+    if (mode & 0400) {
+        permissions |= QFileDevice::ReadOwner | QFileDevice::ReadUser;
+    }
+    if (mode & 0200) {
+        permissions |= QFileDevice::WriteOwner | QFileDevice::WriteUser;
+    }
+    if (mode & 0100) {
+        permissions |= QFileDevice::ExeOwner | QFileDevice::ExeUser;
+    }
+    if (mode & 040) {
+        permissions |= QFileDevice::ReadGroup;
+    }
+    if (mode & 020) {
+        permissions |= QFileDevice::WriteGroup;
+    }
+    if (mode & 010) {
+        permissions |= QFileDevice::ExeGroup;
+    }
+    if (mode & 04) {
+        permissions |= QFileDevice::ReadOther;
+    }
+    if (mode & 02) {
+        permissions |= QFileDevice::WriteOther;
+    }
+    if (mode & 01) {
+        permissions |= QFileDevice::ExeOther;
+    }
+
+    return permissions;
+}
+
+void Utility::setLowIoPriority(const bool enabled)
+{
+#ifdef Q_OS_LINUX
+    // From ioprio_set(2), glibc doesn't have a wrapper for it
+    constexpr int ioprioWhoProcess = 1;
+    constexpr int ioprioClassShift = 13;
+    constexpr int ioprioClassNone = 0;
+    constexpr int ioprioClassIdle = 3;
+
+    // A pid of 0 only changes the calling thread, and the "none" class goes back to following the CPU priority
+    const int priority = (enabled ? ioprioClassIdle : ioprioClassNone) << ioprioClassShift;
+    if (syscall(SYS_ioprio_set, ioprioWhoProcess, 0, priority) != 0) {
+        qWarning(ASTRA_LOG) << "Failed to change the I/O priority:" << strerror(errno);
+    }
+#else
+    Q_UNUSED(enabled)
+#endif
+}
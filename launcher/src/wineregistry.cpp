@@ -0,0 +1,318 @@
+// SPDX-FileCopyrightText: 2025 Joshua Goins <josh@redstrate.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "wineregistry.h"
+#include "astra_log.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace Qt::StringLiterals;
+
+constexpr QByteArrayView registryHeader = "WINE REGISTRY Version 2";
+
+// Seconds between the Windows epoch (1601) and the Unix epoch
+constexpr qint64 windowsEpochOffset = 11644473600;
+
+/// \return @p string escaped the same way Wine writes key and value names.
+static QByteArray escape(const QString &string)
+{
+    QByteArray escaped;
+    escaped.reserve(string.size());
+
+    for (const QChar character : string) {
+        if (character == '\\'_L1 || character == '"'_L1) {
+            escaped += '\\';
+            escaped += character.toLatin1();
+        } else if (character.unicode() < 0x20 || character.unicode() > 0x7e) {
+            escaped += QStringLiteral("\\x%1").arg(character.unicode(), 4, 16, '0'_L1).toLatin1();
+        } else {
+            escaped += character.toLatin1();
+        }
+    }
+
+    return escaped;
+}
+
+/// \return The start of a line holding the value @p name, like "\"HideWineExports\"=".
+static QByteArray valuePrefix(const QString &name)
+{
+    return '"' + escape(name) + "\"=";
+}
+
+static bool startsWithCaseInsensitive(const QByteArray &line, const QByteArray &prefix)
+{
+    return line.size() >= prefix.size() && line.first(prefix.size()).compare(prefix, Qt::CaseInsensitive) == 0;
+}
+
+WineRegistry::WineRegistry(const QString &path)
+    : m_path(path)
+{
+}
+
+bool WineRegistry::load()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    m_lines = file.readAll().split('\n');
+    m_modified = false;
+
+    if (m_lines.isEmpty() || !m_lines.first().startsWith(registryHeader)) {
+        qWarning(ASTRA_LOG) << m_path << "is not a Wine registry file";
+        return false;
+    }
+
+    return true;
+}
+
+void WineRegistry::setString(const QString &key, const QString &name, const QString &value)
+{
+    setValue(key, name, '"' + escape(value) + '"');
+}
+
+void WineRegistry::setDword(const QString &key, const QString &name, const quint32 value)
+{
+    setValue(key, name, "dword:" + QByteArray::number(value, 16).rightJustified(8, '0'));
+}
+
+void WineRegistry::remove(const QString &key, const QString &name)
+{
+    const qsizetype header = findKey(key);
+    if (header == -1) {
+        return;
+    }
+
+    const auto [start, end] = findValue(header, name);
+    if (start == -1) {
+        return;
+    }
+
+    m_lines.remove(start, end - start);
+    m_modified = true;
+}
+
+std::optional<QByteArray> WineRegistry::rawValue(const QString &key, const QString &name) const
+{
+    const qsizetype header = findKey(key);
+    if (header == -1) {
+        return std::nullopt;
+    }
+
+    const auto [start, end] = findValue(header, name);
+    if (start == -1) {
+        return std::nullopt;
+    }
+
+    QByteArray value = m_lines[start].mid(valuePrefix(name).size());
+    for (qsizetype i = start + 1; i < end; i++) {
+        value.chop(1);
+        value += m_lines[i].trimmed();
+    }
+
+    return value;
+}
+
+bool WineRegistry::isModified() const
+{
+    return m_modified;
+}
+
+bool WineRegistry::save()
+{
+    if (!m_modified) {
+        return true;
+    }
+
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning(ASTRA_LOG) << "Failed to write" << m_path << file.errorString();
+        return false;
+    }
+
+    file.write(m_lines.join('\n'));
+
+    if (!file.commit()) {
+        qWarning(ASTRA_LOG) << "Failed to write" << m_path << file.errorString();
+        return false;
+    }
+
+    m_modified = false;
+
+    return true;
+}
+
+qsizetype WineRegistry::findKey(const QString &key) const
+{
+    const QByteArray escapedKey = escape(key);
+
+    for (qsizetype i = 0; i < m_lines.size(); i++) {
+        const QByteArray &line = m_lines[i];
+        if (!line.startsWith('[')) {
+            continue;
+        }
+
+        // Keys look like [Software\\Wine] 1700000000, where the number is when it was last modified
+        const qsizetype close = line.lastIndexOf(']');
+        if (close != -1 && line.sliced(1, close - 1).compare(escapedKey, Qt::CaseInsensitive) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+qsizetype WineRegistry::keyEnd(const qsizetype header) const
+{
+    for (qsizetype i = header + 1; i < m_lines.size(); i++) {
+        if (m_lines[i].startsWith('[')) {
+            return i;
+        }
+    }
+
+    return m_lines.size();
+}
+
+std::pair<qsizetype, qsizetype> WineRegistry::findValue(const qsizetype header, const QString &name) const
+{
+    const QByteArray prefix = valuePrefix(name);
+    const qsizetype end = keyEnd(header);
+
+    for (qsizetype i = header + 1; i < end; i++) {
+        if (!startsWithCaseInsensitive(m_lines[i], prefix)) {
+            continue;
+        }
+
+        // Only binary values are split across multiple lines, ending in a backslash
+        qsizetype last = i;
+        if (m_lines[i].sliced(prefix.size()).startsWith("hex")) {
+            while (last + 1 < end && m_lines[last].endsWith('\\')) {
+                last++;
+            }
+        }
+
+        return {i, last + 1};
+    }
+
+    return {-1, -1};
+}
+
+void WineRegistry::setValue(const QString &key, const QString &name, const QByteArray &data)
+{
+    const QByteArray line = valuePrefix(name) + data;
+
+    qsizetype header = findKey(key);
+    if (header == -1) {
+        // Wine puts a blank line before every key, and the file ends with a newline
+        qsizetype position = m_lines.size();
+        if (!m_lines.isEmpty() && m_lines.last().isEmpty()) {
+            position--;
+        }
+
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        const qint64 fileTime = (now + windowsEpochOffset) * 10000000;
+
+        const QByteArrayList section{
+            QByteArray(),
+            '[' + escape(key) + "] " + QByteArray::number(now),
+            "#time=" + QByteArray::number(fileTime, 16),
+            line,
+        };
+        for (qsizetype i = 0; i < section.size(); i++) {
+            m_lines.insert(position + i, section[i]);
+        }
+        m_modified = true;
+        return;
+    }
+
+    if (const auto [start, end] = findValue(header, name); start != -1) {
+        if (end - start == 1 && m_lines[start] == line) {
+            return;
+        }
+
+        m_lines.remove(start, end - start);
+        m_lines.insert(start, line);
+        m_modified = true;
+        return;
+    }
+
+    // New values go after the last one in the key, before the blank line separating it from the next
+    qsizetype position = keyEnd(header);
+    while (position - 1 > header && m_lines[position - 1].isEmpty()) {
+        position--;
+    }
+
+    m_lines.insert(position, line);
+    m_modified = true;
+}
+
+WinePrefixLock::WinePrefixLock(const QString &prefixPath)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+    struct stat info {
+    };
+    if (stat(QFile::encodeName(prefixPath).constData(), &info) != 0) {
+        return;
+    }
+
+    // This is where wineserver keeps its socket and lock, see init_server_dir() in Wine
+    const QByteArray rootPath = QFile::encodeName(QStringLiteral("/tmp/.wine-%1").arg(getuid()));
+    const QByteArray serverPath = rootPath
+        + QFile::encodeName(QStringLiteral("/server-%1-%2")
+                                .arg(static_cast<qulonglong>(info.st_dev), 0, 16)
+                                .arg(static_cast<qulonglong>(info.st_ino), 0, 16));
+
+    // wineserver hasn't been started for this prefix since the last reboot, so create them the same way it would.
+    // Otherwise it could start while we're editing, since there would be nothing to lock.
+    for (const QByteArray &path : {rootPath, serverPath}) {
+        if (mkdir(path.constData(), 0700) != 0 && errno != EEXIST) {
+            qWarning(ASTRA_LOG) << "Failed to create the wineserver directory" << path << "for locking:" << strerror(errno);
+            return;
+        }
+    }
+
+    m_fd = open((serverPath + "/lock").constData(), O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+    if (m_fd == -1) {
+        qWarning(ASTRA_LOG) << "Failed to open the wineserver lock in" << serverPath << ":" << strerror(errno);
+        return;
+    }
+
+    // wineserver holds a write lock on the first byte for as long as it's running
+    struct flock lock {
+    };
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = 0;
+    lock.l_len = 1;
+
+    m_locked = fcntl(m_fd, F_SETLK, &lock) == 0;
+#else
+    Q_UNUSED(prefixPath)
+#endif
+}
+
+WinePrefixLock::~WinePrefixLock()
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+    // Closing it also releases the lock
+    if (m_fd != -1) {
+        close(m_fd);
+    }
+#endif
+}
+
+bool WinePrefixLock::isLocked() const
+{
+    return m_locked;
+}
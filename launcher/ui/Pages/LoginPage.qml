@@ -72,6 +72,15 @@ QQC2.Control {
         }
     }
 
+    Connections {
+        target: LauncherCore
+
+        function onCurrentProfileChanged(): void {
+            LauncherCore.prewarmConnections(LauncherCore.currentProfile);
+            LauncherCore.prestartWine(LauncherCore.currentProfile);
+        }
+    }
+
     Connections {
         target: LauncherCore.currentProfile
 
@@ -92,7 +101,11 @@ QQC2.Control {
         }
     }
 
-    Component.onCompleted: updateFields()
+    Component.onCompleted: {
+        updateFields();
+        LauncherCore.prewarmConnections(LauncherCore.currentProfile);
+        LauncherCore.prestartWine(LauncherCore.currentProfile);
+    }
 
     contentItem: ColumnLayout {
         width: parent.width
@@ -17,7 +17,7 @@ QQC2.Control {
     id: page
 
     property int currentBannerIndex: 0
-    property int numBannerImages: 0
+    readonly property int numBannerImages: LauncherCore.headline.banners.count
 
     leftPadding: 0
     rightPadding: 0
@@ -27,11 +27,10 @@ QQC2.Control {
     Component.onCompleted: LauncherCore.refreshNews()
 
     Connections {
-        target: LauncherCore
+        target: LauncherCore.headline.banners
 
-        function onNewsChanged(): void {
+        function onCountChanged(): void {
             page.currentBannerIndex = 0
-            page.numBannerImages = LauncherCore.headline.banners.length
         }
     }
 
@@ -80,15 +79,11 @@ QQC2.Control {
             Layout.topMargin: Kirigami.Units.largeSpacing
 
             source: {
-                if (LauncherCore.headline === null) {
-                    return "";
-                }
-
                 if (page.numBannerImages === 0) {
                     return "";
                 }
 
-                return LauncherCore.headline.banners[page.currentBannerIndex].bannerImage;
+                return LauncherCore.headline.banners.banner(page.currentBannerIndex).bannerImage;
             }
 
             MouseArea {
@@ -97,7 +92,7 @@ QQC2.Control {
                 cursorShape: Qt.PointingHandCursor
                 hoverEnabled: true
 
-                onClicked: applicationWindow().openUrl(LauncherCore.headline.banners[page.currentBannerIndex].link)
+                onClicked: applicationWindow().openUrl(LauncherCore.headline.banners.banner(page.currentBannerIndex).link)
             }
 
             layer.enabled: !(bannerImage.width < layout.maximumWidth)
@@ -130,24 +125,26 @@ QQC2.Control {
             Layout.alignment: Qt.AlignHCenter | Qt.AlignTop
 
             maximumWidth: layout.maximumWidth
-            visible: LauncherCore.headline !== null
+            visible: LauncherCore.headline.loaded
 
             Repeater {
-                model: LauncherCore.headline !== null ? LauncherCore.headline.news : undefined
+                model: LauncherCore.headline.news
 
                 FormCard.FormButtonDelegate {
-                    required property var modelData
+                    required property string title
+                    required property date date
+                    required property url url
 
-                    text: modelData.title
-                    description: Qt.formatDate(modelData.date)
+                    text: title
+                    description: Qt.formatDate(date)
 
-                    onClicked: applicationWindow().openUrl(modelData.url)
+                    onClicked: applicationWindow().openUrl(url)
                 }
             }
 
             FormCard.FormTextDelegate {
                 description: i18n("No news.")
-                visible: LauncherCore.headline !== null ? LauncherCore.headline.failedToLoad : false
+                visible: LauncherCore.headline.failedToLoad && LauncherCore.headline.news.count === 0
             }
 
             Kirigami.Theme.colorSet: Kirigami.Theme.Window
@@ -165,25 +162,27 @@ QQC2.Control {
             Layout.alignment: Qt.AlignHCenter | Qt.AlignTop
 
             maximumWidth: layout.maximumWidth
-            visible: LauncherCore.headline !== null
+            visible: LauncherCore.headline.loaded
 
             Repeater {
-                model: LauncherCore.headline !== null ? LauncherCore.headline.topics : undefined
+                model: LauncherCore.headline.topics
 
                 FormCard.FormButtonDelegate {
-                    required property var modelData
+                    required property string title
+                    required property date date
+                    required property url url
 
-                    text: modelData.title
-                    description: Qt.formatDate(modelData.date)
+                    text: title
+                    description: Qt.formatDate(date)
 
                     hoverEnabled: true
-                    onClicked: applicationWindow().openUrl(modelData.url)
+                    onClicked: applicationWindow().openUrl(url)
                 }
             }
 
             FormCard.FormTextDelegate {
                 description: i18n("No topics.")
-                visible: LauncherCore.headline !== null ? LauncherCore.headline.failedToLoad : false
+                visible: LauncherCore.headline.failedToLoad && LauncherCore.headline.topics.count === 0
             }
 
             Kirigami.Theme.colorSet: Kirigami.Theme.Window
@@ -196,6 +195,6 @@ QQC2.Control {
 
     Kirigami.LoadingPlaceholder {
         anchors.centerIn: parent
-        visible: LauncherCore.headline === null
+        visible: !LauncherCore.headline.loaded
     }
 }
@@ -76,6 +76,23 @@ FormCard.FormCardPage {
             checked: LauncherCore.settings.enableRenderDocCapture
             onCheckedChanged: LauncherCore.settings.enableRenderDocCapture = checked
         }
+
+        FormCard.FormDelegateSeparator {
+            above: renderDocCaptureDelegate
+            below: resourceSamplingDelegate
+            visible: resourceSamplingDelegate.visible
+        }
+
+        FormCard.FormSpinBoxDelegate {
+            id: resourceSamplingDelegate
+
+            label: i18n("Record game resource usage every (seconds)")
+            from: 0
+            to: 600
+            value: LauncherCore.settings.resourceSamplingInterval
+            onValueChanged: LauncherCore.settings.resourceSamplingInterval = value
+            visible: !LauncherCore.isWindows
+        }
     }
 
     FormCard.FormHeader {
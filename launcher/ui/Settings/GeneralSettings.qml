@@ -56,6 +56,73 @@ FormCard.FormCardPage {
 
             onAccepted: (folder) => LauncherCore.settings.screenshotDir = folder
         }
+
+        FormCard.FormDelegateSeparator {
+            above: screenshotsPathDelegate
+            below: prestartWineDelegate
+            visible: prestartWineDelegate.visible
+        }
+
+        FormCard.FormCheckDelegate {
+            id: prestartWineDelegate
+
+            text: i18n("Start Wine ahead of time")
+            description: i18n("Start Wine for the selected profile while on the login page, so the game launches faster. Not used with Gamescope.")
+            checked: LauncherCore.settings.prestartWineServer
+            onCheckedChanged: LauncherCore.settings.prestartWineServer = checked
+            visible: !LauncherCore.isWindows
+        }
+    }
+
+    FormCard.FormHeader {
+        title: i18n("Updates")
+    }
+
+    FormCard.FormCard {
+        Layout.fillWidth: true
+
+        FormCard.FormCheckDelegate {
+            id: backgroundUpdatesDelegate
+
+            text: i18n("Update in the background")
+            description: i18n("Periodically download launcher and Dalamud updates while Astra is open, so logging in is faster.")
+            checked: LauncherCore.settings.enableBackgroundUpdates
+            onCheckedChanged: LauncherCore.settings.enableBackgroundUpdates = checked
+        }
+
+        FormCard.FormDelegateSeparator {
+            above: backgroundUpdatesDelegate
+            below: updateIntervalDelegate
+        }
+
+        FormCard.FormSpinBoxDelegate {
+            id: updateIntervalDelegate
+
+            label: i18n("Check for updates every (minutes)")
+            from: 15
+            to: 24 * 60
+            stepSize: 15
+            value: LauncherCore.settings.backgroundUpdateInterval
+            onValueChanged: LauncherCore.settings.backgroundUpdateInterval = value
+            enabled: LauncherCore.settings.enableBackgroundUpdates
+        }
+
+        FormCard.FormDelegateSeparator {
+            above: updateIntervalDelegate
+            below: speedLimitDelegate
+        }
+
+        FormCard.FormSpinBoxDelegate {
+            id: speedLimitDelegate
+
+            label: i18n("Background download speed limit (KiB/s)")
+            from: 0
+            to: 1024 * 1024
+            stepSize: 256
+            value: LauncherCore.settings.backgroundUpdateSpeedLimit
+            onValueChanged: LauncherCore.settings.backgroundUpdateSpeedLimit = value
+            enabled: LauncherCore.settings.enableBackgroundUpdates
+        }
     }
 
     FormCard.FormCard {
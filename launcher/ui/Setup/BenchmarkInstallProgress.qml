@@ -17,6 +17,8 @@ Kirigami.Page {
     title: i18n("Benchmark Installation")
 
     Kirigami.LoadingPlaceholder {
+        id: placeholder
+
         anchors.centerIn: parent
 
         text: i18n("Downloading…")
@@ -43,6 +45,22 @@ Kirigami.Page {
             Qt.callLater(() => applicationWindow().checkSetup());
         }
 
+        function onStageChanged(message: string, explanation: string): void {
+            placeholder.text = message;
+            placeholder.explanation = explanation;
+        }
+
+        function onStageIndeterminate(): void {
+            placeholder.determinate = false;
+        }
+
+        function onDownloadProgress(received: real, total: real): void {
+            placeholder.determinate = total > 0;
+            placeholder.progressBar.from = 0;
+            placeholder.progressBar.to = total;
+            placeholder.progressBar.value = received;
+        }
+
         function onError(message: string): void {
             errorDialog.subtitle = i18n("An error has occurred while installing the benchmark:\n\n%1", message);
             errorDialog.open();